@@ -0,0 +1,138 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac_utils.h"
+#include "magsac.h"
+#include "estimators.h"
+#include "fast_uniform_sampler.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+// The averages over the repeated runs with the given caches on a scene
+struct BenchmarkResult
+{
+	double elapsed_seconds; // The average run time
+	double duplicate_sample_rate; // The ratio of the selected samples which had already been evaluated
+	double cache_hit_rate; // The ratio of the refined models whose score was taken from the cache
+	std::vector<Eigen::MatrixXd> models; // The model of each run
+};
+
+// The distance of two homographies normalized to unit norm and positive last element
+double homographyDistance(const Eigen::MatrixXd &first_, const Eigen::MatrixXd &second_)
+{
+	const Eigen::MatrixXd first = first_ / (first_.norm() * (first_(2, 2) < 0 ? -1.0 : 1.0));
+	const Eigen::MatrixXd second = second_ / (second_.norm() * (second_(2, 2) < 0 ? -1.0 : 1.0));
+	return (first - second).norm();
+}
+
+// Running MAGSAC++ repeatedly for a fixed number of iterations on the points of a scene. The run
+// with the same index uses the same seed in each configuration, thus, the runs differ only by the caches.
+BenchmarkResult runScene(
+	const cv::Mat &points_, // The point correspondences
+	const size_t duplicate_sample_capacity_, // The number of the remembered samples. Zero switches the detection off.
+	const size_t refined_model_cache_size_, // The number of the remembered refined models. Zero switches the cache off.
+	const size_t iteration_number_, // The number of iterations of each run
+	const size_t repetition_number_) // The number of runs
+{
+	constexpr double maximum_threshold = 10.0; // The maximum threshold as in the sample project
+	constexpr double confidence = 0.99; // The required confidence in the results
+
+	BenchmarkResult result = { 0.0, 0.0, 0.0, {} };
+	size_t sample_number = 0, refined_model_number = 0;
+	for (size_t repetition = 0; repetition < repetition_number_; ++repetition)
+	{
+		magsac::utils::DefaultHomographyEstimator estimator;
+		magsac::sampler::FastUniformSampler sampler(&points_, repetition);
+		HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+		magsac.setMaximumThreshold(maximum_threshold);
+		magsac.setReferenceThreshold(2.0);
+		magsac.setMinimumIterationNumber(iteration_number_);
+		magsac.setIterationLimit(iteration_number_);
+		magsac.setDuplicateSampleDetection(duplicate_sample_capacity_);
+		magsac.setRefinedModelCache(refined_model_cache_size_);
+
+		HomographyMAGSAC::RunContext context;
+		gcransac::Homography model;
+		int iteration_number = 0;
+		ModelScore score;
+
+		const auto start = std::chrono::steady_clock::now();
+		magsac.run(points_, confidence, estimator, sampler, model, iteration_number, score, context);
+		const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start;
+
+		result.elapsed_seconds += elapsed_seconds.count();
+		result.duplicate_sample_rate += context.statistics.duplicate_sample_number;
+		result.cache_hit_rate += context.statistics.refined_model_cache_hits;
+		sample_number += context.statistics.sample_number;
+		refined_model_number += context.statistics.refined_model_number;
+		result.models.emplace_back(model.descriptor);
+	}
+
+	result.elapsed_seconds /= repetition_number_;
+	result.duplicate_sample_rate = sample_number > 0 ? result.duplicate_sample_rate / sample_number : 0.0;
+	result.cache_hit_rate = refined_model_number > 0 ? result.cache_hit_rate / refined_model_number : 0.0;
+	return result;
+}
+
+// The largest distance of the models of the runs from the ones of the runs without the caches
+double maximumModelDistance(const BenchmarkResult &reference_, const BenchmarkResult &result_)
+{
+	double maximum_distance = 0.0;
+	for (size_t run_idx = 0; run_idx < reference_.models.size(); ++run_idx)
+		maximum_distance = MAX(maximum_distance, homographyDistance(reference_.models[run_idx], result_.models[run_idx]));
+	return maximum_distance;
+}
+
+// Measuring the effect of the duplicate sample detection and the refined model cache on the homography
+// scenes of the repository. Each run does a fixed number of iterations, thus, the run times are comparable.
+// It has to be run from the root folder of the repository.
+int main(int argc, char** argv)
+{
+	const size_t repetition_number = 10; // The number of runs on each scene
+	const size_t iteration_number = 1000; // The number of iterations of each run
+	const std::vector<std::string> scenes = {
+		"LePoint1", "LePoint2", "LePoint3",
+		"graf", "ExtremeZoom", "city",
+		"CapitalRegion", "BruggeTower", "BruggeSquare",
+		"BostonLib", "boat", "adam",
+		"WhiteBoard", "Eiffel", "Brussels", "Boston" };
+
+	printf("%-14s %6s | %9s | %6s %9s %8s | %6s %9s %8s\n",
+		"scene", "points",
+		"time [s]",
+		"dup.", "time [s]", "distance",
+		"hits", "time [s]", "distance");
+
+	for (const std::string &scene : scenes)
+	{
+		cv::Mat points;
+		std::vector<int> labels;
+		readAnnotatedPoints("data/homography/" + scene + "_pts.txt", points, labels);
+		if (points.rows == 0)
+		{
+			fprintf(stderr, "A problem occured when loading the annotated points for test scene '%s'\n", scene.c_str());
+			continue;
+		}
+
+		const BenchmarkResult reference_result = runScene(points, 0, 0, iteration_number, repetition_number);
+		const BenchmarkResult duplicate_result = runScene(points, iteration_number, 0, iteration_number, repetition_number);
+		const BenchmarkResult cache_result = runScene(points, 0, 100, iteration_number, repetition_number);
+
+		printf("%-14s %6d | %9.4f | %6.3f %9.4f %8.1e | %6.3f %9.4f %8.1e\n",
+			scene.c_str(),
+			points.rows,
+			reference_result.elapsed_seconds,
+			duplicate_result.duplicate_sample_rate,
+			duplicate_result.elapsed_seconds,
+			maximumModelDistance(reference_result, duplicate_result),
+			cache_result.cache_hit_rate,
+			cache_result.elapsed_seconds,
+			maximumModelDistance(reference_result, cache_result));
+	}
+
+	return 0;
+}
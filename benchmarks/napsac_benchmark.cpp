@@ -0,0 +1,137 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac_utils.h"
+#include "magsac.h"
+#include "estimators.h"
+#include "uniform_sampler.h"
+#include "napsac_sampler.h"
+
+// The averages over the repeated runs of a sampler on a scene
+struct BenchmarkResult
+{
+	double iteration_number; // The average number of iterations
+	double elapsed_seconds; // The average run time
+	double rmse; // The average RMSE of the ground truth inliers
+	double failure_rate; // The ratio of the runs not returning a model
+};
+
+// Running MAGSAC++ repeatedly with the given sampler on the points of a scene
+template<class _Sampler>
+BenchmarkResult runScene(
+	const cv::Mat &points_, // The point correspondences
+	const std::vector<int> &ground_truth_inliers_, // The indices of the ground truth inliers
+	_Sampler &sampler_, // The tested sampler
+	const size_t repetition_number_) // The number of runs
+{
+	constexpr double maximum_threshold = 5.0; // The maximum threshold as in the sample project
+	constexpr double confidence = 0.99; // The required confidence in the results
+
+	BenchmarkResult result = { 0.0, 0.0, 0.0, 0.0 };
+	size_t successful_run_number = 0;
+
+	for (size_t repetition = 0; repetition < repetition_number_; ++repetition)
+	{
+		magsac::utils::DefaultFundamentalMatrixEstimator estimator(maximum_threshold);
+		MAGSAC<cv::Mat, magsac::utils::DefaultFundamentalMatrixEstimator> magsac;
+		magsac.setMaximumThreshold(maximum_threshold);
+		magsac.setIterationLimit(1e4);
+
+		gcransac::FundamentalMatrix model;
+		int iteration_number = 0;
+		ModelScore score;
+
+		sampler_.reset();
+		const auto start = std::chrono::steady_clock::now();
+		const bool success = magsac.run(points_,
+			confidence,
+			estimator,
+			sampler_,
+			model,
+			iteration_number,
+			score);
+		const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start;
+
+		result.iteration_number += iteration_number;
+		result.elapsed_seconds += elapsed_seconds.count();
+
+		if (!success)
+			continue;
+
+		// Calculate the RMSE of the ground truth inliers
+		double squared_error = 0.0;
+		for (const int inlier_idx : ground_truth_inliers_)
+			squared_error += estimator.squaredResidual(points_.row(inlier_idx), model);
+		result.rmse += std::sqrt(squared_error / ground_truth_inliers_.size());
+		++successful_run_number;
+	}
+
+	result.iteration_number /= repetition_number_;
+	result.elapsed_seconds /= repetition_number_;
+	result.rmse = successful_run_number > 0 ? result.rmse / successful_run_number : 0.0;
+	result.failure_rate = 1.0 - static_cast<double>(successful_run_number) / repetition_number_;
+	return result;
+}
+
+// Comparing the uniform and the grid NAPSAC samplers in fundamental matrix estimation on the
+// AdelaideRMF and Multi-H scenes. It has to be run from the root folder of the repository.
+int main(int argc, char** argv)
+{
+	const size_t repetition_number = 10; // The number of runs on each scene
+	const std::vector<std::string> scenes = {
+		// AdelaideRMF
+		"barrsmith", "bonhall", "bonython",
+		"elderhalla", "elderhallb",
+		"hartley", "johnssonb", "ladysymon",
+		"library", "napiera", "napierb",
+		"nese", "oldclassicswing", "physics",
+		"sene", "unihouse", "unionhouse",
+		// Multi-H
+		"boxesandbooks", "glasscaseb", "stairs" };
+
+	printf("%-16s %6s | %9s %9s %8s %6s | %9s %9s %8s %6s\n",
+		"scene", "points",
+		"uni. it", "time [s]", "rmse", "fail",
+		"napsac it", "time [s]", "rmse", "fail");
+
+	for (const std::string &scene : scenes)
+	{
+		cv::Mat points;
+		std::vector<int> labels;
+		readAnnotatedPoints("data/fundamental_matrix/" + scene + "_pts.txt", points, labels);
+		if (points.rows == 0)
+		{
+			fprintf(stderr, "A problem occured when loading the annotated points for test scene '%s'\n", scene.c_str());
+			continue;
+		}
+
+		std::vector<int> ground_truth_inliers;
+		for (size_t point_idx = 0; point_idx < labels.size(); ++point_idx)
+			if (labels[point_idx] == 1)
+				ground_truth_inliers.emplace_back(static_cast<int>(point_idx));
+
+		gcransac::sampler::UniformSampler uniform_sampler(&points);
+		magsac::sampler::GridNapsacSampler napsac_sampler(&points);
+
+		const BenchmarkResult uniform_result = runScene(points, ground_truth_inliers, uniform_sampler, repetition_number);
+		const BenchmarkResult napsac_result = runScene(points, ground_truth_inliers, napsac_sampler, repetition_number);
+
+		printf("%-16s %6d | %9.1f %9.4f %8.3f %6.2f | %9.1f %9.4f %8.3f %6.2f\n",
+			scene.c_str(),
+			points.rows,
+			uniform_result.iteration_number,
+			uniform_result.elapsed_seconds,
+			uniform_result.rmse,
+			uniform_result.failure_rate,
+			napsac_result.iteration_number,
+			napsac_result.elapsed_seconds,
+			napsac_result.rmse,
+			napsac_result.failure_rate);
+	}
+
+	return 0;
+}
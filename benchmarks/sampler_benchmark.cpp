@@ -0,0 +1,66 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "uniform_sampler.h"
+#include "fast_uniform_sampler.h"
+
+// Measuring the number of minimal samples a sampler selects per second
+template<class _Sampler>
+double measureThroughput(
+	_Sampler &sampler_, // The tested sampler
+	const std::vector<size_t> &pool_, // The pool from which the samples are selected
+	const size_t sample_size_, // The size of a minimal sample
+	const size_t sample_number_) // The number of samples selected
+{
+	std::vector<size_t> sample(sample_size_);
+	size_t checksum = 0; // Used for keeping the compiler from removing the loop
+
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t sample_idx = 0; sample_idx < sample_number_; ++sample_idx)
+	{
+		sampler_.sample(pool_, &sample[0], sample_size_);
+		checksum += sample[0];
+	}
+	const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start;
+
+	if (checksum == 0)
+		printf(" ");
+	return sample_number_ / elapsed_seconds.count();
+}
+
+int main(int argc, char** argv)
+{
+	const size_t sample_number = 5000000; // The number of samples selected in each test
+	const size_t point_numbers[] = { 100, 500, 5000 }; // The tested pool sizes
+	const size_t sample_sizes[] = { 4, 5, 7 }; // The sample sizes of the minimal solvers (H, E, F)
+
+	cv::Mat points(1, 4, CV_64F); // The samplers do not access the points
+
+	printf("%8s %6s %18s %18s %8s\n", "points", "k", "uniform [1/s]", "fast [1/s]", "speedup");
+	for (const size_t point_number : point_numbers)
+	{
+		std::vector<size_t> pool(point_number);
+		for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
+			pool[point_idx] = point_idx;
+
+		for (const size_t sample_size : sample_sizes)
+		{
+			gcransac::sampler::UniformSampler uniform_sampler(&points);
+			magsac::sampler::FastUniformSampler fast_sampler(&points, 0);
+
+			const double uniform_throughput = measureThroughput(uniform_sampler, pool, sample_size, sample_number);
+			const double fast_throughput = measureThroughput(fast_sampler, pool, sample_size, sample_number);
+
+			printf("%8d %6d %18.0f %18.0f %7.2fx\n",
+				static_cast<int>(point_number),
+				static_cast<int>(sample_size),
+				uniform_throughput,
+				fast_throughput,
+				fast_throughput / uniform_throughput);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <opencv2/core.hpp>
+
+#include "magsac_utils.h"
+#include "estimation_server.h"
+
+// A load test of the estimation server (src/magsac_server.cpp) running on the same machine. The
+// points of a scene are written into a shared memory object once, then each client thread sends
+// fundamental matrix estimation requests on its own connection. It has to be run from the root
+// folder of the repository while the server is running.
+//
+// Usage: ServerBenchmark [socket path = /tmp/magsac.sock] [client number = 4] [requests per client = 100]
+int main(int argc, char** argv)
+{
+	const std::string socket_path = argc > 1 ? argv[1] : "/tmp/magsac.sock";
+	const size_t client_number = argc > 2 ? std::max(1, atoi(argv[2])) : 4;
+	const size_t request_number = argc > 3 ? std::max(1, atoi(argv[3])) : 100;
+	const std::string scene = "johnssonb";
+
+	cv::Mat points;
+	std::vector<int> labels;
+	readAnnotatedPoints("data/fundamental_matrix/" + scene + "_pts.txt", points, labels);
+	if (points.rows == 0)
+	{
+		fprintf(stderr, "A problem occured when loading the annotated points for test scene '%s'\n", scene.c_str());
+		return -1;
+	}
+
+	// Write the points into the shared memory
+	const std::string shared_memory_name = "/magsac_benchmark_" + std::to_string(getpid());
+	const size_t shared_memory_size = points.rows * points.cols * sizeof(double);
+	const int descriptor = shm_open(shared_memory_name.c_str(), O_CREAT | O_RDWR, 0600);
+	if (descriptor < 0 ||
+		ftruncate(descriptor, shared_memory_size) < 0)
+	{
+		fprintf(stderr, "The shared memory object '%s' cannot be created.\n", shared_memory_name.c_str());
+		return -1;
+	}
+	void * const address = mmap(nullptr, shared_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (address == MAP_FAILED)
+	{
+		shm_unlink(shared_memory_name.c_str());
+		return -1;
+	}
+	for (int row = 0; row < points.rows; ++row)
+		memcpy(static_cast<double *>(address) + row * points.cols, points.ptr<double>(row), points.cols * sizeof(double));
+
+	magsac::server::EstimationRequest request;
+	memset(&request, 0, sizeof(request));
+	request.magic = magsac::server::protocol_magic;
+	request.problem_type = magsac::server::FundamentalMatrix;
+	strcpy(request.shared_memory_name, shared_memory_name.c_str());
+	request.point_number = points.rows;
+	request.dimension = points.cols;
+	request.stride = points.cols;
+	request.confidence = 0.99;
+	request.maximum_threshold = 5.0;
+	request.iteration_limit = 10000;
+	request.use_magsac_plus_plus = 1;
+	request.return_inlier_mask = 1;
+
+	// The latencies of the requests of each client and the number of failed requests
+	std::vector<std::vector<double>> latencies(client_number);
+	std::vector<size_t> failures(client_number, 0);
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> clients;
+	for (size_t client_idx = 0; client_idx < client_number; ++client_idx)
+		clients.emplace_back([&, client_idx]()
+		{
+			const int client_socket = magsac::server::connectToServer(socket_path.c_str());
+			if (client_socket < 0)
+			{
+				failures[client_idx] = request_number;
+				return;
+			}
+
+			magsac::server::EstimationResponse response;
+			std::vector<uint64_t> inlier_mask;
+			for (size_t request_idx = 0; request_idx < request_number; ++request_idx)
+			{
+				const auto request_start = std::chrono::steady_clock::now();
+				if (!magsac::server::requestEstimation(client_socket, request, response, inlier_mask))
+				{
+					failures[client_idx] += request_number - request_idx;
+					break;
+				}
+				const std::chrono::duration<double> latency = std::chrono::steady_clock::now() - request_start;
+				latencies[client_idx].emplace_back(latency.count());
+				if (response.status != magsac::server::Success)
+					++failures[client_idx];
+			}
+			close(client_socket);
+		});
+	for (std::thread &client : clients)
+		client.join();
+	const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start;
+
+	munmap(address, shared_memory_size);
+	shm_unlink(shared_memory_name.c_str());
+
+	std::vector<double> all_latencies;
+	size_t failure_number = 0;
+	for (size_t client_idx = 0; client_idx < client_number; ++client_idx)
+	{
+		all_latencies.insert(all_latencies.end(), latencies[client_idx].begin(), latencies[client_idx].end());
+		failure_number += failures[client_idx];
+	}
+	if (all_latencies.empty())
+	{
+		fprintf(stderr, "No request has been served by the server on '%s'.\n", socket_path.c_str());
+		return -1;
+	}
+	std::sort(all_latencies.begin(), all_latencies.end());
+
+	printf("%d clients, %d requests, %d failed\n",
+		static_cast<int>(client_number),
+		static_cast<int>(all_latencies.size()),
+		static_cast<int>(failure_number));
+	printf("throughput: %.1f requests/s\n", all_latencies.size() / elapsed_seconds.count());
+	printf("latency: median %.4f s, 99th percentile %.4f s\n",
+		all_latencies[all_latencies.size() / 2],
+		all_latencies[std::min(all_latencies.size() - 1, all_latencies.size() * 99 / 100)]);
+	return 0;
+}
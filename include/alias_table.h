@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "fast_random_generator.h"
+
+namespace magsac
+{
+	namespace utils
+	{
+		// A table for drawing indices proportionally to given non-negative weights in constant time by
+		// the alias method of A. J. Walker. The table is built in linear time by the algorithm of M. D. Vose
+		// ("A linear algorithm for generating random numbers with a given distribution", 1991).
+		class AliasTable
+		{
+		public:
+			AliasTable()
+			{
+			}
+
+			// Building the table from the weights. It returns false and leaves the table
+			// empty if the weights sum up to zero.
+			bool build(
+				const double * const weights_, // The weights of the indices
+				const size_t index_number_) // The number of indices
+			{
+				clear();
+
+				double weight_sum = 0.0;
+				for (size_t index = 0; index < index_number_; ++index)
+					weight_sum += weights_[index];
+				if (weight_sum <= 0.0)
+					return false;
+
+				probabilities.resize(index_number_);
+				aliases.resize(index_number_);
+				small_indices.clear();
+				large_indices.clear();
+
+				// Scale the weights so that their average is one and split them into the ones below and above the average
+				const double multiplier = index_number_ / weight_sum;
+				for (size_t index = 0; index < index_number_; ++index)
+				{
+					probabilities[index] = weights_[index] * multiplier;
+					if (probabilities[index] < 1.0)
+						small_indices.emplace_back(index);
+					else
+						large_indices.emplace_back(index);
+				}
+
+				// Fill the remaining part of each small column by a large one
+				while (!small_indices.empty() && !large_indices.empty())
+				{
+					const size_t small_index = small_indices.back();
+					const size_t large_index = large_indices.back();
+					small_indices.pop_back();
+
+					aliases[small_index] = large_index;
+					probabilities[large_index] -= 1.0 - probabilities[small_index];
+					if (probabilities[large_index] < 1.0)
+					{
+						large_indices.pop_back();
+						small_indices.emplace_back(large_index);
+					}
+				}
+
+				// The remaining columns are full up to the rounding errors
+				for (const size_t index : large_indices)
+				{
+					probabilities[index] = 1.0;
+					aliases[index] = index;
+				}
+				for (const size_t index : small_indices)
+				{
+					probabilities[index] = 1.0;
+					aliases[index] = index;
+				}
+				return true;
+			}
+
+			void clear()
+			{
+				probabilities.clear();
+				aliases.clear();
+			}
+
+			bool empty() const
+			{
+				return probabilities.empty();
+			}
+
+			size_t size() const
+			{
+				return probabilities.size();
+			}
+
+			// Drawing an index proportionally to its weight
+			inline size_t sample(FastRandomGenerator &random_generator_) const
+			{
+				const size_t column = static_cast<size_t>(random_generator_.bounded(probabilities.size()));
+				const double uniform = random_generator_.uniform();
+				return uniform < probabilities[column] ? column : aliases[column];
+			}
+
+		protected:
+			std::vector<double> probabilities; // The probability of selecting the column itself instead of its alias
+			std::vector<size_t> aliases; // The index selected when the column itself is not
+			std::vector<size_t> small_indices; // The columns below the average used when building the table
+			std::vector<size_t> large_indices; // The columns above the average used when building the table
+		};
+	}
+}
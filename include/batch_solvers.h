@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <Eigen/Eigen>
+#include <opencv2/core.hpp>
+#include "model.h"
+
+namespace magsac
+{
+	namespace solver
+	{
+		// The transformation moving the centroid of a few points to the origin and scaling
+		// their average distance from it to sqrt(2) as in the normalized DLT of R. Hartley
+		struct PointNormalization
+		{
+			double center_x, center_y; // The centroid of the points
+			double scale; // The scale applied after the translation
+
+			template <size_t _PointNumber>
+			void fit(const double (&x_)[_PointNumber], const double (&y_)[_PointNumber])
+			{
+				center_x = center_y = 0.0;
+				for (size_t i = 0; i < _PointNumber; ++i)
+				{
+					center_x += x_[i];
+					center_y += y_[i];
+				}
+				center_x /= _PointNumber;
+				center_y /= _PointNumber;
+
+				double distance_sum = 0.0;
+				for (size_t i = 0; i < _PointNumber; ++i)
+					distance_sum += std::sqrt((x_[i] - center_x) * (x_[i] - center_x) + (y_[i] - center_y) * (y_[i] - center_y));
+				scale = distance_sum > 0.0 ? std::sqrt(2.0) * _PointNumber / distance_sum : 1.0;
+			}
+
+			// The transformation as a matrix
+			Eigen::Matrix3d matrix() const
+			{
+				Eigen::Matrix3d transformation;
+				transformation << scale, 0, -scale * center_x,
+					0, scale, -scale * center_y,
+					0, 0, 1;
+				return transformation;
+			}
+
+			// The inverse of the transformation as a matrix
+			Eigen::Matrix3d inverseMatrix() const
+			{
+				Eigen::Matrix3d transformation;
+				transformation << 1.0 / scale, 0, center_x,
+					0, 1.0 / scale, center_y,
+					0, 0, 1;
+				return transformation;
+			}
+		};
+
+		// Writing a descriptor to the given position of the model buffer. The buffer is only extended when it
+		// is too short, thus, the descriptors of a reused buffer are overwritten without reallocating them.
+		inline void storeModel(
+			const Eigen::Matrix3d &descriptor_, // The estimated model parameters
+			const size_t model_idx_, // The position of the model in the buffer
+			std::vector<gcransac::Model> &models_) // The buffer of the models
+		{
+			if (models_.size() <= model_idx_)
+				models_.resize(model_idx_ + 1);
+			models_[model_idx_].descriptor = descriptor_;
+		}
+
+		// The normalized four-point DLT estimating the homographies of a block of minimal samples in a
+		// single call. The last element of the normalized homography is fixed to one, thus, the
+		// parameters are obtained by solving a fixed-size 8x8 linear system without any heap allocation.
+		class HomographyFourPointBatchSolver
+		{
+		public:
+			static constexpr size_t sampleSize()
+			{
+				return 4;
+			}
+
+			static constexpr size_t maximumSolutions()
+			{
+				return 1;
+			}
+
+			// Estimating the homographies of the samples stored one after the other. The models are written
+			// to the beginning of the buffer and the index of the sample of each model is stored. It returns
+			// the number of estimated models.
+			size_t estimateModels(
+				const cv::Mat &data_, // All data points
+				const size_t *samples_, // The minimal samples stored one after the other
+				const size_t sample_number_, // The number of the samples
+				std::vector<gcransac::Model> &models_, // The buffer of the estimated models
+				std::vector<size_t> &model_samples_) const // The index of the sample of each model
+			{
+				constexpr size_t sample_size = sampleSize();
+				constexpr double minimum_determinant = 1e-10; // The determinant below which the system is considered singular
+
+				Eigen::Matrix<double, 8, 8> coefficients;
+				Eigen::Matrix<double, 8, 1> inhomogeneous;
+				Eigen::Matrix3d homography;
+				size_t model_number = 0;
+				model_samples_.resize(sample_number_);
+
+				for (size_t sample_idx = 0; sample_idx < sample_number_; ++sample_idx)
+				{
+					// Gather the coordinates of the sample
+					const size_t * const sample = samples_ + sample_idx * sample_size;
+					double x1[sample_size], y1[sample_size], x2[sample_size], y2[sample_size];
+					for (size_t i = 0; i < sample_size; ++i)
+					{
+						const double * const point = data_.ptr<double>(static_cast<int>(sample[i]));
+						x1[i] = point[0];
+						y1[i] = point[1];
+						x2[i] = point[2];
+						y2[i] = point[3];
+					}
+
+					// Normalize the coordinates in both images
+					PointNormalization normalization_1, normalization_2;
+					normalization_1.fit(x1, y1);
+					normalization_2.fit(x2, y2);
+
+					for (size_t i = 0; i < sample_size; ++i)
+					{
+						const double u1 = (x1[i] - normalization_1.center_x) * normalization_1.scale,
+							v1 = (y1[i] - normalization_1.center_y) * normalization_1.scale,
+							u2 = (x2[i] - normalization_2.center_x) * normalization_2.scale,
+							v2 = (y2[i] - normalization_2.center_y) * normalization_2.scale;
+
+						coefficients.row(2 * i) << u1, v1, 1, 0, 0, 0, -u2 * u1, -u2 * v1;
+						coefficients.row(2 * i + 1) << 0, 0, 0, u1, v1, 1, -v2 * u1, -v2 * v1;
+						inhomogeneous(2 * i) = u2;
+						inhomogeneous(2 * i + 1) = v2;
+					}
+
+					// Skip the sample if the points are in a degenerate configuration
+					const Eigen::PartialPivLU<Eigen::Matrix<double, 8, 8>> decomposition(coefficients);
+					if (std::abs(decomposition.determinant()) < minimum_determinant)
+						continue;
+
+					const Eigen::Matrix<double, 8, 1> parameters = decomposition.solve(inhomogeneous);
+					homography << parameters(0), parameters(1), parameters(2),
+						parameters(3), parameters(4), parameters(5),
+						parameters(6), parameters(7), 1.0;
+
+					// Undo the normalization
+					homography = normalization_2.inverseMatrix() * homography * normalization_1.matrix();
+					if (std::abs(homography(2, 2)) < std::numeric_limits<double>::epsilon())
+						continue;
+					homography /= homography(2, 2);
+
+					storeModel(homography, model_number, models_);
+					model_samples_[model_number++] = sample_idx;
+				}
+				return model_number;
+			}
+		};
+
+		// The normalized seven-point algorithm estimating the fundamental matrices of a block of minimal
+		// samples in a single call. The two-dimensional null space of the fixed-size 7x9 system is found
+		// by Gauss-Jordan elimination and the cubic singularity constraint is solved in closed form.
+		// The models violating the oriented epipolar constraint on their sample are rejected.
+		class FundamentalMatrixSevenPointBatchSolver
+		{
+		public:
+			static constexpr size_t sampleSize()
+			{
+				return 7;
+			}
+
+			static constexpr size_t maximumSolutions()
+			{
+				return 3;
+			}
+
+			// Estimating the fundamental matrices of the samples stored one after the other. The models are
+			// written to the beginning of the buffer and the index of the sample of each model is stored.
+			// It returns the number of estimated models.
+			size_t estimateModels(
+				const cv::Mat &data_, // All data points
+				const size_t *samples_, // The minimal samples stored one after the other
+				const size_t sample_number_, // The number of the samples
+				std::vector<gcransac::Model> &models_, // The buffer of the estimated models
+				std::vector<size_t> &model_samples_) const // The index of the sample of each model
+			{
+				constexpr size_t sample_size = sampleSize();
+				constexpr double minimum_pivot = 1e-10; // The pivot below which the system is considered to be degenerate
+
+				Eigen::Matrix<double, 7, 9> coefficients;
+				Eigen::Matrix3d fundamental_matrix_1, fundamental_matrix_2, fundamental_matrix;
+				size_t model_number = 0;
+				model_samples_.resize(sample_number_ * maximumSolutions());
+
+				for (size_t sample_idx = 0; sample_idx < sample_number_; ++sample_idx)
+				{
+					// Gather the coordinates of the sample
+					const size_t * const sample = samples_ + sample_idx * sample_size;
+					double x1[sample_size], y1[sample_size], x2[sample_size], y2[sample_size];
+					for (size_t i = 0; i < sample_size; ++i)
+					{
+						const double * const point = data_.ptr<double>(static_cast<int>(sample[i]));
+						x1[i] = point[0];
+						y1[i] = point[1];
+						x2[i] = point[2];
+						y2[i] = point[3];
+					}
+
+					// Normalize the coordinates in both images
+					PointNormalization normalization_1, normalization_2;
+					normalization_1.fit(x1, y1);
+					normalization_2.fit(x2, y2);
+
+					for (size_t i = 0; i < sample_size; ++i)
+					{
+						const double u1 = (x1[i] - normalization_1.center_x) * normalization_1.scale,
+							v1 = (y1[i] - normalization_1.center_y) * normalization_1.scale,
+							u2 = (x2[i] - normalization_2.center_x) * normalization_2.scale,
+							v2 = (y2[i] - normalization_2.center_y) * normalization_2.scale;
+
+						coefficients.row(i) << u2 * u1, u2 * v1, u2, v2 * u1, v2 * v1, v2, u1, v1, 1;
+					}
+
+					// Reduce the first seven columns to identity by Gauss-Jordan elimination with partial pivoting
+					if (!reduceToIdentity(coefficients, minimum_pivot))
+						continue;
+
+					// The null space is spanned by the last two columns of the reduced system
+					fundamental_matrix_1 << -coefficients(0, 7), -coefficients(1, 7), -coefficients(2, 7),
+						-coefficients(3, 7), -coefficients(4, 7), -coefficients(5, 7),
+						-coefficients(6, 7), 1, 0;
+					fundamental_matrix_2 << -coefficients(0, 8), -coefficients(1, 8), -coefficients(2, 8),
+						-coefficients(3, 8), -coefficients(4, 8), -coefficients(5, 8),
+						-coefficients(6, 8), 0, 1;
+
+					// Find the combinations F = F2 + lambda * (F1 - F2) whose determinant is zero
+					const Eigen::Matrix3d difference = fundamental_matrix_1 - fundamental_matrix_2;
+					double roots[3];
+					const size_t root_number = solveCubic(
+						difference.determinant(),
+						determinantCoefficient(difference, fundamental_matrix_2),
+						determinantCoefficient(fundamental_matrix_2, difference),
+						fundamental_matrix_2.determinant(),
+						roots);
+
+					const Eigen::Matrix3d denormalization_1 = normalization_1.matrix(),
+						denormalization_2 = normalization_2.matrix().transpose();
+
+					for (size_t root_idx = 0; root_idx < root_number; ++root_idx)
+					{
+						// Undo the normalization
+						fundamental_matrix = denormalization_2 *
+							(fundamental_matrix_2 + roots[root_idx] * difference) *
+							denormalization_1;
+
+						const double norm = fundamental_matrix.norm();
+						if (norm < std::numeric_limits<double>::epsilon())
+							continue;
+						fundamental_matrix /= norm;
+
+						if (!isOrientationValid(fundamental_matrix, y1, x2, y2))
+							continue;
+
+						storeModel(fundamental_matrix, model_number, models_);
+						model_samples_[model_number++] = sample_idx;
+					}
+				}
+				return model_number;
+			}
+
+		protected:
+			// Reducing the first seven columns of the system to identity. It returns false if
+			// a pivot is too small, i.e., the sample is degenerate.
+			static bool reduceToIdentity(
+				Eigen::Matrix<double, 7, 9> &system_, // The system of equations
+				const double minimum_pivot_) // The pivot below which the system is considered to be degenerate
+			{
+				for (size_t column = 0; column < 7; ++column)
+				{
+					// Select the row with the largest element in the current column
+					size_t pivot_row = column;
+					for (size_t row = column + 1; row < 7; ++row)
+						if (std::abs(system_(row, column)) > std::abs(system_(pivot_row, column)))
+							pivot_row = row;
+					if (std::abs(system_(pivot_row, column)) < minimum_pivot_)
+						return false;
+					system_.row(column).swap(system_.row(pivot_row));
+
+					system_.row(column) /= system_(column, column);
+					for (size_t row = 0; row < 7; ++row)
+						if (row != column)
+							system_.row(row) -= system_(row, column) * system_.row(column);
+				}
+				return true;
+			}
+
+			// The coefficient of the polynomial det(A + lambda * B) which belongs to the first power
+			// of lambda if it is called as (A, B) and to the second power if it is called as (B, A).
+			static double determinantCoefficient(
+				const Eigen::Matrix3d &a_,
+				const Eigen::Matrix3d &b_)
+			{
+				// The sum of the determinants where two columns are taken from A and one from B
+				return b_.col(0).dot(a_.col(1).cross(a_.col(2))) +
+					a_.col(0).dot(b_.col(1).cross(a_.col(2))) +
+					a_.col(0).dot(a_.col(1).cross(b_.col(2)));
+			}
+
+			// Finding the real roots of a * x^3 + b * x^2 + c * x + d. It returns their number.
+			static size_t solveCubic(
+				const double a_,
+				const double b_,
+				const double c_,
+				const double d_,
+				double (&roots_)[3])
+			{
+				constexpr double pi = 3.14159265358979323846;
+				const double scale = std::max(std::max(std::abs(a_), std::abs(b_)), std::max(std::abs(c_), std::abs(d_)));
+				if (scale == 0.0)
+					return 0;
+
+				// Solve the quadratic (or linear) equation if the leading coefficient vanishes
+				if (std::abs(a_) < 1e-12 * scale)
+				{
+					if (std::abs(b_) < 1e-12 * scale)
+					{
+						if (c_ == 0.0)
+							return 0;
+						roots_[0] = -d_ / c_;
+						return 1;
+					}
+					const double discriminant = c_ * c_ - 4.0 * b_ * d_;
+					if (discriminant < 0.0)
+						return 0;
+					const double q = -0.5 * (c_ + std::copysign(std::sqrt(discriminant), c_));
+					roots_[0] = q / b_;
+					if (q == 0.0)
+						return 1;
+					roots_[1] = d_ / q;
+					return 2;
+				}
+
+				// Reduce to the depressed cubic t^3 + p * t + q with x = t - b / (3a)
+				const double b = b_ / a_, c = c_ / a_, d = d_ / a_;
+				const double shift = b / 3.0;
+				const double p = c - b * shift;
+				const double q = 2.0 * shift * shift * shift - shift * c + d;
+				const double discriminant = 0.25 * q * q + p * p * p / 27.0;
+
+				if (discriminant > 0.0)
+				{
+					// A single real root by the formula of Cardano
+					const double root_of_discriminant = std::sqrt(discriminant);
+					roots_[0] = std::cbrt(-0.5 * q + root_of_discriminant) + std::cbrt(-0.5 * q - root_of_discriminant) - shift;
+					return 1;
+				}
+
+				// Three real roots by the trigonometric method
+				const double radius = std::sqrt(std::max(0.0, -p / 3.0));
+				if (radius == 0.0)
+				{
+					roots_[0] = -shift;
+					return 1;
+				}
+				const double angle = std::acos(std::max(-1.0, std::min(1.0, -0.5 * q / (radius * radius * radius)))) / 3.0;
+				for (size_t root_idx = 0; root_idx < 3; ++root_idx)
+					roots_[root_idx] = 2.0 * radius * std::cos(angle - 2.0 * pi * root_idx / 3.0) - shift;
+				return 3;
+			}
+
+			// Checking the oriented epipolar constraint of O. Chum et al., i.e., if all points
+			// of the sample are in front of the cameras implied by the fundamental matrix. As in
+			// OpenCV, only the first coordinates of the epipolar lines are compared, thus, the
+			// x coordinates of the points in the first image are not needed.
+			template <size_t _PointNumber>
+			static bool isOrientationValid(
+				const Eigen::Matrix3d &fundamental_matrix_, // The fundamental matrix
+				const double (&y1_)[_PointNumber], // The y coordinates of the points in the first image
+				const double (&x2_)[_PointNumber], // The coordinates of the points in the second image
+				const double (&y2_)[_PointNumber])
+			{
+				// The epipole in the first image
+				Eigen::Vector3d epipole = fundamental_matrix_.row(0).cross(fundamental_matrix_.row(2));
+				if (epipole.squaredNorm() < 1e-20)
+					epipole = fundamental_matrix_.row(1).cross(fundamental_matrix_.row(2));
+
+				// The signum of the first point determines the orientation
+				const auto signum = [&](const size_t i)
+				{
+					const double line_coordinate = fundamental_matrix_(0, 0) * x2_[i] + fundamental_matrix_(1, 0) * y2_[i] + fundamental_matrix_(2, 0);
+					const double epipolar_coordinate = epipole(1) - epipole(2) * y1_[i];
+					return line_coordinate * epipolar_coordinate;
+				};
+
+				const bool is_positive = signum(0) > 0.0;
+				for (size_t i = 1; i < _PointNumber; ++i)
+					if ((signum(i) > 0.0) != is_positive)
+						return false;
+				return true;
+			}
+		};
+
+		// The batched counterpart of a minimal solver. It is void if the solver has no batched version.
+		template <class _MinimalSolverEngine>
+		struct BatchSolverOf
+		{
+			typedef void type;
+		};
+
+		// Detecting if an estimator can estimate the models of multiple minimal samples in a single
+		// call, i.e., if it provides estimateModelsBatched and isBatchEstimationAvailable() is true.
+		template <class _Estimator, class = void>
+		struct HasBatchEstimation : std::false_type
+		{
+		};
+
+		template <class _Estimator>
+		struct HasBatchEstimation<_Estimator, std::void_t<decltype(_Estimator::isBatchEstimationAvailable())>> :
+			std::integral_constant<bool, _Estimator::isBatchEstimationAvailable()>
+		{
+		};
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+
+namespace magsac
+{
+	namespace utils
+	{
+		// A flag through which another thread can ask a run of MAGSAC to stop, e.g., when the user of an
+		// interactive tool moves to another image pair. The run checks it cooperatively in the sampling
+		// loop, in the verification passes and in the nested DEGENSAC run, and it returns the best model
+		// found so far.
+		class CancellationToken
+		{
+		public:
+			CancellationToken() :
+				is_cancelled(false)
+			{
+			}
+
+			// Asking the runs using the token to stop
+			void cancel()
+			{
+				is_cancelled.store(true, std::memory_order_relaxed);
+			}
+
+			// Making the token usable for a new run
+			void reset()
+			{
+				is_cancelled.store(false, std::memory_order_relaxed);
+			}
+
+			bool isCancelled() const
+			{
+				return is_cancelled.load(std::memory_order_relaxed);
+			}
+
+		protected:
+			std::atomic<bool> is_cancelled; // A flag saying if the runs have been asked to stop
+		};
+	}
+}
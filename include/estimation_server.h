@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace magsac
+{
+	namespace server
+	{
+		// The protocol of the estimation server (src/magsac_server.cpp). A client connects to the Unix
+		// domain socket of the server and sends requests on the connection one after the other. The
+		// points of a request are not sent through the socket. They are read from a POSIX shared memory
+		// object written by the client, which has to be kept unchanged until the response arrives.
+		// Each response is followed by the inlier bitset of the points if it was requested.
+		//
+		// In essential matrix fitting, the points have to be normalized by the intrinsic matrices (e.g.,
+		// by gcransac::utils::normalizeCorrespondences) and the maximum and reference thresholds have to
+		// be divided by the average of the focal lengths, as in src/main.cpp. The server does not normalize
+		// the points. If no reference threshold is given, the default one, which is in pixels, is normalized
+		// by the server.
+		constexpr uint32_t protocol_magic = 0x4353474d; // The first field of every message
+		constexpr size_t shared_memory_name_length = 64; // The maximum length of a shared memory name including the terminating zero
+		constexpr uint64_t maximum_stride = 1024; // The maximum distance of consecutive points in doubles
+
+		enum ProblemType : uint32_t
+		{
+			Homography = 0,
+			FundamentalMatrix = 1,
+			EssentialMatrix = 2
+		};
+
+		enum Status : uint32_t
+		{
+			Success = 0, // A model has been found
+			NoModel = 1, // The estimation has not found a model
+			InvalidRequest = 2, // The request is malformed
+			SharedMemoryError = 3 // The points cannot be read from the shared memory
+		};
+
+		struct EstimationRequest
+		{
+			uint32_t magic; // Has to be protocol_magic
+			uint32_t problem_type; // The type of the fitted model
+			char shared_memory_name[shared_memory_name_length]; // The name of the shared memory object holding the points, e.g., "/points"
+			uint64_t offset; // The position of the first point in the shared memory object in bytes
+			uint64_t point_number; // The number of points
+			uint64_t dimension; // The number of coordinates of a point, at least 4 (x1 y1 x2 y2)
+			uint64_t stride; // The distance of consecutive points in doubles, at least the dimension and at most maximum_stride
+			double confidence; // The required confidence in the results, in (0, 1)
+			double maximum_threshold; // The maximum noise scale sigma allowed, finite and positive
+			double reference_threshold; // The reference threshold of MAGSAC++, the default one is used if it is not finite and positive
+			uint64_t iteration_limit; // The maximum number of iterations
+			uint32_t use_magsac_plus_plus; // Decides if MAGSAC++ or the original MAGSAC is applied
+			uint32_t return_inlier_mask; // Decides if the inlier bitset is sent after the response
+			double intrinsics_source[9]; // The row-major intrinsic matrix of the source camera in essential matrix fitting
+			double intrinsics_destination[9]; // The row-major intrinsic matrix of the destination camera in essential matrix fitting
+		};
+
+		struct EstimationResponse
+		{
+			uint32_t magic; // protocol_magic
+			uint32_t status; // The outcome of the estimation
+			int32_t iteration_number; // The number of iterations done
+			uint32_t inlier_mask_word_number; // The number of 64-bit words of the inlier bitset following the response
+			uint64_t inlier_number; // The number of points closer to the model than the reference threshold
+			double score; // The score of the model
+			double elapsed_seconds; // The time of the estimation on the server
+			double model[9]; // The row-major parameters of the model
+		};
+
+		// Writing the whole buffer to a socket
+		inline bool sendAll(
+			const int socket_,
+			const void * const data_,
+			size_t size_)
+		{
+			const char *data = static_cast<const char *>(data_);
+			while (size_ > 0)
+			{
+				const ssize_t sent = send(socket_, data, size_, MSG_NOSIGNAL);
+				if (sent < 0 && errno == EINTR)
+					continue;
+				if (sent <= 0)
+					return false;
+				data += sent;
+				size_ -= sent;
+			}
+			return true;
+		}
+
+		// Reading the whole buffer from a socket. It returns false if the connection is closed.
+		inline bool receiveAll(
+			const int socket_,
+			void * const data_,
+			size_t size_)
+		{
+			char *data = static_cast<char *>(data_);
+			while (size_ > 0)
+			{
+				const ssize_t received = recv(socket_, data, size_, 0);
+				if (received < 0 && errno == EINTR)
+					continue;
+				if (received <= 0)
+					return false;
+				data += received;
+				size_ -= received;
+			}
+			return true;
+		}
+
+		// Connecting to the server listening on the given socket path. It returns -1 on failure.
+		inline int connectToServer(const char * const socket_path_)
+		{
+			sockaddr_un address;
+			memset(&address, 0, sizeof(address));
+			address.sun_family = AF_UNIX;
+			if (strlen(socket_path_) >= sizeof(address.sun_path))
+			{
+				fprintf(stderr, "The socket path '%s' is too long.\n", socket_path_);
+				return -1;
+			}
+			strcpy(address.sun_path, socket_path_);
+
+			const int client_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (client_socket < 0)
+				return -1;
+			if (connect(client_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0)
+			{
+				close(client_socket);
+				return -1;
+			}
+			return client_socket;
+		}
+
+		// Sending a request and receiving its response and the inlier bitset if it was requested
+		inline bool requestEstimation(
+			const int socket_, // The socket connected to the server
+			const EstimationRequest &request_, // The request
+			EstimationResponse &response_, // The response
+			std::vector<uint64_t> &inlier_mask_) // The inlier bitset of the points
+		{
+			if (!sendAll(socket_, &request_, sizeof(request_)) ||
+				!receiveAll(socket_, &response_, sizeof(response_)) ||
+				response_.magic != protocol_magic)
+				return false;
+
+			inlier_mask_.resize(response_.inlier_mask_word_number);
+			return receiveAll(socket_, inlier_mask_.data(), inlier_mask_.size() * sizeof(uint64_t));
+		}
+	}
+}
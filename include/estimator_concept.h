@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "model.h"
+#include "cancellation_token.h"
+
+namespace magsac
+{
+	namespace estimator
+	{
+		// The compile-time interface of the estimators used by MAGSAC. MAGSAC is instantiated with the
+		// concrete estimator type and calls it through that type, thus, if the estimator class is final
+		// (as the ones in estimators.h), the calls are bound statically and the residual functions can be
+		// inlined into the loops over the points even though gcransac declares them virtual.
+		template <class _Estimator, class = void>
+		struct IsMagsacEstimator : std::false_type
+		{
+		};
+
+		template <class _Estimator>
+		struct IsMagsacEstimator<_Estimator, std::void_t<
+			// The sample size has to be a constant expression
+			std::integral_constant<size_t, _Estimator::sampleSize()>,
+			std::integral_constant<size_t, _Estimator::getDegreesOfFreedom()>,
+			// The constants of the MAGSAC(++) weights and losses
+			decltype(_Estimator::getSigmaQuantile()),
+			decltype(_Estimator::getC()),
+			decltype(_Estimator::getUpperIncompleteGammaOfK()),
+			decltype(_Estimator::getLowerIncompleteGammaOfK()),
+			// The residuals used for the refinement and for the scoring
+			decltype(std::declval<const _Estimator &>().residual(
+				std::declval<const cv::Mat &>(), std::declval<const gcransac::Model &>())),
+			decltype(std::declval<const _Estimator &>().squaredResidual(
+				std::declval<const cv::Mat &>(), std::declval<const gcransac::Model &>())),
+			decltype(std::declval<const _Estimator &>().residualForScoring(
+				std::declval<const cv::Mat &>(), std::declval<const gcransac::Model &>())),
+			// The minimal and non-minimal estimation and the checks of the samples and the models
+			decltype(std::declval<const _Estimator &>().estimateModel(
+				std::declval<const cv::Mat &>(), std::declval<const size_t *>(), std::declval<std::vector<gcransac::Model> *>())),
+			decltype(std::declval<const _Estimator &>().estimateModelNonminimal(
+				std::declval<const cv::Mat &>(), std::declval<const size_t *>(), std::declval<size_t>(),
+				std::declval<std::vector<gcransac::Model> *>(), std::declval<const double *>())),
+			decltype(std::declval<const _Estimator &>().isValidSample(
+				std::declval<const cv::Mat &>(), std::declval<const size_t *>())),
+			decltype(std::declval<const _Estimator &>().isValidModel(
+				std::declval<gcransac::Model &>(), std::declval<const cv::Mat &>(), std::declval<const std::vector<size_t> &>(),
+				std::declval<const size_t *>(), std::declval<double>(), std::declval<bool &>()))>> :
+			std::true_type
+		{
+		};
+
+		// Detecting if an estimator runs a nested estimation which can be cancelled, i.e., if it
+		// provides setCancellationToken. MAGSAC::runAsync gives its token to such estimators.
+		template <class _Estimator, class = void>
+		struct HasCancellation : std::false_type
+		{
+		};
+
+		template <class _Estimator>
+		struct HasCancellation<_Estimator, std::void_t<decltype(std::declval<_Estimator &>().setCancellationToken(
+			std::declval<const magsac::utils::CancellationToken *>()))>> :
+			std::true_type
+		{
+		};
+	}
+}
@@ -4,14 +4,35 @@
 #include "fundamental_estimator.h"
 #include "homography_estimator.h"
 #include "model.h"
+#include "magsac.h"
+#include "batch_solvers.h"
+#include "fast_uniform_sampler.h"
+
+#include <memory>
 
 namespace magsac
 {
+	namespace solver
+	{
+		template <>
+		struct BatchSolverOf<gcransac::estimator::solver::HomographyFourPointSolver>
+		{
+			typedef HomographyFourPointBatchSolver type;
+		};
+
+		template <>
+		struct BatchSolverOf<gcransac::estimator::solver::FundamentalMatrixSevenPointSolver>
+		{
+			typedef FundamentalMatrixSevenPointBatchSolver type;
+		};
+	}
+
 	namespace estimator
 	{// This is the estimator class for estimating a fundamental matrix between two images. 
+	 // The estimator classes are final, thus, the calls of MAGSAC to them are bound at compile time.
 		template<class _MinimalSolverEngine,  // The solver used for estimating the model from a minimal sample
 			class _NonMinimalSolverEngine> // The solver used for estimating the model from a non-minimal sample
-			class HomographyEstimator :
+			class HomographyEstimator final :
 			public gcransac::estimator::RobustHomographyEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>
 		{
 		public:
@@ -21,6 +42,27 @@ namespace magsac
 				gcransac::estimator::RobustHomographyEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>()
 			{}
 
+			// The batched version of the minimal solver or void if there is none
+			typedef typename magsac::solver::BatchSolverOf<_MinimalSolverEngine>::type BatchSolver;
+
+			static constexpr bool isBatchEstimationAvailable()
+			{
+				return !std::is_void<BatchSolver>::value;
+			}
+
+			// Estimating the homographies of multiple minimal samples, stored one after the other, in a single
+			// call. The models are written to the beginning of the buffer and the index of the sample of each 
+			// model is stored. It returns the number of estimated models.
+			inline size_t estimateModelsBatched(const cv::Mat& data_,
+				const size_t *samples_,
+				const size_t sample_number_,
+				std::vector<gcransac::Model> &models_,
+				std::vector<size_t> &model_samples_) const
+			{
+				static_assert(isBatchEstimationAvailable(), "The minimal solver has no batched version.");
+				return BatchSolver().estimateModels(data_, samples_, sample_number_, models_, model_samples_);
+			}
+
 			// Calculating the residual which is used for the MAGSAC score calculation.
 			// Since symmetric epipolar distance is usually more robust than Sampson-error.
 			// we are using it for the score calculation.
@@ -78,7 +120,7 @@ namespace magsac
 		// This is the estimator class for estimating a fundamental matrix between two images. 
 		template<class _MinimalSolverEngine,  // The solver used for estimating the model from a minimal sample
 			class _NonMinimalSolverEngine> // The solver used for estimating the model from a non-minimal sample
-			class FundamentalMatrixEstimator :
+			class FundamentalMatrixEstimator final :
 			public gcransac::estimator::FundamentalMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>
 		{
 		protected:
@@ -87,6 +129,34 @@ namespace magsac
 			using gcransac::estimator::FundamentalMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>::squared_homography_threshold;
 
 			const double maximum_threshold;
+			size_t degensac_iteration_limit; // The maximum number of iterations of the nested plane-and-parallax estimation
+			double degensac_time_limit; // The time limit of the nested plane-and-parallax estimation in seconds
+			magsac::utils::EstimationMetrics *metrics; // The metrics to which the DEGENSAC checks are added, if given
+			magsac::utils::RunTracer *tracer; // The tracer recording DEGENSAC and the nested MAGSAC runs, if given
+			const magsac::utils::CancellationToken *cancellation_token; // The token interrupting the nested MAGSAC runs, if given
+
+			// The estimator used for the plane-and-parallax estimation in DEGENSAC
+			typedef FundamentalMatrixEstimator<
+				gcransac::estimator::solver::FundamentalMatrixPlaneParallaxSolver, // The solver used for fitting a model to a minimal sample
+				gcransac::estimator::solver::FundamentalMatrixEightPointSolver> // The solver used for fitting a model to a non-minimal sample
+				PlaneParallaxEstimator;
+
+			// The state of the nested plane-and-parallax estimation. It is created when DEGENSAC
+			// is first applied and it is reused by the later calls to avoid reallocating it for
+			// every H-degenerate sample.
+			struct DegensacState
+			{
+				std::vector<size_t> homography_inliers; // The inliers of the homography
+				std::vector<size_t> sampling_pool; // The points which are not inliers of the homography, from which the plane-and-parallax samples are selected
+				std::vector<gcransac::Model> homographies; // The homographies estimated from the inliers
+				Eigen::Matrix3d nonminimal_homography; // The homography used by the plane-and-parallax solver
+				gcransac::Model model; // The model estimated by the plane-and-parallax estimation
+				std::unique_ptr<PlaneParallaxEstimator> estimator; // The plane-and-parallax estimator
+				std::unique_ptr<MAGSAC<cv::Mat, PlaneParallaxEstimator>> magsac; // The nested MAGSAC
+				MAGSAC<cv::Mat, PlaneParallaxEstimator>::RunContext magsac_context; // The state of the nested MAGSAC runs
+				std::unique_ptr<magsac::sampler::FastUniformSampler> sampler; // The sampler used in the nested MAGSAC. It reads only the pool, thus, it serves any data points.
+			};
+			mutable std::unique_ptr<DegensacState> degensac_state;
 
 		public:
 			using gcransac::estimator::FundamentalMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>::squaredSymmetricEpipolarDistance;
@@ -98,11 +168,85 @@ namespace magsac
 				const bool apply_degensac_ = true,
 				const double degensac_homography_threshold_ = 3.0) :
 				maximum_threshold(maximum_threshold_),
+				degensac_iteration_limit(10000),
+				degensac_time_limit(-1),
+				metrics(nullptr),
+				tracer(nullptr),
+				cancellation_token(nullptr),
 				gcransac::estimator::FundamentalMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>(minimum_inlier_ratio_in_validity_check_,
 					apply_degensac_,
 					degensac_homography_threshold_)
 			{}
 
+			// Copying the settings of the estimator. The state of the nested DEGENSAC estimation is neither
+			// shared nor copied, the copy creates its own when it first applies DEGENSAC.
+			FundamentalMatrixEstimator(const FundamentalMatrixEstimator &other_) :
+				gcransac::estimator::FundamentalMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>(other_),
+				maximum_threshold(other_.maximum_threshold),
+				degensac_iteration_limit(other_.degensac_iteration_limit),
+				degensac_time_limit(other_.degensac_time_limit),
+				metrics(other_.metrics),
+				tracer(other_.tracer),
+				cancellation_token(other_.cancellation_token),
+				degensac_state(nullptr)
+			{}
+
+			// The batched version of the minimal solver or void if there is none
+			typedef typename magsac::solver::BatchSolverOf<_MinimalSolverEngine>::type BatchSolver;
+
+			static constexpr bool isBatchEstimationAvailable()
+			{
+				return !std::is_void<BatchSolver>::value;
+			}
+
+			// Estimating the fundamental matrices of multiple minimal samples, stored one after the other, in a 
+			// single call. The models are written to the beginning of the buffer and the index of the sample of
+			// each model is stored. It returns the number of estimated models. The models are checked by the
+			// oriented epipolar constraint as the ones estimated from a single sample.
+			inline size_t estimateModelsBatched(const cv::Mat& data_,
+				const size_t *samples_,
+				const size_t sample_number_,
+				std::vector<gcransac::Model> &models_,
+				std::vector<size_t> &model_samples_) const
+			{
+				static_assert(isBatchEstimationAvailable(), "The minimal solver has no batched version.");
+				return BatchSolver().estimateModels(data_, samples_, sample_number_, models_, model_samples_);
+			}
+
+			// Setting the maximum number of iterations of the nested plane-and-parallax 
+			// estimation applied when a sample is H-degenerate. It is 10000 by default.
+			void setDegensacIterationLimit(const size_t iteration_limit_)
+			{
+				degensac_iteration_limit = iteration_limit_;
+			}
+
+			// Setting the time limit (in seconds) of the nested plane-and-parallax estimation 
+			// applied when a sample is H-degenerate. A non-positive value removes the limit.
+			void setDegensacTimeLimit(const double time_limit_)
+			{
+				degensac_time_limit = time_limit_;
+			}
+
+			// Setting the metrics to which the DEGENSAC checks and the H-degenerate samples are added
+			void setMetrics(magsac::utils::EstimationMetrics *metrics_)
+			{
+				metrics = metrics_;
+			}
+
+			// Setting the tracer recording the DEGENSAC checks and the nested plane-and-parallax
+			// estimation. It is usually the tracer given to the MAGSAC running this estimator.
+			void setTracer(magsac::utils::RunTracer *tracer_)
+			{
+				tracer = tracer_;
+			}
+
+			// Setting the token through which the nested plane-and-parallax estimation can be cancelled.
+			// MAGSAC::runAsync sets it to the token of the run.
+			void setCancellationToken(const magsac::utils::CancellationToken *cancellation_token_)
+			{
+				cancellation_token = cancellation_token_;
+			}
+
 			// Calculating the residual which is used for the MAGSAC score calculation.
 			// Since symmetric epipolar distance is usually more robust than Sampson-error.
 			// we are using it for the score calculation.
@@ -175,7 +319,9 @@ namespace magsac
 				// every so-far-the-best model is checked if it has enough inlier with symmetric
 				bool passed = false;
 				size_t inlier_number = 0; // Number of inlier if using symmetric epipolar distance
-				const Eigen::Matrix3d &descriptor = model_.descriptor; // The decriptor of the current model
+				// The decriptor of the current model. It is bound as it is since the residual function takes a dynamic 
+				// matrix and binding it to a fixed-size one would convert it back for every point.
+				const Eigen::MatrixXd &descriptor = model_.descriptor;
 				constexpr size_t sample_size = gcransac::estimator::FundamentalMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>::sampleSize(); // Size of a minimal sample
 				// Minimum number of inliers which should be inlier as well when using symmetric epipolar distance instead of Sampson distance
 				const size_t inliers_to_pass = inliers_.size() * gcransac::estimator::FundamentalMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>::minimum_inlier_ratio_in_validity_check;
@@ -188,7 +334,7 @@ namespace magsac
 				for (const auto &idx : inliers_)
 					// Calculate the residual using symmetric epipolar distance and check if
 					// it is smaller than the threshold_.
-					if (gcransac::estimator::FundamentalMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>::squaredSymmetricEpipolarDistance(data_.row(idx), descriptor) < squared_threshold)
+					if (squaredSymmetricEpipolarDistance(data_.row(idx), descriptor) < squared_threshold)
 						// Increase the inlier number and terminate if enough inliers_ have been found.
 						if (++inlier_number >= minimum_inlier_number)
 						{
@@ -215,6 +361,28 @@ namespace magsac
 				return true;
 			}
 
+			// The squared re-projection error of a correspondence w.r.t. a fixed-size homography
+			static inline double squaredReprojectionError(const double *point_ptr_, // The coordinates x1 y1 x2 y2 of the correspondence
+				const Eigen::Matrix3d &homography_) // The homography
+			{
+				const double &x1 = point_ptr_[0], // The x coordinate in the first image
+					&y1 = point_ptr_[1], // The y coordinate in the first image
+					&x2 = point_ptr_[2], // The x coordinate in the second image
+					&y2 = point_ptr_[3]; // The y coordinate in the second image
+
+				// Calculating H * p
+				const double t1 = homography_(0, 0) * x1 + homography_(0, 1) * y1 + homography_(0, 2),
+					t2 = homography_(1, 0) * x1 + homography_(1, 1) * y1 + homography_(1, 2),
+					t3 = homography_(2, 0) * x1 + homography_(2, 1) * y1 + homography_(2, 2);
+
+				// Calculating the difference of the projected and original points
+				const double d1 = x2 - (t1 / t3),
+					d2 = y2 - (t2 / t3);
+
+				// Calculating the squared re-projection error
+				return d1 * d1 + d2 * d2;
+			}
+
 			//  Evaluate the H-degenerate sample test and apply DEGENSAC if needed
 			inline bool applyDegensac(gcransac::Model& model_, // The input model to be tested
 				const cv::Mat& data_, // All data points
@@ -223,9 +391,13 @@ namespace magsac
 				const double threshold_, // The inlier-outlier threshold
 				bool &model_updated_) const // A flag saying if the model has been updated here
 			{
+				MAGSAC_TRACE_SPAN(tracer, "applyDegensac");
 				// Set the flag initially to false since the model has not been yet updated.
 				model_updated_ = false;
 
+				if (metrics != nullptr)
+					metrics->add(magsac::utils::EstimationMetrics::DegensacCheckNumber);
+
 				// The possible triplets of points
 				constexpr size_t triplets[] = {
 					0, 1, 2,
@@ -236,8 +408,9 @@ namespace magsac
 				constexpr size_t number_of_triplets = 5; // The number of triplets to be tested
 				const size_t columns = data_.cols; // The number of columns in the data matrix
 
-				// The fundamental matrix coming from the minimal sample
-				const Eigen::Matrix3d &fundamental_matrix =
+				// The fundamental matrix coming from the minimal sample. It is copied to a fixed-size matrix
+				// so the products below are evaluated on the stack.
+				const Eigen::Matrix3d fundamental_matrix =
 					model_.descriptor.block<3, 3>(0, 0);
 
 				// Applying SVD decomposition to the estimated fundamental matrix
@@ -256,7 +429,7 @@ namespace magsac
 					-epipole(1), epipole(0), 0;
 
 				const Eigen::Matrix3d A =
-					epipolar_cross * model_.descriptor;
+					epipolar_cross * fundamental_matrix;
 
 				// A flag deciding if the sample is H-degenerate
 				bool h_degenerate_sample = false;
@@ -326,30 +499,11 @@ namespace magsac
 							idx == point_3_idx)
 							continue; // If yes, the error does not have to be calculated
 
-						// Calculate the re-projection error
-						const double *point_ptr =
-							reinterpret_cast<double *>(data_.data) + idx * columns;
-
-						const double &x1 = point_ptr[0], // The x coordinate in the first image
-							&y1 = point_ptr[1], // The y coordinate in the first image
-							&x2 = point_ptr[2], // The x coordinate in the second image
-							&y2 = point_ptr[3]; // The y coordinate in the second image
-
-						// Calculating H * p
-						const double t1 = homography(0, 0) * x1 + homography(0, 1) * y1 + homography(0, 2),
-							t2 = homography(1, 0) * x1 + homography(1, 1) * y1 + homography(1, 2),
-							t3 = homography(2, 0) * x1 + homography(2, 1) * y1 + homography(2, 2);
-
-						// Calculating the difference of the projected and original points
-						const double d1 = x2 - (t1 / t3),
-							d2 = y2 - (t2 / t3);
-
-						// Calculating the squared re-projection error
-						const double squared_residual = d1 * d1 + d2 * d2;
-
 						// If the squared re-projection error is smaller than the threshold, 
 						// consider the point inlier.
-						if (squared_residual < squared_homography_threshold)
+						const double *point_ptr =
+							reinterpret_cast<double *>(data_.data) + idx * columns;
+						if (squaredReprojectionError(point_ptr, homography) < squared_homography_threshold)
 							++inlier_number;
 					}
 
@@ -368,29 +522,66 @@ namespace magsac
 				// If the sample is H-degenerate
 				if (h_degenerate_sample)
 				{
+					if (metrics != nullptr)
+						metrics->add(magsac::utils::EstimationMetrics::DegensacTriggerNumber);
+
 					// Declare a homography estimator to be able to calculate the residual and the homography from a non-minimal sample
 					static const magsac::estimator::HomographyEstimator<
 						gcransac::estimator::solver::HomographyFourPointSolver, // The solver used for fitting a model to a minimal sample
 						gcransac::estimator::solver::HomographyFourPointSolver> homography_estimator;
 
+					// Initialize the state of the nested estimation when DEGENSAC is applied the first time
+					if (degensac_state == nullptr)
+					{
+						degensac_state = std::unique_ptr<DegensacState>(new DegensacState());
+						degensac_state->estimator = std::unique_ptr<PlaneParallaxEstimator>(
+							new PlaneParallaxEstimator(maximum_threshold, 0.0, false));
+						degensac_state->magsac = std::unique_ptr<MAGSAC<cv::Mat, PlaneParallaxEstimator>>(
+							new MAGSAC<cv::Mat, PlaneParallaxEstimator>());
+						degensac_state->sampler = std::unique_ptr<magsac::sampler::FastUniformSampler>(
+							new magsac::sampler::FastUniformSampler(&data_));
+					}
+					DegensacState &state = *degensac_state;
+
 					// The inliers of the homography
-					std::vector<size_t> homography_inliers;
+					std::vector<size_t> &homography_inliers = state.homography_inliers;
+					homography_inliers.clear();
 					homography_inliers.reserve(inliers_.size());
 
 					// Iterate through the inliers of the fundamental matrix
 					// and select those which are inliers of the homography as well.
-					//for (size_t inlier_idx = 0; inlier_idx < data_.rows; ++inlier_idx)
 					for (const size_t &inlier_idx : inliers_)
-						if (homography_estimator.squaredResidual(data_.row(inlier_idx), best_homography) < squared_homography_threshold)
+						if (squaredReprojectionError(reinterpret_cast<double *>(data_.data) + inlier_idx * columns, best_homography) < squared_homography_threshold)
 							homography_inliers.emplace_back(inlier_idx);
 
 					// If the homography does not have enough inliers to be estimated, terminate.
 					if (homography_inliers.size() < homography_estimator.nonMinimalSampleSize())
 						return false;
 
+					// All points which are not consistent with the homography. Only these points are used for
+					// selecting the minimal samples of the plane-and-parallax solver since the parallax cannot
+					// be determined from points on the plane. The points off the plane are usually not inliers
+					// of the H-degenerate fundamental matrix, thus, they are selected from all points.
+					std::vector<size_t> &sampling_pool = state.sampling_pool;
+					sampling_pool.clear();
+					sampling_pool.reserve(data_.rows);
+					for (size_t point_idx = 0; point_idx < static_cast<size_t>(data_.rows); ++point_idx)
+						if (squaredReprojectionError(data_.ptr<double>(static_cast<int>(point_idx)), best_homography) >= squared_homography_threshold)
+							sampling_pool.emplace_back(point_idx);
+
+					// If almost all points are consistent with the homography, the samples are selected from 
+					// all points as without the pool.
+					if (sampling_pool.size() < PlaneParallaxEstimator::sampleSize())
+					{
+						sampling_pool.resize(data_.rows);
+						for (size_t point_idx = 0; point_idx < sampling_pool.size(); ++point_idx)
+							sampling_pool[point_idx] = point_idx;
+					}
+
 					// The set of estimated homographies. For all implemented solvers,
 					// this should be of size 1.
-					std::vector<gcransac::Model> homographies;
+					std::vector<gcransac::Model> &homographies = state.homographies;
+					homographies.clear();
 
 					// Estimate the homography parameters from the provided inliers.
 					homography_estimator.estimateModelNonminimal(data_, // All data points
@@ -403,47 +594,45 @@ namespace magsac
 					if (homographies.size() != 1)
 						return false;
 
-					// Get the reference of the homography fit to the non-minimal sample
-					const Eigen::Matrix3d &nonminimal_homography =
-						homographies[0].descriptor;
+					// Store the homography fit to the non-minimal sample
+					state.nonminimal_homography = homographies[0].descriptor;
 
-					// Do a local GC-RANSAC to determine the parameters of the fundamental matrix by
+					// Do a local MAGSAC to determine the parameters of the fundamental matrix by
 					// the plane-and-parallax algorithm using the determined homography.
-					magsac::estimator::FundamentalMatrixEstimator<
-						gcransac::estimator::solver::FundamentalMatrixPlaneParallaxSolver, // The solver used for fitting a model to a minimal sample
-						gcransac::estimator::solver::FundamentalMatrixEightPointSolver> estimator(maximum_threshold, 0.0, false);
-					estimator.getMinimalSolver()->setHomography(&nonminimal_homography);
+					state.estimator->getMinimalSolver()->setHomography(&state.nonminimal_homography);
 
-					std::vector<int> inliers;
-					gcransac::Model model;
+					gcransac::Model &model = state.model;
 
-					MAGSAC<cv::Mat, magsac::estimator::FundamentalMatrixEstimator<
-						gcransac::estimator::solver::FundamentalMatrixPlaneParallaxSolver, // The solver used for fitting a model to a minimal sample
-						gcransac::estimator::solver::FundamentalMatrixEightPointSolver>> magsac;
+					MAGSAC<cv::Mat, PlaneParallaxEstimator> &magsac = *state.magsac;
 					magsac.setMaximumThreshold(maximum_threshold); // The maximum noise scale sigma allowed
 					magsac.setReferenceThreshold(threshold_);
-					magsac.setIterationLimit(1e4); // Iteration limit to interrupt the cases when the algorithm run too long.
-
-					gcransac::sampler::UniformSampler sampler(&data_); // The local optimization sampler is used inside the local optimization
+					magsac.setIterationLimit(degensac_iteration_limit); // Iteration limit to interrupt the cases when the algorithm run too long.
+					magsac.setMinimumIterationNumber(MIN(degensac_iteration_limit, 50)); // The minimum iteration number should not exceed the budget
+					magsac.setTimeLimit(degensac_time_limit); // Time limit to interrupt the cases when the algorithm run too long.
+					magsac.setTracer(tracer); // The nested run is shown inside the span of DEGENSAC
 
 					int iteration_number = 0; // Number of iterations required
 					ModelScore score;
+					state.magsac_context.cancellation_token = cancellation_token;
 					const bool success = magsac.run(data_, // The data points
 						0.99, // The required confidence in the results
-						estimator, // The used estimator
-						sampler, // The sampler used for selecting minimal samples in each iteration
+						*state.estimator, // The used estimator
+						*state.sampler, // The sampler used for selecting minimal samples in each iteration
 						model, // The estimated model
 						iteration_number, // The number of iterations
-						score);
+						score, // The score of the estimated model
+						sampling_pool, // The points from which the minimal samples are selected
+						state.magsac_context); // The state of the run
 					
 					// If more inliers are found the what initially was given,
 					// update the model parameters.
-					if (score.inlier_number >= inliers_.size())
+					if (success &&
+						score.inlier_number >= inliers_.size())
 					{
 						// Consider the model to be updated
 						model_updated_ = true;
-						// Update the parameters
-						model_ = model;	
+						// Update the parameters. Swapping the descriptors moves them without copying.
+						model_.descriptor.swap(model.descriptor);
 					}
 				}
 
@@ -455,11 +644,12 @@ namespace magsac
 		// This is the estimator class for estimating a fundamental matrix between two images. 
 		template<class _MinimalSolverEngine,  // The solver used for estimating the model from a minimal sample
 			class _NonMinimalSolverEngine> // The solver used for estimating the model from a non-minimal sample
-			class EssentialMatrixEstimator :
+			class EssentialMatrixEstimator final :
 			public gcransac::estimator::EssentialMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>
 		{
 		public:
 			using gcransac::estimator::EssentialMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>::squaredSymmetricEpipolarDistance;
+			using gcransac::estimator::EssentialMatrixEstimator<_MinimalSolverEngine, _NonMinimalSolverEngine>::residual;
 
 			EssentialMatrixEstimator(Eigen::Matrix3d intrinsics_src_, // The intrinsic parameters of the source camera
 				Eigen::Matrix3d intrinsics_dst_,  // The intrinsic parameters of the destination camera
@@ -481,6 +671,14 @@ namespace magsac
 				return squaredSymmetricEpipolarDistance(point_, model_.descriptor);
 			}
 
+			// The residual used for comparing the resulting model with other models, e.g., when
+			// selecting its inliers by a threshold
+			inline double residualOtherForScoring(const cv::Mat& point_,
+				const gcransac::Model& model_) const
+			{
+				return residual(point_, model_.descriptor);
+			}
+
 			static constexpr double getSigmaQuantile()
 			{
 				return 3.64;
@@ -538,3 +736,12 @@ namespace magsac
 			DefaultHomographyEstimator;
 	}
 }
+
+// MAGSAC is instantiated for the default estimators and for the plane-and-parallax estimator of DEGENSAC
+// once, in the MAGSAC library (src/magsac_api.cpp). The translation units using them only link it.
+extern template class MAGSAC<cv::Mat, magsac::utils::DefaultEssentialMatrixEstimator>;
+extern template class MAGSAC<cv::Mat, magsac::utils::DefaultFundamentalMatrixEstimator>;
+extern template class MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator>;
+extern template class MAGSAC<cv::Mat, magsac::estimator::FundamentalMatrixEstimator<
+	gcransac::estimator::solver::FundamentalMatrixPlaneParallaxSolver,
+	gcransac::estimator::solver::FundamentalMatrixEightPointSolver>>;
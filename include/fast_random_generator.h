@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+namespace magsac
+{
+	namespace utils
+	{
+		// A fast, seedable pseudo-random number generator implementing xoshiro256++
+		// (D. Blackman and S. Vigna, "Scrambled linear pseudorandom number generators", 2018).
+		// It has a period of 2^256 - 1 and a jump function which advances the state by 2^128 steps.
+		// The jumps are used for creating independent streams, e.g., one for each thread,
+		// from the same seed. The generated sequence depends only on the seed and the stream index.
+		class FastRandomGenerator
+		{
+		public:
+			typedef uint64_t result_type;
+
+			explicit FastRandomGenerator(
+				const uint64_t seed_ = 0, // The seed of the generator
+				const size_t stream_ = 0) // The index of the stream
+			{
+				seed(seed_, stream_);
+			}
+
+			// Resetting the generator to the beginning of a stream
+			void seed(
+				const uint64_t seed_, // The seed of the generator
+				const size_t stream_ = 0) // The index of the stream
+			{
+				// Initialize the state by SplitMix64 as recommended by the authors of xoshiro
+				uint64_t splitmix_state = seed_;
+				for (size_t i = 0; i < 4; ++i)
+				{
+					uint64_t z = (splitmix_state += 0x9e3779b97f4a7c15ULL);
+					z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+					z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+					state[i] = z ^ (z >> 31);
+				}
+
+				// Move to the beginning of the required stream
+				for (size_t stream_idx = 0; stream_idx < stream_; ++stream_idx)
+					jump();
+			}
+
+			static constexpr uint64_t min() { return 0; }
+			static constexpr uint64_t max() { return ~uint64_t(0); }
+
+			// Generating the next 64-bit random number
+			inline uint64_t operator()()
+			{
+				const uint64_t result = rotateLeft(state[0] + state[3], 23) + state[0];
+				const uint64_t t = state[1] << 17;
+
+				state[2] ^= state[0];
+				state[3] ^= state[1];
+				state[1] ^= state[2];
+				state[0] ^= state[3];
+				state[2] ^= t;
+				state[3] = rotateLeft(state[3], 45);
+
+				return result;
+			}
+
+			// Generating a uniformly distributed real number from [0, 1). It is made of the upper
+			// 53 bits of the next number, thus, every representable value is equally likely.
+			inline double uniform()
+			{
+				return (operator()() >> 11) * (1.0 / 9007199254740992.0);
+			}
+
+			// Generating a uniformly distributed random number from [0, range_) without bias.
+			// It uses the multiply-shift method of D. Lemire ("Fast random integer generation
+			// in an interval", 2019) which needs a division only in rare cases.
+			inline uint64_t bounded(const uint64_t range_)
+			{
+				uint64_t high;
+				uint64_t low = multiply(operator()(), range_, high);
+				if (low < range_)
+				{
+					// The threshold below which the low part would cause bias
+					const uint64_t threshold = (0 - range_) % range_;
+					while (low < threshold)
+						low = multiply(operator()(), range_, high);
+				}
+				return high;
+			}
+
+			// Selecting sample_size_ unique random numbers from [0, range_) by the algorithm of
+			// R. Floyd. It uses exactly sample_size_ random numbers and needs no rejection, thus,
+			// it is fast for the small sample sizes (e.g., 4, 5 or 7) of the minimal solvers.
+			// Every subset is equally likely, however, the order of the selected numbers is not random.
+			inline void uniqueSample(
+				size_t * const sample_, // The selected numbers
+				const size_t sample_size_, // The number of the numbers to be selected
+				const size_t range_) // The numbers are selected from [0, range_)
+			{
+				for (size_t i = 0; i < sample_size_; ++i)
+				{
+					// The current upper bound of the range
+					const size_t j = range_ - sample_size_ + i;
+					// Select a random number from [0, j]
+					size_t value = static_cast<size_t>(bounded(j + 1));
+
+					// If the number has already been selected, replace it by j which cannot be selected yet
+					for (size_t k = 0; k < i; ++k)
+						if (sample_[k] == value)
+						{
+							value = j;
+							break;
+						}
+					sample_[i] = value;
+				}
+			}
+
+			// Advancing the state by 2^128 steps. It is equivalent to calling
+			// operator() 2^128 times and it is used for creating independent streams.
+			void jump()
+			{
+				static constexpr uint64_t jump_polynomial[] = {
+					0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+				uint64_t new_state[4] = { 0, 0, 0, 0 };
+				for (size_t i = 0; i < 4; ++i)
+					for (size_t bit = 0; bit < 64; ++bit)
+					{
+						if (jump_polynomial[i] & (uint64_t(1) << bit))
+							for (size_t j = 0; j < 4; ++j)
+								new_state[j] ^= state[j];
+						operator()();
+					}
+
+				for (size_t i = 0; i < 4; ++i)
+					state[i] = new_state[i];
+			}
+
+		protected:
+			uint64_t state[4]; // The state of the generator
+
+			static inline uint64_t rotateLeft(const uint64_t x_, const int k_)
+			{
+				return (x_ << k_) | (x_ >> (64 - k_));
+			}
+
+			// Calculating the 128-bit product of two 64-bit numbers
+			static inline uint64_t multiply(const uint64_t a_, const uint64_t b_, uint64_t &high_)
+			{
+#if defined(_MSC_VER) && defined(_M_X64)
+				return _umul128(a_, b_, &high_);
+#elif defined(__SIZEOF_INT128__)
+				const unsigned __int128 product = static_cast<unsigned __int128>(a_) * b_;
+				high_ = static_cast<uint64_t>(product >> 64);
+				return static_cast<uint64_t>(product);
+#else
+				// Portable version composing the product from 32-bit parts
+				const uint64_t a_low = a_ & 0xffffffffULL, a_high = a_ >> 32;
+				const uint64_t b_low = b_ & 0xffffffffULL, b_high = b_ >> 32;
+				const uint64_t low_low = a_low * b_low;
+				const uint64_t high_low = a_high * b_low;
+				const uint64_t low_high = a_low * b_high;
+				const uint64_t middle = (low_low >> 32) + (high_low & 0xffffffffULL) + low_high;
+				high_ = a_high * b_high + (high_low >> 32) + (middle >> 32);
+				return (middle << 32) | (low_low & 0xffffffffULL);
+#endif
+			}
+		};
+	}
+}
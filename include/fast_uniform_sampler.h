@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "sampler.h"
+#include "fast_random_generator.h"
+
+namespace magsac
+{
+	namespace sampler
+	{
+		// A uniform sampler selecting the minimal samples by a fast, seedable random number generator.
+		// The selected samples depend only on the seed and the stream index, thus, the results are
+		// reproducible. When multiple MAGSACs run in parallel, each thread should use its own sampler
+		// with the same seed and a different stream index to get independent samples.
+		class FastUniformSampler : public gcransac::sampler::Sampler<cv::Mat, size_t>
+		{
+		protected:
+			magsac::utils::FastRandomGenerator random_generator; // The random number generator
+			uint64_t seed; // The seed of the generator
+			size_t stream; // The index of the stream used
+
+		public:
+			explicit FastUniformSampler(
+				const cv::Mat * const container_, // The data points
+				const uint64_t seed_ = 0, // The seed of the random number generator
+				const size_t stream_ = 0) // The index of the stream, e.g., the index of the thread
+				: Sampler(container_),
+				random_generator(seed_, stream_),
+				seed(seed_),
+				stream(stream_)
+			{
+				initialized = initialize(container_);
+			}
+
+			~FastUniformSampler() {}
+
+			const std::string getName() const { return "Fast Uniform Sampler"; }
+
+			// Restarting the stream so the same samples are selected again
+			void reset()
+			{
+				random_generator.seed(seed, stream);
+			}
+
+			bool initialize(const cv::Mat * const)
+			{
+				return true;
+			}
+
+			// Selecting a minimal sample uniformly from the pool
+			inline bool sample(
+				const std::vector<size_t> &pool_, // The indices of the points from which the sample is selected
+				size_t * const subset_, // The selected sample
+				size_t sample_size_) // The size of the sample
+			{
+				if (sample_size_ > pool_.size())
+					return false;
+
+				// Select the positions in the pool and replace them by the point indices
+				random_generator.uniqueSample(subset_, sample_size_, pool_.size());
+				for (size_t i = 0; i < sample_size_; ++i)
+					subset_[i] = pool_[subset_[i]];
+				return true;
+			}
+		};
+	}
+}
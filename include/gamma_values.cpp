@@ -1,10 +1,6 @@
+#include "gamma_values.h"
 
-constexpr unsigned int stored_gamma_number = 36000;
-constexpr unsigned int stored_incomplete_gamma_number = 100000;
-constexpr double precision_of_stored_gammas = 989;
-constexpr double precision_of_stored_incomplete_gammas = 1e4;
-
-constexpr double stored_complete_gamma_values[] = { 0.886226925453, 0.886226258826, 0.886225040061, 0.886223461975, 0.886221593399, 0.886219474129, 0.88621713102, 0.886214583798, 0.886211847747, 0.88620893517, 0.886205856246, 0.886202619584, 0.886199232585, 0.886195701704, 0.886192032637, 0.886188230457, 0.886184299723, 0.886180244557, 0.886176068714, 0.886171775633, 0.886167368476, 0.886162850169, 0.886158223423, 0.886153490766, 0.886148654557, 0.886143717008, 0.886138680197, 0.886133546083, 0.886128316513, 0.886122993236, 0.88611757791, 0.886112072111, 0.886106477336, 0.886100795013, 0.886095026506, 0.886089173117, 0.886083236093, 0.886077216629, 0.886071115872, 0.886064934922, 0.886058674838, 0.88605233664, 0.886045921309, 0.886039429793, 0.886032863004, 0.886026221827, 0.886019507114, 0.886012719692, 0.886005860359, 0.885998929891, 0.885991929038, 0.885984858529, 0.885977719071, 0.88597051135, 0.885963236035, 0.885955893775, 0.8859484852, 0.885941010926, 0.885933471552, 0.885925867659, 0.885918199818, 0.885910468582, 0.885902674492, 0.885894818075, 0.885886899848, 0.885878920314, 0.885870879964, 0.88586277928, 0.885854618731, 0.885846398777, 0.885838119868, 0.885829782445, 0.885821386939, 0.885812933771, 0.885804423356, 0.885795856099, 0.885787232397, 0.88577855264, 0.88576981721, 0.885761026481, 0.885752180823, 0.885743280594, 0.885734326151, 0.88572531784, 0.885716256004, 0.885707140978, 0.885697973092, 0.88568875267, 0.885679480032, 0.885670155489, 0.885660779351, 0.88565135192, 0.885641873495, 0.885632344368, 0.885622764829, 0.885613135162, 0.885603455645, 0.885593726555, 0.885583948163, 0.885574120736,
+const double stored_complete_gamma_values[] = { 0.886226925453, 0.886226258826, 0.886225040061, 0.886223461975, 0.886221593399, 0.886219474129, 0.88621713102, 0.886214583798, 0.886211847747, 0.88620893517, 0.886205856246, 0.886202619584, 0.886199232585, 0.886195701704, 0.886192032637, 0.886188230457, 0.886184299723, 0.886180244557, 0.886176068714, 0.886171775633, 0.886167368476, 0.886162850169, 0.886158223423, 0.886153490766, 0.886148654557, 0.886143717008, 0.886138680197, 0.886133546083, 0.886128316513, 0.886122993236, 0.88611757791, 0.886112072111, 0.886106477336, 0.886100795013, 0.886095026506, 0.886089173117, 0.886083236093, 0.886077216629, 0.886071115872, 0.886064934922, 0.886058674838, 0.88605233664, 0.886045921309, 0.886039429793, 0.886032863004, 0.886026221827, 0.886019507114, 0.886012719692, 0.886005860359, 0.885998929891, 0.885991929038, 0.885984858529, 0.885977719071, 0.88597051135, 0.885963236035, 0.885955893775, 0.8859484852, 0.885941010926, 0.885933471552, 0.885925867659, 0.885918199818, 0.885910468582, 0.885902674492, 0.885894818075, 0.885886899848, 0.885878920314, 0.885870879964, 0.88586277928, 0.885854618731, 0.885846398777, 0.885838119868, 0.885829782445, 0.885821386939, 0.885812933771, 0.885804423356, 0.885795856099, 0.885787232397, 0.88577855264, 0.88576981721, 0.885761026481, 0.885752180823, 0.885743280594, 0.885734326151, 0.88572531784, 0.885716256004, 0.885707140978, 0.885697973092, 0.88568875267, 0.885679480032, 0.885670155489, 0.885660779351, 0.88565135192, 0.885641873495, 0.885632344368, 0.885622764829, 0.885613135162, 0.885603455645, 0.885593726555, 0.885583948163, 0.885574120736,
 	0.885564244537, 0.885554319826, 0.885544346856, 0.885534325882, 0.88552425715, 0.885514140905, 0.885503977388, 0.885493766838, 0.885483509488, 0.885473205571, 0.885462855313, 0.885452458942, 0.885442016678, 0.88543152874, 0.885420995347, 0.88541041671, 0.885399793041, 0.885389124547, 0.885378411436, 0.885367653909, 0.885356852167, 0.885346006408, 0.885335116827, 0.885324183619, 0.885313206974, 0.88530218708, 0.885291124125, 0.885280018292, 0.885268869763, 0.88525767872, 0.885246445339, 0.885235169796, 0.885223852267, 0.885212492923, 0.885201091934, 0.885189649468, 0.885178165692, 0.885166640771, 0.885155074868, 0.885143468144, 0.885131820759, 0.88512013287, 0.885108404633, 0.885096636204, 0.885084827735, 0.885072979378, 0.885061091282, 0.885049163597, 0.885037196469, 0.885025190043, 0.885013144464, 0.885001059874, 0.884988936415, 0.884976774227, 0.884964573448, 0.884952334215, 0.884940056665, 0.884927740932, 0.88491538715, 0.88490299545, 0.884890565964, 0.884878098822, 0.884865594153, 0.884853052083, 0.884840472739, 0.884827856247, 0.88481520273, 0.884802512312, 0.884789785113, 0.884777021257, 0.884764220861, 0.884751384045, 0.884738510928, 0.884725601624, 0.884712656251, 0.884699674923, 0.884686657755, 0.884673604858, 0.884660516345, 0.884647392328, 0.884634232915, 0.884621038218, 0.884607808343, 0.8845945434, 0.884581243493, 0.88456790873, 0.884554539215, 0.884541135052, 0.884527696346, 0.884514223197, 0.884500715709, 0.884487173983, 0.884473598117, 0.884459988213, 0.884446344369, 0.884432666682, 0.884418955251, 0.884405210171, 0.884391431539, 0.884377619449,
 	0.884363773997, 0.884349895275, 0.884335983378, 0.884322038397, 0.884308060424, 0.88429404955, 0.884280005866, 0.884265929462, 0.884251820426, 0.884237678848, 0.884223504815, 0.884209298415, 0.884195059735, 0.88418078886, 0.884166485876, 0.884152150868, 0.884137783922, 0.884123385119, 0.884108954545, 0.884094492281, 0.88407999841, 0.884065473013, 0.884050916172, 0.884036327967, 0.884021708478, 0.884007057785, 0.883992375967, 0.883977663103, 0.88396291927, 0.883948144546, 0.883933339008, 0.883918502732, 0.883903635796, 0.883888738273, 0.883873810241, 0.883858851772, 0.883843862943, 0.883828843825, 0.883813794493, 0.883798715019, 0.883783605476, 0.883768465937, 0.883753296472, 0.883738097152, 0.883722868049, 0.883707609232, 0.883692320773, 0.883677002739, 0.8836616552, 0.883646278226, 0.883630871883, 0.883615436241, 0.883599971366, 0.883584477326, 0.883568954187, 0.883553402016, 0.883537820879, 0.883522210841, 0.883506571968, 0.883490904324, 0.883475207974, 0.883459482983, 0.883443729413, 0.883427947329, 0.883412136794, 0.88339629787, 0.883380430619, 0.883364535105, 0.883348611388, 0.88333265953, 0.883316679593, 0.883300671636, 0.883284635721, 0.883268571907, 0.883252480254, 0.883236360823, 0.883220213671, 0.883204038859, 0.883187836443, 0.883171606484, 0.883155349038, 0.883139064164, 0.883122751919, 0.883106412359, 0.883090045542, 0.883073651525, 0.883057230363, 0.883040782112, 0.883024306829, 0.883007804568, 0.882991275384, 0.882974719333, 0.882958136469, 0.882941526847, 0.88292489052, 0.882908227542, 0.882891537967, 0.882874821847, 0.882858079237, 0.882841310189,
 	0.882824514754, 0.882807692987, 0.882790844937, 0.882773970658, 0.882757070201, 0.882740143617, 0.882723190957, 0.882706212271, 0.882689207611, 0.882672177027, 0.882655120569, 0.882638038286, 0.882620930229, 0.882603796446, 0.882586636987, 0.882569451901, 0.882552241236, 0.882535005042, 0.882517743366, 0.882500456256, 0.88248314376, 0.882465805927, 0.882448442803, 0.882431054435, 0.882413640871, 0.882396202157, 0.882378738341, 0.882361249467, 0.882343735584, 0.882326196736, 0.882308632969, 0.882291044329, 0.882273430862, 0.882255792612, 0.882238129625, 0.882220441945, 0.882202729618, 0.882184992687, 0.882167231196, 0.882149445191, 0.882131634714, 0.882113799809, 0.882095940521, 0.882078056892, 0.882060148965, 0.882042216783, 0.88202426039, 0.882006279828, 0.881988275138, 0.881970246365, 0.881952193549, 0.881934116732, 0.881916015957, 0.881897891265, 0.881879742697, 0.881861570295, 0.8818433741, 0.881825154152, 0.881806910492, 0.881788643162, 0.881770352201, 0.88175203765, 0.881733699549, 0.881715337938, 0.881696952856, 0.881678544343, 0.88166011244, 0.881641657185, 0.881623178617, 0.881604676775, 0.881586151699, 0.881567603427, 0.881549031997, 0.881530437449, 0.88151181982, 0.881493179149, 0.881474515474, 0.881455828832, 0.881437119261, 0.881418386799, 0.881399631483, 0.881380853351, 0.88136205244, 0.881343228786, 0.881324382427, 0.8813055134, 0.881286621741, 0.881267707486, 0.881248770672, 0.881229811336, 0.881210829512, 0.881191825238, 0.881172798549, 0.881153749481, 0.881134678069, 0.881115584349, 0.881096468356, 0.881077330125, 0.881058169692, 0.881038987091,
@@ -1006,7 +1002,7 @@ constexpr double stored_complete_gamma_values[] = { 0.886226925453, 0.8862262588
 	0.000151872829584, 0.000151858336519, 0.00015184384483, 0.000151829354519, 0.000151814865583, 0.000151800378024, 0.000151785891841, 0.000151771407035, 0.000151756923604, 0.000151742441549, 0.000151727960869, 0.000151713481565, 0.000151699003637, 0.000151684527084, 0.000151670051906, 0.000151655578103, 0.000151641105674, 0.000151626634621, 0.000151612164942, 0.000151597696638, 0.000151583229708, 0.000151568764152, 0.000151554299971, 0.000151539837163, 0.000151525375729, 0.000151510915669, 0.000151496456983, 0.00015148199967, 0.00015146754373, 0.000151453089164, 0.00015143863597, 0.00015142418415, 0.000151409733702, 0.000151395284627, 0.000151380836925, 0.000151366390595, 0.000151351945637, 0.000151337502051, 0.000151323059838, 0.000151308618996, 0.000151294179526, 0.000151279741428, 0.000151265304701, 0.000151250869346, 0.000151236435362, 0.000151222002749, 0.000151207571507, 0.000151193141636, 0.000151178713136, 0.000151164286006, 0.000151149860246, 0.000151135435858, 0.000151121012839, 0.00015110659119, 0.000151092170911, 0.000151077752003, 0.000151063334463, 0.000151048918294, 0.000151034503494, 0.000151020090063, 0.000151005678001, 0.000150991267309, 0.000150976857985, 0.00015096245003, 0.000150948043444, 0.000150933638226, 0.000150919234377, 0.000150904831896, 0.000150890430783, 0.000150876031038, 0.000150861632661, 0.000150847235652, 0.00015083284001, 0.000150818445736, 0.00015080405283, 0.00015078966129, 0.000150775271118, 0.000150760882313, 0.000150746494874, 0.000150732108802, 0.000150717724097, 0.000150703340758, 0.000150688958786, 0.00015067457818, 0.00015066019894, 0.000150645821066, 0.000150631444557, 0.000150617069415, 0.000150602695638, 0.000150588323226, 0.00015057395218, 0.000150559582499, 0.000150545214183, 0.000150530847231, 0.000150516481645, 0.000150502117423, 0.000150487754566, 0.000150473393073, 0.000150459032945, 0.000150444674181,
 	0.00015043031678};
 
-constexpr double stored_lower_incomplete_gamma_values[] = { 0, 3.99971429683e-11, 2.26241847612e-10, 6.23404690964e-10, 1.2796343426e-09, 2.23526953705e-09, 3.52575389718e-09, 5.18308043909e-09, 7.2366371415e-09, 9.71375361503e-09, 1.26400790743e-08, 1.60398567288e-08, 1.99361305173e-08, 2.43509054997e-08, 2.93052752834e-08, 3.48195252674e-08, 4.09132176858e-08, 4.76052626546e-08, 5.49139782513e-08, 6.28571418641e-08, 7.14520344909e-08, 8.07154792743e-08, 9.06638752726e-08, 1.01313227253e-07, 1.12679172133e-07, 1.2477700258e-07, 1.37621688176e-07, 1.51227894482e-07, 1.65610000293e-07, 1.8078211331e-07, 1.96758084419e-07, 2.13551520757e-07, 2.31175797698e-07, 2.49644069878e-07, 2.68969281368e-07, 2.89164175082e-07, 3.10241301503e-07, 3.32213026784e-07, 3.550915403e-07, 3.78888861683e-07, 4.0361684741e-07, 4.2928719696e-07, 4.55911458602e-07, 4.83501034821e-07, 5.12067187434e-07, 5.41621042401e-07, 5.72173594372e-07, 6.03735710984e-07, 6.36318136917e-07, 6.69931497748e-07, 7.045863036e-07, 7.40292952602e-07, 7.77061734186e-07, 8.1490283222e-07, 8.53826327988e-07, 8.93842203034e-07, 9.3496034188e-07, 9.77190534609e-07, 1.02054247935e-06, 1.06502578463e-06, 1.11064997165e-06, 1.15742447649e-06, 1.20535865212e-06, 1.25446177045e-06, 1.30474302423e-06, 1.3562115289e-06, 1.40887632436e-06, 1.46274637666e-06, 1.51783057964e-06, 1.57413775652e-06, 1.63167666143e-06, 1.69045598083e-06, 1.75048433499e-06, 1.8117702793e-06, 1.8743223056e-06, 1.93814884348e-06, 2.00325826148e-06, 2.06965886828e-06, 2.13735891389e-06, 2.2063665907e-06, 2.27669003462e-06, 2.34833732608e-06, 2.42131649105e-06, 2.49563550207e-06, 2.57130227911e-06, 2.64832469059e-06, 2.72671055419e-06, 2.8064676378e-06, 2.88760366029e-06, 2.97012629238e-06, 3.05404315743e-06, 3.13936183219e-06, 3.22608984757e-06, 3.31423468941e-06, 3.40380379911e-06, 3.49480457441e-06, 3.58724437001e-06, 3.68113049825e-06, 3.77647022975e-06, 3.87327079403e-06,
+const double stored_lower_incomplete_gamma_values[] = { 0, 3.99971429683e-11, 2.26241847612e-10, 6.23404690964e-10, 1.2796343426e-09, 2.23526953705e-09, 3.52575389718e-09, 5.18308043909e-09, 7.2366371415e-09, 9.71375361503e-09, 1.26400790743e-08, 1.60398567288e-08, 1.99361305173e-08, 2.43509054997e-08, 2.93052752834e-08, 3.48195252674e-08, 4.09132176858e-08, 4.76052626546e-08, 5.49139782513e-08, 6.28571418641e-08, 7.14520344909e-08, 8.07154792743e-08, 9.06638752726e-08, 1.01313227253e-07, 1.12679172133e-07, 1.2477700258e-07, 1.37621688176e-07, 1.51227894482e-07, 1.65610000293e-07, 1.8078211331e-07, 1.96758084419e-07, 2.13551520757e-07, 2.31175797698e-07, 2.49644069878e-07, 2.68969281368e-07, 2.89164175082e-07, 3.10241301503e-07, 3.32213026784e-07, 3.550915403e-07, 3.78888861683e-07, 4.0361684741e-07, 4.2928719696e-07, 4.55911458602e-07, 4.83501034821e-07, 5.12067187434e-07, 5.41621042401e-07, 5.72173594372e-07, 6.03735710984e-07, 6.36318136917e-07, 6.69931497748e-07, 7.045863036e-07, 7.40292952602e-07, 7.77061734186e-07, 8.1490283222e-07, 8.53826327988e-07, 8.93842203034e-07, 9.3496034188e-07, 9.77190534609e-07, 1.02054247935e-06, 1.06502578463e-06, 1.11064997165e-06, 1.15742447649e-06, 1.20535865212e-06, 1.25446177045e-06, 1.30474302423e-06, 1.3562115289e-06, 1.40887632436e-06, 1.46274637666e-06, 1.51783057964e-06, 1.57413775652e-06, 1.63167666143e-06, 1.69045598083e-06, 1.75048433499e-06, 1.8117702793e-06, 1.8743223056e-06, 1.93814884348e-06, 2.00325826148e-06, 2.06965886828e-06, 2.13735891389e-06, 2.2063665907e-06, 2.27669003462e-06, 2.34833732608e-06, 2.42131649105e-06, 2.49563550207e-06, 2.57130227911e-06, 2.64832469059e-06, 2.72671055419e-06, 2.8064676378e-06, 2.88760366029e-06, 2.97012629238e-06, 3.05404315743e-06, 3.13936183219e-06, 3.22608984757e-06, 3.31423468941e-06, 3.40380379911e-06, 3.49480457441e-06, 3.58724437001e-06, 3.68113049825e-06, 3.77647022975e-06, 3.87327079403e-06,
 	3.97153938015e-06, 4.07128313724e-06, 4.17250917515e-06, 4.27522456495e-06, 4.37943633955e-06, 4.48515149418e-06, 4.59237698694e-06, 4.70111973932e-06, 4.81138663669e-06, 4.92318452877e-06, 5.03652023017e-06, 5.15140052079e-06, 5.26783214631e-06, 5.38582181863e-06, 5.50537621631e-06, 5.62650198499e-06, 5.74920573782e-06, 5.87349405586e-06, 5.99937348848e-06, 6.12685055376e-06, 6.25593173885e-06, 6.38662350039e-06, 6.51893226482e-06, 6.6528644288e-06, 6.78842635952e-06, 6.92562439506e-06, 7.06446484474e-06, 7.20495398941e-06, 7.34709808186e-06, 7.49090334703e-06, 7.63637598243e-06, 7.78352215835e-06, 7.93234801825e-06, 8.082859679e-06, 8.23506323117e-06, 8.38896473934e-06, 8.54457024238e-06, 8.7018857537e-06, 8.86091726153e-06, 9.0216707292e-06, 9.18415209539e-06, 9.34836727435e-06, 9.51432215622e-06, 9.68202260723e-06, 9.85147446994e-06, 1.00226835635e-05, 1.01956556839e-05, 1.0370396604e-05, 1.05469120743e-05, 1.07252078224e-05, 1.09052895538e-05, 1.10871629519e-05, 1.12708336783e-05, 1.14563073728e-05, 1.16435896538e-05, 1.18326861185e-05, 1.20236023431e-05, 1.22163438827e-05, 1.2410916272e-05, 1.2607325025e-05, 1.28055756357e-05, 1.30056735776e-05, 1.32076243047e-05, 1.34114332508e-05, 1.36171058306e-05, 1.38246474389e-05, 1.40340634516e-05, 1.42453592255e-05, 1.44585400983e-05, 1.46736113891e-05, 1.48905783985e-05, 1.51094464086e-05, 1.5330220683e-05, 1.55529064675e-05, 1.57775089899e-05, 1.60040334599e-05, 1.62324850698e-05, 1.64628689943e-05, 1.66951903907e-05, 1.6929454399e-05, 1.71656661422e-05, 1.74038307262e-05, 1.76439532401e-05, 1.78860387564e-05, 1.81300923308e-05, 1.83761190028e-05, 1.86241237955e-05, 1.88741117157e-05, 1.91260877542e-05, 1.93800568859e-05, 1.96360240699e-05, 1.98939942493e-05, 2.01539723521e-05, 2.04159632903e-05, 2.0679971961e-05, 2.09460032458e-05, 2.12140620112e-05, 2.14841531086e-05, 2.17562813748e-05, 2.20304516313e-05,
 	2.23066686854e-05, 2.25849373294e-05, 2.28652623414e-05, 2.3147648485e-05, 2.34321005093e-05, 2.37186231496e-05, 2.40072211269e-05, 2.42978991481e-05, 2.45906619064e-05, 2.48855140812e-05, 2.51824603379e-05, 2.54815053287e-05, 2.5782653692e-05, 2.60859100529e-05, 2.6391279023e-05, 2.66987652007e-05, 2.70083731715e-05, 2.73201075074e-05, 2.76339727676e-05, 2.79499734985e-05, 2.82681142335e-05, 2.85883994934e-05, 2.89108337862e-05, 2.92354216074e-05, 2.95621674399e-05, 2.98910757544e-05, 3.02221510091e-05, 3.05553976498e-05, 3.08908201104e-05, 3.12284228126e-05, 3.15682101659e-05, 3.1910186568e-05, 3.22543564047e-05, 3.26007240499e-05, 3.29492938658e-05, 3.3300070203e-05, 3.36530574003e-05, 3.40082597851e-05, 3.43656816734e-05, 3.47253273697e-05, 3.50872011672e-05, 3.54513073478e-05, 3.58176501822e-05, 3.61862339301e-05, 3.655706284e-05, 3.69301411495e-05, 3.7305473085e-05, 3.76830628623e-05, 3.80629146864e-05, 3.84450327514e-05, 3.88294212407e-05, 3.92160843272e-05, 3.96050261731e-05, 3.99962509302e-05, 4.03897627398e-05, 4.07855657327e-05, 4.11836640295e-05, 4.15840617404e-05, 4.19867629656e-05, 4.2391771795e-05, 4.27990923082e-05, 4.32087285749e-05, 4.3620684655e-05, 4.40349645981e-05, 4.44515724441e-05, 4.4870512223e-05, 4.5291787955e-05, 4.57154036506e-05, 4.61413633106e-05, 4.65696709261e-05, 4.70003304787e-05, 4.74333459404e-05, 4.78687212738e-05, 4.83064604319e-05, 4.87465673584e-05, 4.91890459878e-05, 4.9633900245e-05, 5.00811340459e-05, 5.05307512971e-05, 5.09827558961e-05, 5.14371517312e-05, 5.18939426817e-05, 5.23531326178e-05, 5.2814725401e-05, 5.32787248835e-05, 5.37451349088e-05, 5.42139593116e-05, 5.46852019177e-05, 5.51588665443e-05, 5.56349569997e-05, 5.61134770836e-05, 5.65944305871e-05, 5.70778212927e-05, 5.75636529744e-05, 5.80519293976e-05, 5.85426543193e-05, 5.90358314881e-05, 5.95314646442e-05, 6.00295575194e-05, 6.05301138372e-05,
 	6.10331373129e-05, 6.15386316536e-05, 6.2046600558e-05, 6.2557047717e-05, 6.3069976813e-05, 6.35853915206e-05, 6.41032955063e-05, 6.46236924285e-05, 6.51465859378e-05, 6.56719796766e-05, 6.61998772798e-05, 6.6730282374e-05, 6.72631985783e-05, 6.7798629504e-05, 6.83365787544e-05, 6.88770499253e-05, 6.94200466048e-05, 6.99655723731e-05, 7.05136308033e-05, 7.10642254603e-05, 7.16173599019e-05, 7.21730376782e-05, 7.27312623318e-05, 7.32920373979e-05, 7.38553664043e-05, 7.44212528714e-05, 7.49897003122e-05, 7.55607122323e-05, 7.61342921302e-05, 7.67104434971e-05, 7.72891698168e-05, 7.7870474566e-05, 7.84543612142e-05, 7.90408332239e-05, 7.96298940503e-05, 8.02215471416e-05, 8.08157959389e-05, 8.14126438764e-05, 8.20120943812e-05, 8.26141508734e-05, 8.32188167662e-05, 8.3826095466e-05, 8.44359903721e-05, 8.50485048772e-05, 8.56636423669e-05, 8.62814062203e-05, 8.69017998094e-05, 8.75248264998e-05, 8.81504896501e-05, 8.87787926124e-05, 8.9409738732e-05, 9.00433313477e-05, 9.06795737915e-05, 9.1318469389e-05, 9.19600214592e-05, 9.26042333144e-05, 9.32511082607e-05, 9.39006495974e-05, 9.45528606176e-05, 9.52077446078e-05, 9.58653048482e-05, 9.65255446125e-05, 9.71884671681e-05, 9.78540757762e-05, 9.85223736914e-05, 9.91933641623e-05, 9.98670504311e-05, 0.000100543435734, 0.0001012225233, 0.000101904316353, 0.000102588818111, 0.000103276031785, 0.00010396596058, 0.000104658607695, 0.000105353976323, 0.000106052069651, 0.000106752890859, 0.000107456443124, 0.000108162729612, 0.000108871753489, 0.000109583517909, 0.000110298026025, 0.000111015280982, 0.000111735285918, 0.000112458043968, 0.000113183558259, 0.000113911831912, 0.000114642868044, 0.000115376669764, 0.000116113240178, 0.000116852582383, 0.000117594699473, 0.000118339594536, 0.000119087270652, 0.000119837730897, 0.000120590978343, 0.000121347016053, 0.000122105847088, 0.000122867474499, 0.000123631901336,
@@ -2008,7 +2004,7 @@ constexpr double stored_lower_incomplete_gamma_values[] = { 0, 3.99971429683e-11
 	1.32766465296, 1.32766479775, 1.32766494252, 1.32766508729, 1.32766523204, 1.32766537677, 1.3276655215, 1.32766566621, 1.32766581091, 1.3276659556, 1.32766610027, 1.32766624494, 1.32766638959, 1.32766653423, 1.32766667885, 1.32766682347, 1.32766696807, 1.32766711266, 1.32766725724, 1.3276674018, 1.32766754636, 1.3276676909, 1.32766783542, 1.32766797994, 1.32766812444, 1.32766826894, 1.32766841341, 1.32766855788, 1.32766870234, 1.32766884678, 1.32766899121, 1.32766913563, 1.32766928003, 1.32766942442, 1.32766956881, 1.32766971317, 1.32766985753, 1.32767000188, 1.32767014621, 1.32767029053, 1.32767043483, 1.32767057913, 1.32767072341, 1.32767086768, 1.32767101194, 1.32767115619, 1.32767130042, 1.32767144464, 1.32767158885, 1.32767173305, 1.32767187723, 1.32767202141, 1.32767216557, 1.32767230971, 1.32767245385, 1.32767259797, 1.32767274208, 1.32767288618, 1.32767303027, 1.32767317434, 1.32767331841, 1.32767346246, 1.32767360649, 1.32767375052, 1.32767389453, 1.32767403853, 1.32767418252, 1.3276743265, 1.32767447046, 1.32767461442, 1.32767475836, 1.32767490228, 1.3276750462, 1.3276751901, 1.32767533399, 1.32767547787, 1.32767562174, 1.32767576559, 1.32767590943, 1.32767605326, 1.32767619708, 1.32767634089, 1.32767648468, 1.32767662846, 1.32767677223, 1.32767691599, 1.32767705973, 1.32767720346, 1.32767734718, 1.32767749089, 1.32767763459, 1.32767777827, 1.32767792194, 1.3276780656, 1.32767820924, 1.32767835288, 1.3276784965, 1.32767864011, 1.32767878371, 1.32767892729,
 	1.32767907087};
 
-constexpr double stored_gamma_values[] = { 0.8862269254527579,
+const double stored_gamma_values[] = { 0.8862269254527579,
 	0.8862058562462847, 0.8861673684764494, 0.8861175779102776, 0.8860586748381102, 0.885991929038088, 0.8859181998177946, 0.8858381198684894, 0.8857521808226176, 0.8856607793509651, 0.8855642445373384, 0.8854628553133188, 0.8853568521666911, 0.8852464453386151, 0.885131820758816, 0.8850131444639466, 0.8848905659643725, 0.8847642208611585, 0.8846342329154224, 0.8845007157093098, 0.8843637739968205, 0.8842235048153034, 0.8840799984095828, 0.8839333390075309, 0.8837836054764922, 0.883630871883141, 0.8834752079743317, 0.8833166795927513, 0.8831553490383316, 0.882991275384215, 0.8828245147543808, 0.8826551205687244, 0.8824831437603474, 0.8823086329689905, 0.8821316347138821, 0.8819521935487461, 0.8817703522012668, 0.8815861516989723, 0.8813996314831892, 0.8812108295124903, 0.8810197823568517, 0.8808265252835672, 0.8806310923358297, 0.8804335164047664, 0.880233829295614, 0.8800320617886374, 0.8798282436953141, 0.8796224039102558, 0.8794145704592659, 0.8792047705439062, 0.8789930305828851, 0.8787793762505606, 0.8785638325128077, 0.87834642366048, 0.8781271733406734, 0.8779061045859683, 0.8776832398418216, 0.8774586009922531, 0.8772322093839676, 0.8770040858490206, 0.8767742507261552, 0.8765427238808987, 0.8763095247245107, 0.8760746722318745, 0.8758381849583944, 0.8756000810559794, 0.875360378288175, 0.8751190940444911, 0.8748762453539946, 0.8746318488982038, 0.8743859210233363, 0.8741384777519489, 0.8738895347940084, 0.8736391075574311, 0.8733872111581185, 0.8731338604295258, 0.872879069931787, 0.8726228539604243, 0.8723652265546671, 0.8721062015053976, 0.8718457923627527, 0.8715840124433956, 0.8713208748374752, 0.8710563924152942, 0.8707905778336981, 0.870523443542201, 0.8702550017888642, 0.8699852646259347, 0.8697142439152655, 0.8694419513335169, 0.8691683983771609, 0.8688935963672911, 0.8686175564542506, 0.8683402896220885, 0.8680618066928455, 0.8677821183306889, 0.8675012350458944, 0.867219167198684, 0.8669359250029286, 0.866651518529722, 0.8663659577108269,
 	0.8660792523420069, 0.8657914120862396, 0.8655024464768254, 0.8652123649203929, 0.8649211766997996, 0.8646288909769437, 0.8643355167954812, 0.8640410630834559, 0.863745538655848, 0.8634489522170393, 0.8631513123632041, 0.8628526275846238, 0.8625529062679318, 0.8622521566982907, 0.8619503870615036, 0.8616476054460601, 0.8613438198451269, 0.8610390381584744, 0.8607332681943503, 0.8604265176713021, 0.8601187942199386, 0.8598101053846524, 0.8595004586252865, 0.8591898613187567, 0.858878320760631, 0.8585658441666625, 0.8582524386742832, 0.8579381113440586, 0.8576228691610964, 0.8573067190364291, 0.8569896678083495, 0.8566717222437197, 0.8563528890392397, 0.8560331748226883, 0.8557125861541285, 0.8553911295270866, 0.8550688113696983, 0.8547456380458268, 0.8544216158561544, 0.8540967510392472, 0.8537710497725928, 0.8534445181736141, 0.8531171623006579, 0.8527889881539602, 0.852460001676589, 0.8521302087553653, 0.8517996152217601, 0.8514682268527753, 0.8511360493717997, 0.850803088449448, 0.8504693497043796, 0.8501348387041011, 0.8497995609657477, 0.84946352195685, 0.8491267270960813, 0.8487891817539917, 0.8484508912537234, 0.8481118608717116, 0.8477720958383713, 0.8474316013387674, 0.8470903825132718, 0.8467484444582081, 0.8464057922264794, 0.8460624308281863, 0.8457183652312291, 0.8453736003619017, 0.8450281411054688, 0.844681992306735, 0.8443351587706002, 0.8439876452626048, 0.8436394565094653, 0.8432905971995951, 0.8429410719836216, 0.8425908854748857, 0.8422400422499394, 0.841888546849026, 0.841536403776558, 0.8411836175015805, 0.8408301924582299, 0.8404761330461807, 0.8401214436310865, 0.8397661285450111, 0.8394101920868517, 0.8390536385227571, 0.8386964720865322, 0.8383386969800418, 0.8379803173736036, 0.837621337406374, 0.8372617611867263, 0.836901592792629, 0.8365408362720043, 0.8361794956430938, 0.8358175748948092, 0.8354550779870809, 0.8350920088511976, 0.8347283713901437, 0.8343641694789264, 0.833999406964904, 0.8336340876681002, 0.8332682153815174,
 	0.8329017938714481, 0.8325348268777752, 0.8321673181142694, 0.8317992712688831, 0.8314306900040385, 0.831061577956909, 0.8306919387397017, 0.8303217759399268, 0.8299510931206718, 0.8295798938208636, 0.8292081815555319, 0.8288359598160646, 0.8284632320704628, 0.8280900017635884, 0.8277162723174091, 0.8273420471312413, 0.826967329581985, 0.8265921230243615, 0.8262164307911399, 0.8258402561933678, 0.8254636025205906, 0.8250864730410755, 0.8247088710020255, 0.8243307996297938, 0.8239522621300946, 0.8235732616882101, 0.8231938014691937, 0.8228138846180725, 0.8224335142600445, 0.8220526935006751, 0.8216714254260884, 0.8212897131031571, 0.8209075595796909, 0.8205249678846193, 0.8201419410281738, 0.819758482002067, 0.81937459377967, 0.8189902793161857, 0.8186055415488199, 0.8182203833969532, 0.8178348077623052, 0.8174488175291007, 0.817062415564232, 0.8166756047174186, 0.816288387821366, 0.815900767691921, 0.8155127471282259, 0.8151243289128707, 0.8147355158120411, 0.8143463105756679, 0.8139567159375729, 0.8135667346156115, 0.8131763693118154, 0.8127856227125331, 0.8123944974885672, 0.8120029962953124, 0.8116111217728876, 0.8112188765462728, 0.8108262632254363, 0.810433284405467, 0.8100399426667025, 0.8096462405748531, 0.8092521806811298, 0.8088577655223642, 0.8084629976211325, 0.8080678794858752, 0.8076724136110153, 0.8072766024770758, 0.8068804485507947, 0.8064839542852421, 0.8060871221199285, 0.8056899544809213, 0.8052924537809512, 0.8048946224195237, 0.8044964627830243, 0.8040979772448283, 0.8036991681654019, 0.8033000378924089, 0.8029005887608116, 0.8025008230929732, 0.8021007431987578, 0.8017003513756285, 0.8012996499087465, 0.8008986410710673, 0.8004973271234361, 0.8000957103146831, 0.7996937928817149, 0.7992915770496106, 0.7988890650317083, 0.7984862590297001, 0.7980831612337177, 0.7976797738224231, 0.7972760989630943, 0.7968721388117129, 0.7964678955130471, 0.7960633712007398, 0.7956585679973884, 0.7952534880146301, 0.7948481333532217, 0.7944425061031208,
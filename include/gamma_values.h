@@ -0,0 +1,13 @@
+#pragma once
+
+// The stored values of the complete and the lower incomplete gamma functions used by the weights
+// and the losses of MAGSAC(++). The tables are defined once in gamma_values.cpp which is compiled
+// into the MAGSAC library.
+constexpr unsigned int stored_gamma_number = 36000;
+constexpr unsigned int stored_incomplete_gamma_number = 100000;
+constexpr double precision_of_stored_gammas = 989;
+constexpr double precision_of_stored_incomplete_gammas = 1e4;
+
+extern const double stored_complete_gamma_values[];
+extern const double stored_lower_incomplete_gamma_values[];
+extern const double stored_gamma_values[];
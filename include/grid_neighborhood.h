@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace magsac
+{
+	namespace utils
+	{
+		// A neighborhood index over point correspondences. The bounding box of the coordinates in
+		// both images (x1, y1, x2, y2) is divided into a uniform four-dimensional grid and two
+		// correspondences are neighbors if they fall into the same cell. The points are stored
+		// cell-by-cell, thus, the neighbors of a point are obtained without any search.
+		class GridNeighborhood
+		{
+		public:
+			GridNeighborhood() : cell_number_per_dimension(0)
+			{
+			}
+
+			// Building the index. The number of cells along each dimension is limited to 32.
+			void build(
+				const cv::Mat &points_, // The point correspondences, each is of format x1 y1 x2 y2
+				const size_t cell_number_per_dimension_) // The number of cells along each dimension
+			{
+				constexpr size_t dimension_number = 4;
+				cell_number_per_dimension = std::min<size_t>(32, std::max<size_t>(1, cell_number_per_dimension_));
+				const size_t point_number = points_.rows;
+
+				// Calculate the bounding box of the coordinates
+				double minimum[dimension_number], scale[dimension_number];
+				for (size_t dimension = 0; dimension < dimension_number; ++dimension)
+				{
+					double lower = std::numeric_limits<double>::max(),
+						upper = std::numeric_limits<double>::lowest();
+					for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
+					{
+						const double value = points_.at<double>(point_idx, dimension);
+						lower = std::min(lower, value);
+						upper = std::max(upper, value);
+					}
+					minimum[dimension] = lower;
+					scale[dimension] = upper > lower ? cell_number_per_dimension / (upper - lower) : 0.0;
+				}
+
+				// Calculate the cell of each point
+				point_cells.resize(point_number);
+				for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
+				{
+					size_t cell_idx = 0;
+					for (size_t dimension = 0; dimension < dimension_number; ++dimension)
+					{
+						const size_t coordinate = std::min(cell_number_per_dimension - 1,
+							static_cast<size_t>((points_.at<double>(point_idx, dimension) - minimum[dimension]) * scale[dimension]));
+						cell_idx = cell_idx * cell_number_per_dimension + coordinate;
+					}
+					point_cells[point_idx] = cell_idx;
+				}
+
+				// Store the points cell-by-cell by counting sort
+				const size_t cell_number = cell_number_per_dimension * cell_number_per_dimension *
+					cell_number_per_dimension * cell_number_per_dimension;
+				cell_offsets.assign(cell_number + 1, 0);
+				for (const size_t cell_idx : point_cells)
+					++cell_offsets[cell_idx + 1];
+				for (size_t cell_idx = 0; cell_idx < cell_number; ++cell_idx)
+					cell_offsets[cell_idx + 1] += cell_offsets[cell_idx];
+
+				cell_points.resize(point_number);
+				point_positions.resize(point_number);
+				std::vector<size_t> next_positions(cell_offsets.begin(), cell_offsets.end() - 1);
+				for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
+				{
+					const size_t position = next_positions[point_cells[point_idx]]++;
+					cell_points[position] = point_idx;
+					point_positions[point_idx] = position;
+				}
+			}
+
+			size_t getPointNumber() const
+			{
+				return point_cells.size();
+			}
+
+			// The first neighbor of a point in the cell-by-cell storage. The point itself is one of its neighbors.
+			inline const size_t *getNeighborsBegin(const size_t point_idx_) const
+			{
+				return cell_points.data() + cell_offsets[point_cells[point_idx_]];
+			}
+
+			// The end of the neighbors of a point in the cell-by-cell storage
+			inline const size_t *getNeighborsEnd(const size_t point_idx_) const
+			{
+				return cell_points.data() + cell_offsets[point_cells[point_idx_] + 1];
+			}
+
+			// The position of a point among its neighbors
+			inline size_t getPositionInCell(const size_t point_idx_) const
+			{
+				return point_positions[point_idx_] - cell_offsets[point_cells[point_idx_]];
+			}
+
+		protected:
+			size_t cell_number_per_dimension; // The number of cells along each dimension
+			std::vector<size_t> point_cells; // The cell of each point
+			std::vector<size_t> cell_offsets; // The position of the first point of each cell in the storage
+			std::vector<size_t> cell_points; // The indices of the points stored cell-by-cell
+			std::vector<size_t> point_positions; // The position of each point in the storage
+		};
+	}
+}
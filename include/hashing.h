@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace magsac
+{
+	namespace utils
+	{
+		// Mixing the bits of a 64-bit number by the finalizer of SplitMix64. Each input bit affects
+		// every output bit, thus, combining the mixed values gives well-distributed fingerprints.
+		// It is used for calculating the fingerprints of samples, inlier sets and quantized points.
+		inline uint64_t mixBits(uint64_t x_)
+		{
+			x_ = (x_ ^ (x_ >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			x_ = (x_ ^ (x_ >> 27)) * 0x94d049bb133111ebULL;
+			return x_ ^ (x_ >> 31);
+		}
+
+		// Calculating the fingerprint of a set of indices. The mixed indices are summed, thus, the
+		// fingerprint does not depend on the order of the indices and they do not have to be sorted.
+		// Zero is never returned so that it can mark the empty slots of hash tables.
+		inline uint64_t fingerprintIndexSet(
+			const size_t * const indices_,
+			const size_t index_number_)
+		{
+			uint64_t sum = 0;
+			for (size_t i = 0; i < index_number_; ++i)
+				sum += mixBits(indices_[i] + 0x9e3779b97f4a7c15ULL);
+			const uint64_t fingerprint = mixBits(sum ^ index_number_);
+			return fingerprint == 0 ? 1 : fingerprint;
+		}
+	}
+}
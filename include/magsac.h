@@ -3,12 +3,34 @@
 #include <limits>
 #include <chrono>
 #include <memory>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <unordered_map>
+#include <future>
 #include "model.h"
 #include "model_score.h"
 #include "sampler.h"
 #include "uniform_sampler.h"
+#include "sampler_feedback.h"
+#include "weight_kernels.h"
+#include "hashing.h"
+#include "sample_hash_set.h"
+#include "alias_table.h"
+#include "batch_solvers.h"
+#include "estimator_concept.h"
+#include "point_view.h"
+#include "metrics.h"
+#include "run_tracer.h"
+#include "run_observer.h"
+#include "cancellation_token.h"
+#include "fast_random_generator.h"
 #include <math.h> 
-#include "gamma_values.cpp"
+#include "gamma_values.h"
+
+#ifdef USE_OPENMP
+	#include <omp.h>
+#endif
 
 #ifdef _WIN32 
 	#include <ppl.h>
@@ -22,7 +44,195 @@ public:
 		// The original version of MAGSAC. It works well, however, can be quite slow in many cases.
 		MAGSAC_ORIGINAL, 
 		// The recently proposed MAGSAC++ algorithm which keeps the accuracy of the original MAGSAC but is often orders of magnitude faster.
-		MAGSAC_PLUS_PLUS }; 
+		MAGSAC_PLUS_PLUS,
+		// MAGSAC++ with preemptive, breadth-first hypothesis evaluation. A fixed number of models is generated
+		// and they are scored together on growing blocks of points by the MAGSAC++ loss. The worst ones are 
+		// dropped after each block and only the survivors are refined by sigma-consensus++. 
+		// Its run-time is fixed by the parameters (see setPreemptiveParameters).
+		MAGSAC_PLUS_PLUS_PREEMPTIVE }; 
+
+	// The statistics of a single run of MAGSAC
+	struct RunStatistics
+	{
+		RunStatistics() :
+			sample_number(0),
+			duplicate_sample_number(0),
+			refined_model_number(0),
+			refined_model_cache_hits(0),
+			subset_scored_model_number(0),
+			promoted_model_number(0),
+			invalid_model_number(0),
+			pruned_model_number(0),
+			is_time_limit_reached(false),
+			is_cancelled(false)
+		{
+		}
+
+		size_t sample_number; // The number of minimal samples selected
+		size_t duplicate_sample_number; // The number of selected minimal samples which had already been evaluated
+		size_t refined_model_number; // The number of models refined by sigma-consensus
+		size_t refined_model_cache_hits; // The number of refined models whose score was taken from the cache
+		size_t subset_scored_model_number; // The number of models scored on the subset of the points first
+		size_t promoted_model_number; // The number of models scored on all points after scoring them on the subset
+		size_t invalid_model_number; // The number of refined models rejected by the validity check, either when refined or when the check is deferred
+		size_t pruned_model_number; // The number of models dropped after evaluating them on a block of points in the preemptive mode
+		bool is_time_limit_reached; // A flag saying if the run has been interrupted by the time limit
+		bool is_cancelled; // A flag saying if the run has been interrupted by its cancellation token
+
+		// The ratio of the minimal samples skipped since they had already been evaluated
+		double getDuplicateSampleRate() const
+		{
+			return sample_number == 0 ? 0.0 :
+				static_cast<double>(duplicate_sample_number) / sample_number;
+		}
+
+		// The ratio of the models scored on all points after scoring them on the subset of the points
+		double getPromotionRate() const
+		{
+			return subset_scored_model_number == 0 ? 0.0 :
+				static_cast<double>(promoted_model_number) / subset_scored_model_number;
+		}
+	};
+
+	// The per-point data of the estimated model which a run of MAGSAC can return. It is the data of the
+	// last weighted least-squares fitting of sigma-consensus(++) from which the model was obtained, thus,
+	// no additional pass through the points is required. The residuals are the ones used in the fitting
+	// (i.e., ModelEstimator::residual) w.r.t. the model from which the last fitting started. The weights
+	// are the ones the points got in the fitting, i.e., the MAGSAC++ weights in sigma-consensus++ and
+	// the marginalized likelihoods in the original sigma-consensus. If the validity check of the 
+	// estimator has replaced the fitted model (e.g., the plane-and-parallax check of fundamental matrices),
+	// the data belongs to the fitting and not to the replacement. It is empty if no model has been found
+	// or, in the coarse-to-fine mode, if the run has been cancelled before refining the model on all points.
+	// If the duplicate points are merged (see setPointCompression), each input point gets the residual and 
+	// the weight of its representative. With a positive tolerance, the representative is the average of
+	// the merged points, thus, these are not the residuals of the points themselves.
+	struct RunOutput
+	{
+		std::vector<size_t> point_indices; // The indices of the points with non-zero weight in increasing order
+		std::vector<double> residuals; // The residuals of these points
+		std::vector<double> weights; // The weights of these points in the fitting
+		std::vector<uint64_t> inlier_mask; // A bitset where the bit of a point is set if its residual is smaller than the reference threshold
+
+		// Returns true if the point is closer to the model than the reference threshold
+		bool isInlier(const size_t point_idx_) const
+		{
+			return (inlier_mask[point_idx_ >> 6] >> (point_idx_ & 63)) & 1;
+		}
+	};
+
+	// The state of a single run of MAGSAC. Everything which is modified while running the 
+	// algorithm is stored here so that a configured MAGSAC object can be used by multiple 
+	// threads at once. The buffers are kept between the runs to avoid reallocating them, thus,
+	// it is beneficial to keep one context per thread.
+	struct RunContext
+	{
+		// The score of a refined model stored to recognize the same model when it is obtained again
+		struct RefinedModelEntry
+		{
+			uint64_t key; // The fingerprint of the possible inliers the model has been fitted to
+			double score; // The score of the model
+			int iteration_number; // The iteration number implied by the model
+			bool is_valid; // The result of the validity check
+		};
+
+		// The verdict of a validity check applied to a model
+		struct ValidityVerdict
+		{
+			uint64_t key; // The fingerprint of the possible inliers the checked model has been fitted to
+			gcransac::Model updated_model; // The model parameters after the check if the check updated them (e.g., by DEGENSAC)
+			bool is_valid; // The result of the check
+			bool is_updated; // A flag saying if the check updated the model parameters
+		};
+
+		RunContext() :
+			point_number(0),
+			last_iteration_number(0),
+			log_confidence(0),
+			validity_cache_position(0),
+			refined_model_cache_position(0),
+			collect_fit_data(false),
+			multiplicities(nullptr),
+			represented_point_number(0.0),
+			cancellation_token(nullptr),
+			observer(nullptr),
+			snapshot(nullptr)
+		{
+		}
+
+		int point_number; // The current point number
+		int last_iteration_number; // The iteration number implied by the last run of sigma-consensus
+		double log_confidence; // The logarithm of the required confidence
+		magsac::utils::AlignedVector<double> partition_weights; // The flat buffer of the weights accumulated by each thread in sigma-consensus, one cache-aligned row per thread
+		magsac::utils::AlignedVector<double> partition_squared_residuals; // The flat buffer of the squared residuals calculated by each thread in sigma-consensus
+		std::vector<size_t> sorted_point_indices; // The indices of the possible inliers ordered by their residuals
+		std::vector<size_t> candidate_inliers; // The possible inliers of the last refined model whose validity check has been deferred
+		std::vector<ValidityVerdict> validity_cache; // The verdicts of the recently checked models
+		size_t validity_cache_position; // The position where the next verdict is stored in the cache
+		std::vector<RefinedModelEntry> refined_model_cache; // The recently scored refined models
+		std::vector<gcransac::Model> preemptive_hypotheses; // The models evaluated together in the preemptive mode
+		std::vector<double> preemptive_losses; // The accumulated losses of the models in the preemptive mode
+		std::vector<size_t> preemptive_survivors; // The indices of the models not dropped yet in the preemptive mode
+		std::vector<size_t> preemptive_point_order; // The order in which the points are evaluated in the preemptive mode
+		std::vector<size_t> scoring_subset; // The random subset of the points on which the models are scored first
+		cv::Mat coarse_points; // The stratified subsample of the points used in the coarse phase
+		std::vector<size_t> coarse_pool; // The sampling pool of the coarse phase, i.e., all points of the subsample
+		std::vector<size_t> coarse_point_order; // The pool ordered by grid cells in the coarse phase
+		std::vector<size_t> coarse_cell_offsets; // The first position of each grid cell in the ordered pool
+		std::vector<size_t> coarse_active_cells; // The grid cells which still have unselected points
+		size_t refined_model_cache_position; // The position where the next refined model is stored in the cache
+		std::vector<size_t> full_pool; // The indices of all points used as sampling pool when no pool is given
+		std::vector<gcransac::Model> minimal_models; // The models estimated from the current minimal sample
+		std::vector<size_t> sample_batch; // The minimal samples of the current block stored one after the other
+		std::vector<size_t> minimal_model_samples; // The index of the sample in the block of each estimated model
+		std::vector<size_t> sample_batch_attempts; // The number of sampling attempts in the current block until each of its samples was selected
+		std::vector<std::pair<double, size_t>> consensus_residuals; // The (residual, point index) pairs collected in sigma-consensus(++)
+		std::vector<gcransac::Model> consensus_models; // The models fit by weighted least-squares fitting in sigma-consensus(++). Only its capacity is reused since the solvers append new models.
+		gcransac::Model polished_model; // The model updated by the iteratively re-weighted least-squares fitting in sigma-consensus++
+		gcransac::Model refined_model; // The refined model of the current candidate before it replaces the so-far-the-best one
+		std::vector<size_t> consensus_inliers; // The points used in the weighted least-squares fitting in sigma-consensus(++)
+		std::vector<double> consensus_weights; // The weights used in the weighted least-squares fitting in sigma-consensus(++)
+		bool collect_fit_data; // Decides if the data of the last weighted least-squares fitting of sigma-consensus(++) is kept
+		RunOutput fit_data; // The points, residuals and weights of the last fitting of the last refined model. The weights are divided by the multiplicities.
+		RunOutput best_fit_data; // The points, residuals and weights of the last fitting of the so-far-the-best model
+		std::vector<size_t> fit_data_positions; // The position of each point in the data of the so-far-the-best model when the output is filled
+		magsac::utils::SampleHashSet evaluated_samples; // The minimal samples evaluated in the current run
+		cv::Mat point_header; // The header of the input points not owning them
+		cv::Mat compressed_points; // The representatives of the merged duplicate points
+		std::vector<double> point_multiplicities; // The number of input points each representative stands for
+		std::vector<size_t> representative_indices; // The index of the representative of each input point
+		std::vector<size_t> compressed_pool; // The representatives of the points in the given pool
+		std::unordered_map<uint64_t, size_t> representative_lookup; // The representative of each fingerprint of the quantized points
+		std::vector<uint64_t> representative_cells; // The quantized coordinates of each representative compared when the fingerprints match
+		std::vector<double> coordinate_sums; // The sums of the coordinates of the merged points
+		std::vector<bool> best_model_inliers; // The inlier flags of the points w.r.t. the so-far-the-best model given to the sampler
+		std::vector<double> sampling_weights; // The MAGSAC++ weights of the pool w.r.t. the so-far-the-best model
+		magsac::utils::AliasTable sampling_alias_table; // The table drawing the pool positions proportionally to their weights
+		magsac::utils::FastRandomGenerator sampling_generator; // The generator of the weight-guided sampling
+		const double *multiplicities; // The multiplicities of the points currently used or nullptr if each point stands for itself
+		double represented_point_number; // The number of input points the points scored on the subset stand for
+		RunStatistics statistics; // The statistics of the last run
+		std::chrono::steady_clock::time_point run_start; // The start of the run measured only if the metrics or the observers need it
+		const magsac::utils::CancellationToken *cancellation_token; // The token checked to interrupt the runs using the context, if given
+		magsac::utils::RunObserver *observer; // The observer of the updates of the so-far-the-best model of the runs using the context, if given
+		magsac::utils::BestModelSnapshot *snapshot; // The snapshot of the so-far-the-best model of the runs using the context, if given
+	};
+
+	// The outcome of a run started by runAsync
+	enum class RunStatus
+	{
+		Success, // A model has been found
+		Failed, // No model has been found
+		Cancelled // The run has been cancelled. The model is the best one found before, if there is any.
+	};
+
+	// The result of a run started by runAsync
+	struct AsyncRunResult
+	{
+		RunStatus status; // The outcome of the run
+		gcransac::Model model; // The estimated model
+		ModelScore score; // The score of the model
+		int iteration_number; // The number of iterations done
+	};
 
 	MAGSAC(const Version magsac_version_ = Version::MAGSAC_PLUS_PLUS) :
 		time_limit(std::numeric_limits<double>::max()), // 
@@ -35,16 +245,50 @@ public:
 		core_number(1),
 		number_of_irwls_iters(1),
 		interrupting_threshold(1.0),
-		last_iteration_number(0),
-		log_confidence(0),
-		point_number(0),
+		lazy_validity_check(false),
+		duplicate_sample_capacity(0),
+		refined_model_cache_size(0),
+		preemptive_hypothesis_number(500),
+		preemptive_block_size(100),
+		preemptive_keep_ratio(0.5),
+		preemptive_refined_hypothesis_number(3),
+		subset_scoring_size(0),
+		subset_scoring_confidence(0.99),
+		coarse_point_number(0),
+		fine_refinement_iteration_number(5),
+		compress_points(false),
+		compression_tolerance(0.0),
+		weight_guided_sampling(false),
+		weight_guided_uniform_share(0.5),
+		weight_guided_sampling_seed(0),
+		sample_batch_size(1),
+		metrics(nullptr),
+		tracer(nullptr),
 		magsac_version(magsac_version_)
 	{ 
 	}
 
 	~MAGSAC() {}
 
-	// A function to run MAGSAC.
+	// A function to run MAGSAC. The run() functions only read the configuration of the object, 
+	// thus, they can be called from multiple threads at once as long as the configuration is not
+	// changed meanwhile and each thread uses its own estimator and sampler. The versions without 
+	// a run context use a context owned by the calling thread, which is shared by the MAGSAC objects
+	// of the same type and only reused for its buffers. If such a run is started while another one is
+	// using the context of the thread, e.g., from an observer, it uses a new context. The statistics of
+	// these runs are not returned and they are not observed; the versions taking a context provide them.
+	bool run(
+		const cv::Mat &points_, // The input data points
+		const double confidence_, // The required confidence in the results
+		ModelEstimator& estimator_, // The model estimator
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_, // The sampler used
+		gcransac::Model &obtained_model_, // The estimated model parameters
+		int &iteration_number_, // The number of iterations done
+		ModelScore &model_score_, // The score of the estimated model
+		RunOutput *output_ = nullptr) const; // The per-point data of the estimated model if needed
+
+	// A function to run MAGSAC selecting the minimal samples only from a subset of the points.
+	// The models are still verified and scored on all points.
 	bool run(
 		const cv::Mat &points_, // The input data points
 		const double confidence_, // The required confidence in the results
@@ -52,8 +296,52 @@ public:
 		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_, // The sampler used
 		gcransac::Model &obtained_model_, // The estimated model parameters
 		int &iteration_number_, // The number of iterations done
-		ModelScore &model_score_); // The score of the estimated model
+		ModelScore &model_score_, // The score of the estimated model
+		const std::vector<size_t> &pool_, // The indices of the points from which the minimal samples are selected
+		RunOutput *output_ = nullptr) const; // The per-point data of the estimated model if needed
+
+	// A function to run MAGSAC using the provided run context. 
+	// A context must not be used by multiple threads at once.
+	bool run(
+		const cv::Mat &points_, // The input data points
+		const double confidence_, // The required confidence in the results
+		ModelEstimator& estimator_, // The model estimator
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_, // The sampler used
+		gcransac::Model &obtained_model_, // The estimated model parameters
+		int &iteration_number_, // The number of iterations done
+		ModelScore &model_score_, // The score of the estimated model
+		RunContext &context_, // The state of the run
+		RunOutput *output_ = nullptr) const; // The per-point data of the estimated model if needed
+
+	// A function to run MAGSAC using the provided run context and selecting 
+	// the minimal samples only from a subset of the points.
+	bool run(
+		const cv::Mat &points_, // The input data points
+		const double confidence_, // The required confidence in the results
+		ModelEstimator& estimator_, // The model estimator
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_, // The sampler used
+		gcransac::Model &obtained_model_, // The estimated model parameters
+		int &iteration_number_, // The number of iterations done
+		ModelScore &model_score_, // The score of the estimated model
+		const std::vector<size_t> &pool_, // The indices of the points from which the minimal samples are selected
+		RunContext &context_, // The state of the run
+		RunOutput *output_ = nullptr) const; // The per-point data of the estimated model if needed
 		
+	// A function to start MAGSAC in the background. The run can be interrupted by cancelling the
+	// token, in which case it returns the best model found so far. The token is also given to the
+	// estimator if it runs a nested estimation (see magsac::estimator::HasCancellation). This MAGSAC
+	// object, the data points, the estimator, the sampler, the pool, the context and the token have to
+	// be kept alive until the future is ready, and the object must not be modified and the others must
+	// not be used by other runs until then.
+	std::future<AsyncRunResult> runAsync(
+		const cv::Mat &points_, // The input data points
+		const double confidence_, // The required confidence in the results
+		ModelEstimator& estimator_, // The model estimator
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_, // The sampler used
+		RunContext &context_, // The state of the run
+		const magsac::utils::CancellationToken &cancellation_token_, // The token through which the run can be cancelled
+		const std::vector<size_t> *pool_ = nullptr) const; // If given, the indices of the points from which the minimal samples are selected
+
 	// A function to set the maximum inlier-outlier threshold 
 	void setMaximumThreshold(const double maximum_threshold_) 
 	{
@@ -67,7 +355,7 @@ public:
 		interrupting_threshold = threshold_;
 	}
 
-	double getReferenceThreshold()
+	double getReferenceThreshold() const
 	{
 		return interrupting_threshold;
 	}
@@ -91,25 +379,176 @@ public:
 	}
 
 	// A function to set the number of cores used in the original MAGSAC algorithm.
-	// In MAGSAC++, it is not used. Note that when multiple MAGSACs run in parallel,
+	// In MAGSAC++ and its preemptive mode, it is not used. Note that when multiple MAGSACs run in parallel,
 	// it is beneficial to keep the core number one for each independent MAGSAC.
 	// Otherwise, the threads will act weirdly.
 	void setCoreNumber(size_t core_number_)
 	{
-		if (magsac_version == MAGSAC_PLUS_PLUS)
-			fprintf(stderr, "Setting the core number for MAGSAC++ is deprecated.");
+		if (magsac_version != MAGSAC_ORIGINAL)
+			fprintf(stderr, "Setting the core number for MAGSAC++ is deprecated.\n");
 		core_number = core_number_;
 	}
 
 	// Setting the number of partitions used in the original MAGSAC algorithm
-	// to speed up the procedure. In MAGSAC++, this parameter is not used.
+	// to speed up the procedure. In MAGSAC++ and its preemptive mode, this parameter is not used.
 	void setPartitionNumber(size_t partition_number_)
 	{
-		if (magsac_version == MAGSAC_PLUS_PLUS)
-			fprintf(stderr, "Setting the partition number for MAGSAC++ is deprecated.");
+		if (magsac_version != MAGSAC_ORIGINAL)
+			fprintf(stderr, "Setting the partition number for MAGSAC++ is deprecated.\n");
 		partition_number = partition_number_;
 	}
 
+	// Setting the flag determining if the validity check (e.g., DEGENSAC for fundamental matrices)
+	// is applied to every refined model or only to those which would replace the so-far-the-best
+	// model. In the latter case, the models are scored first and the verdict of the check is cached.
+	void setLazyValidityCheck(bool value_)
+	{
+		lazy_validity_check = value_;
+	}
+
+	// Setting the maximum number of evaluated minimal samples remembered to skip the samples which
+	// are selected again. It helps mostly when there are few points and the sample size is large,
+	// e.g., for fundamental matrix fitting. Zero switches off the detection of duplicate samples.
+	// A skipped sample is redrawn and does not consume an iteration unless all of the redrawn samples
+	// are duplicates, too. The rate of the skipped samples is reported in the statistics of the run context.
+	void setDuplicateSampleDetection(size_t capacity_)
+	{
+		duplicate_sample_capacity = capacity_;
+	}
+
+	// Setting the number of the recently refined models remembered together with their scores.
+	// Different minimal samples often lead to the same model after sigma-consensus. Such a model
+	// is recognized by the fingerprint of the possible inliers it has been fitted to, and the stored 
+	// score and validity is used instead of checking and scoring it again. The parameters themselves
+	// are not compared since their scales differ too much, e.g., in the blocks of a fundamental matrix. 
+	// A model fitted to the inliers of a cached one which has not improved the so-far-the-best model
+	// is not scored, thus, the result can differ slightly from the one without the cache. 
+	// Zero switches off the cache.
+	void setRefinedModelCache(size_t size_)
+	{
+		refined_model_cache_size = size_;
+	}
+
+	// Setting the parameters of the preemptive mode (MAGSAC_PLUS_PLUS_PREEMPTIVE). The given number of
+	// models is generated, then they are evaluated together on blocks of points. After each block, only 
+	// the given ratio of the models with the lowest loss is kept until the number of the remaining models 
+	// falls to the number of models refined by sigma-consensus++. The run-time is determined by these 
+	// parameters and it does not depend on the outlier ratio. The time limit is checked after each
+	// generated model, block and refinement. Once it is exceeded, only the model with the lowest loss
+	// so far is refined.
+	void setPreemptiveParameters(
+		size_t hypothesis_number_, // The number of models generated
+		size_t block_size_ = 100, // The number of points evaluated before dropping models
+		double keep_ratio_ = 0.5, // The ratio of the models kept after each block
+		size_t refined_hypothesis_number_ = 3) // The number of the best models refined by sigma-consensus++
+	{
+		if (keep_ratio_ <= 0.0 || keep_ratio_ > 1.0)
+		{
+			fprintf(stderr, "The ratio of the kept models must be in (0, 1]; %f is given.\n", keep_ratio_);
+			return;
+		}
+		preemptive_hypothesis_number = hypothesis_number_;
+		preemptive_block_size = MAX(1, block_size_);
+		preemptive_keep_ratio = keep_ratio_;
+		preemptive_refined_hypothesis_number = refined_hypothesis_number_;
+	}
+
+	// Setting the two-stage scoring in MAGSAC++ for large point sets. Each model refined by sigma-consensus++
+	// is scored first on a random subset of the points of the given size. It is scored on all points only 
+	// if, with the given confidence, its average loss can be lower than that of the so-far-the-best model.
+	// The bound is obtained by the Hoeffding inequality since the MAGSAC++ loss of a point is bounded by 
+	// the loss of an outlier. Merged points are selected into the subset proportionally to their
+	// multiplicities. The ratio of the models scored on all points is reported in the statistics.
+	// Zero switches off the subset scoring.
+	void setSubsetScoring(
+		size_t subset_size_, // The number of points in the subset
+		double confidence_ = 0.99) // The confidence of the bound
+	{
+		if (confidence_ <= 0.0 || confidence_ >= 1.0)
+		{
+			fprintf(stderr, "The confidence of the subset scoring must be in (0, 1); %f is given.\n", confidence_);
+			return;
+		}
+		subset_scoring_size = subset_size_;
+		subset_scoring_confidence = confidence_;
+	}
+
+	// Setting the coarse-to-fine mode for dense point sets. If the pool is larger than the given
+	// number of points, a subsample of this size, stratified over a grid on the first image, is selected
+	// and the model is estimated on it. The model is then refined on all points by the given number of 
+	// sigma-consensus(++) iterations, thus, the run time hardly depends on the number of points.
+	// If the refinement fails, the model is searched on all points as usual. The iteration limit applies 
+	// to the two searches separately while the time limit applies to the whole run. Zero switches off the mode.
+	// The samplers with their own termination criterion, e.g., PROSAC, cannot be used in this mode.
+	void setCoarseToFine(
+		size_t coarse_point_number_, // The number of points in the subsample
+		size_t refinement_iteration_number_ = 5) // The maximum number of refinement iterations on all points
+	{
+		coarse_point_number = coarse_point_number_;
+		fine_refinement_iteration_number = MAX(1, refinement_iteration_number_);
+	}
+
+	// Setting the merging of duplicate correspondences in MAGSAC++. Points whose coordinates fall
+	// into the same cell of a grid with the given tolerance are replaced by their average which is 
+	// weighted by their number in the MAGSAC++ loss and in the weighted least-squares fitting. If the
+	// tolerance is zero, only the identical points are merged. The inlier number in the model score
+	// and the iteration number count the representatives while the returned per-point data refers to 
+	// the input points and it is the data of their representatives. The original MAGSAC does not use
+	// the merging. The samplers with their own
+	// termination criterion, e.g., PROSAC, cannot be used with the merging.
+	void setPointCompression(
+		bool compress_points_, // A flag deciding if the duplicate points are merged
+		double tolerance_ = 0.0) // The size of the grid cells in which the points are merged
+	{
+		compress_points = compress_points_;
+		compression_tolerance = MAX(0.0, tolerance_);
+	}
+
+	// Setting the weight-guided sampling. Once a model has been found, the minimal samples are drawn 
+	// proportionally to the MAGSAC++ weights of the points w.r.t. the so-far-the-best model, except for the
+	// given share of the samples which are selected by the sampler passed to run() to keep exploring. 
+	// If the points are merged, the weight of a merged point is multiplied by the number of input points
+	// it stands for, thus, the samples are drawn as if the points were not merged. Since only the latter ones can find a model with a different set of inliers, the required
+	// iteration number is increased accordingly. The generator drawing the weighted samples is seeded
+	// by the given seed at the start of each run, thus, the runs are reproducible with a deterministic sampler.
+	void setWeightGuidedSampling(
+		bool weight_guided_sampling_, // A flag deciding if the weight-guided sampling is used
+		double uniform_share_ = 0.5, // The share of the samples selected by the sampler passed to run()
+		uint64_t seed_ = 0) // The seed of the generator drawing the weighted samples
+	{
+		if (uniform_share_ <= 0.0 || uniform_share_ > 1.0)
+		{
+			fprintf(stderr, "The share of the uniform samples must be in (0, 1]; %f is given.\n", uniform_share_);
+			return;
+		}
+		weight_guided_sampling = weight_guided_sampling_;
+		weight_guided_uniform_share = uniform_share_;
+		weight_guided_sampling_seed = seed_;
+	}
+
+	// Setting the number of minimal samples whose models are estimated in a single call of the estimator.
+	// It only has an effect if the estimator provides batched estimation (see magsac::solver::HasBatchEstimation).
+	// All samples of a block are drawn before their models are verified, thus, a new so-far-the-best model
+	// affects the termination and the weight-guided sampling only from the next block. One switches off the batching.
+	void setSampleBatchSize(size_t sample_batch_size_)
+	{
+		sample_batch_size = MAX(1, sample_batch_size_);
+	}
+
+	// Setting the metrics to which the runs are added, e.g., the ones obtained from a
+	// magsac::utils::MetricsRegistry. The metrics are updated once per run. Null switches it off.
+	void setMetrics(magsac::utils::EstimationMetrics *metrics_)
+	{
+		metrics = metrics_;
+	}
+
+	// Setting the tracer recording the timeline of the runs. The spans are recorded only if
+	// USE_TRACING is defined, otherwise, the tracing is compiled out. Null switches it off.
+	void setTracer(magsac::utils::RunTracer *tracer_)
+	{
+		tracer = tracer_;
+	}
+
 	// A function to set a desired minimum frames-per-second (FPS) value.
 	void setFPS(int fps_) 
 	{ 
@@ -120,13 +559,23 @@ public:
 			1.0 / fps_;
 	}
 
+	// A function to set the time limit in seconds after which the algorithm is interrupted.
+	// A non-positive value removes the limit.
+	void setTimeLimit(double time_limit_)
+	{
+		desired_fps = -1;
+		time_limit = time_limit_ <= 0 ?
+			std::numeric_limits<double>::max() :
+			time_limit_;
+	}
+
 	// The post-processing algorithm applying sigma-consensus to the input model once.
 	bool postProcessing(
 		const cv::Mat &points, // All data points
 		const gcransac::Model &so_far_the_best_model, // The input model to be improved
 		gcransac::Model &output_model, // The improved model parameters
 		ModelScore &output_score, // The score of the improved model
-		const ModelEstimator &estimator); // The model estimator
+		const ModelEstimator &estimator) const; // The model estimator
 
 	// The function determining the quality/score of a model using the original MAGSAC
 	// criterion. Note that this function is significantly slower than the quality
@@ -135,8 +584,9 @@ public:
 		const cv::Mat& points_, // All data points
 		const gcransac::Model& model_, // The input model
 		const ModelEstimator& estimator_, // The model estimator
+		const double log_confidence_, // The logarithm of 1 - the required confidence
 		double& marginalized_iteration_number_, // The required number of iterations marginalized over the noise scale
-		double& score_); // The score/quality of the model
+		double& score_) const; // The score/quality of the model
 
 	// The function determining the quality/score of a 
 	// model using the MAGSAC++ criterion.
@@ -145,7 +595,8 @@ public:
 		const gcransac::Model &model_, // The model parameter
 		const ModelEstimator &estimator_, // The model estimator class
 		double &score_, // The score to be calculated
-		const double &previous_best_score_); // The score of the previous so-far-the-best model
+		const double &previous_best_score_, // The score of the previous so-far-the-best model
+		const double *multiplicities_ = nullptr) const; // If given, the number of input points each point stands for
 
 	// The function to extract inliers mask of a model
 	// for a given threshold
@@ -154,7 +605,7 @@ public:
 		const gcransac::Model &model_, // The model parameter
 		const ModelEstimator &estimator_,
 		const double trehshold_,	// Inlier/outlier threshold
-		std::vector<bool> &inliers_mask_);
+		std::vector<bool> &inliers_mask_) const;
 
 
 	size_t number_of_irwls_iters;
@@ -167,11 +618,330 @@ protected:
 	double time_limit; // A time limit after the algorithm is interrupted
 	int desired_fps; // The desired FPS (TODO: not tested with MAGSAC)
 	bool apply_post_processing; // Decides if the post-processing step should be applied
-	int point_number; // The current point number
-	int last_iteration_number; // The iteration number implied by the last run of sigma-consensus
-	double log_confidence; // The logarithm of the required confidence
 	size_t partition_number; // Number of partitions used to speed up sigma-consensus
 	double interrupting_threshold; // A threshold to speed up MAGSAC by interrupting the sigma-consensus procedure whenever there is no chance of being better than the previous so-far-the-best model
+	bool lazy_validity_check; // Decides if the validity check is applied only to the models which would replace the so-far-the-best one
+	size_t duplicate_sample_capacity; // The maximum number of evaluated samples remembered. If zero, the duplicate samples are not detected.
+	size_t refined_model_cache_size; // The number of refined models remembered. If zero, the refined models are not cached.
+	size_t preemptive_hypothesis_number; // The number of models generated in the preemptive mode
+	size_t preemptive_block_size; // The number of points evaluated before dropping models in the preemptive mode
+	double preemptive_keep_ratio; // The ratio of the models kept after each block in the preemptive mode
+	size_t preemptive_refined_hypothesis_number; // The number of the best models refined in the preemptive mode
+	size_t subset_scoring_size; // The number of points on which the models are scored first. If zero, the models are scored on all points.
+	double subset_scoring_confidence; // The confidence of the bound used for deciding if a model is scored on all points
+	size_t coarse_point_number; // The number of points used in the coarse phase. If zero, the coarse-to-fine mode is switched off.
+	size_t fine_refinement_iteration_number; // The maximum number of iterations refining the coarse model on all points
+	bool compress_points; // A flag deciding if the duplicate points are merged into weighted representatives
+	double compression_tolerance; // The size of the grid cells in which the points are merged. If zero, only the identical points are merged.
+	bool weight_guided_sampling; // A flag deciding if the samples are drawn according to the weights w.r.t. the so-far-the-best model
+	double weight_guided_uniform_share; // The share of the samples selected by the given sampler in the weight-guided sampling
+	uint64_t weight_guided_sampling_seed; // The seed of the generator drawing the weighted samples
+	size_t sample_batch_size; // The number of minimal samples whose models are estimated in a single call of the estimator
+	magsac::utils::EstimationMetrics *metrics; // The metrics to which the runs are added, if given
+	magsac::utils::RunTracer *tracer; // The tracer recording the timeline of the runs, if given
+	static constexpr size_t validity_cache_size = 8; // The maximum number of verdicts stored
+
+	// The loss function of MAGSAC++ marginalizing the residuals over the noise scale.
+	// The constants are calculated once when the object is created.
+	struct PlusPlusLoss
+	{
+		double maximum_threshold; // The maximum inlier-outlier threshold
+		double maximum_sigma_2_per_2; // \sigma_{max}^2 / 2
+		double maximum_sigma_2_times_2; // 2 * \sigma_{max}^2
+		double outlier_loss; // The loss implied by an outlier. It is the largest loss a point can imply.
+		double two_ad_dof_plus_one_per_maximum_sigma; // 2^(DoF + 1) / \sigma_{max}
+
+		explicit PlusPlusLoss(const double maximum_threshold_) :
+			maximum_threshold(maximum_threshold_)
+		{
+			// The degrees of freedom of the data from which the model is estimated.
+			// E.g., for models coming from point correspondences (x1,y1,x2,y2), it is 4.
+			constexpr size_t degrees_of_freedom = ModelEstimator::getDegreesOfFreedom();
+			// A 0.99 quantile of the Chi^2-distribution to convert sigma values to residuals
+			constexpr double k = ModelEstimator::getSigmaQuantile();
+			// A multiplier to convert residual values to sigmas
+			constexpr double threshold_to_sigma_multiplier = 1.0 / k;
+			// Calculating (DoF - 1) / 2 which will be used for the estimation
+			constexpr double dof_minus_one_per_two = (degrees_of_freedom - 1.0) / 2.0;
+			// Calculating (DoF + 1) / 2 which will be used for the estimation
+			constexpr double dof_plus_one_per_two = (degrees_of_freedom + 1.0) / 2.0;
+			// Calculate the lower incomplete gamma value of k
+			constexpr double lower_gamma_value_of_k = ModelEstimator::getLowerIncompleteGammaOfK();
+			// Convert the maximum threshold to a sigma value
+			const double maximum_sigma = threshold_to_sigma_multiplier * maximum_threshold;
+			// Calculate the squared maximum sigma
+			const double maximum_sigma_2 = maximum_sigma * maximum_sigma;
+
+			maximum_sigma_2_per_2 = maximum_sigma_2 / 2.0;
+			maximum_sigma_2_times_2 = maximum_sigma_2 * 2.0;
+			outlier_loss = maximum_sigma * std::pow(2.0, dof_minus_one_per_two) * lower_gamma_value_of_k;
+			two_ad_dof_plus_one_per_maximum_sigma = std::pow(2.0, dof_plus_one_per_two) / maximum_sigma;
+		}
+
+		// Calculating the loss implied by a point with the given residual
+		inline double operator()(const double residual_) const
+		{
+			// Calculate the gamma value of k
+			constexpr double gamma_value_of_k = ModelEstimator::getUpperIncompleteGammaOfK();
+
+			// If the residual is larger than the maximum threshold, consider it outlier
+			if (maximum_threshold < residual_)
+				return outlier_loss;
+
+			// Otherwise, consider the point inlier, and calculate the implied loss.
+			// Calculate the squared residual
+			const double squared_residual = residual_ * residual_;
+			// Divide the residual by the 2 * \sigma^2
+			const double squared_residual_per_sigma = squared_residual / maximum_sigma_2_times_2;
+			// Get the position of the gamma value in the lookup table
+			size_t x = round(precision_of_stored_incomplete_gammas * squared_residual_per_sigma);
+			// If the sought gamma value is not stored in the lookup, return the closest element
+			if (stored_incomplete_gamma_number < x)
+				x = stored_incomplete_gamma_number;
+
+			// Calculate the loss implied by the current point
+			const double loss = maximum_sigma_2_per_2 * stored_lower_incomplete_gamma_values[x] +
+				squared_residual / 4.0 * (stored_complete_gamma_values[x] -
+					gamma_value_of_k);
+			return loss * two_ad_dof_plus_one_per_maximum_sigma;
+		}
+	};
+
+	// The weight which sigma-consensus++ assigns to a point given its residual.
+	// The constants are calculated once when the object is created.
+	struct PlusPlusWeight
+	{
+		double maximum_threshold; // The maximum inlier-outlier threshold
+		double one_over_sigma; // C * 2^(DoF - 1) / \sigma_{max}
+		double squared_sigma_max_2; // 2 * \sigma_{max}^2
+		double weight_zero; // The weight of a point with 0 residual (i.e., fitting perfectly)
+		double gamma_k; // The upper incomplete gamma value of (DoF - 1) / 2 with k^2 / 2
+
+		explicit PlusPlusWeight(const double maximum_threshold_) :
+			maximum_threshold(maximum_threshold_)
+		{
+			// The degrees of freedom of the data from which the model is estimated.
+			constexpr size_t degrees_of_freedom = ModelEstimator::getDegreesOfFreedom();
+			// Calculating (DoF - 1) / 2 which will be used for the estimation
+			constexpr double dof_minus_one_per_two = (degrees_of_freedom - 1.0) / 2.0;
+			// The constant used in sigma-consensus++
+			constexpr double C = ModelEstimator::getC();
+
+			gamma_k = ModelEstimator::getUpperIncompleteGammaOfK();
+			one_over_sigma = C * std::pow(2.0, dof_minus_one_per_two) / maximum_threshold;
+			squared_sigma_max_2 = maximum_threshold * maximum_threshold * 2.0;
+			weight_zero = one_over_sigma * (tgamma(dof_minus_one_per_two) - gamma_k);
+		}
+
+		inline double operator()(const double residual_) const
+		{
+			// Points farther than the maximum threshold get zero weight
+			if (residual_ >= maximum_threshold)
+				return 0.0;
+			if (residual_ < std::numeric_limits<double>::epsilon())
+				return weight_zero;
+
+			// Get the position of the gamma value in the lookup table
+			size_t x = round(precision_of_stored_gammas * residual_ * residual_ / squared_sigma_max_2);
+			// If the sought gamma value is not stored in the lookup, return the closest element
+			if (stored_gamma_number < x)
+				x = stored_gamma_number;
+			return one_over_sigma * (stored_gamma_values[x] - gamma_k);
+		}
+	};
+
+	// Running MAGSAC using the context of the calling thread if no other run uses it
+	bool runWithThreadContext(
+		const cv::Mat &points_,
+		const double confidence_,
+		ModelEstimator& estimator_,
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+		gcransac::Model &obtained_model_,
+		int &iteration_number_,
+		ModelScore &model_score_,
+		const std::vector<size_t> *pool_,
+		RunOutput *output_) const;
+
+	// The implementation of MAGSAC. If no pool is given, all points are used for sampling.
+	bool runWithContext(
+		const cv::Mat &points_,
+		const double confidence_,
+		ModelEstimator& estimator_,
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+		gcransac::Model &obtained_model_,
+		int &iteration_number_,
+		ModelScore &model_score_,
+		const std::vector<size_t> *pool_,
+		RunContext &context_,
+		RunOutput *output_) const;
+
+	// Selecting a minimal sample and estimating the implied models. 
+	// It returns the number of attempts made.
+	size_t sampleModels(
+		const cv::Mat &points_,
+		const ModelEstimator &estimator_,
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+		const std::vector<size_t> &pool_,
+		std::vector<gcransac::Model> &models_,
+		RunContext &context_) const;
+
+	// Selecting a block of minimal samples and estimating their models in a single call of the estimator.
+	// The models are written to the beginning of context_.minimal_models and their number is returned in
+	// model_number_. It returns the number of sampling attempts made.
+	size_t sampleModelBatch(
+		const cv::Mat &points_,
+		const ModelEstimator &estimator_,
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+		const std::vector<size_t> &pool_,
+		const size_t sample_number_,
+		size_t &model_number_,
+		RunContext &context_) const;
+
+	// Selecting a minimal sample which has not been evaluated yet and passes the sample check 
+	// of the estimator. It returns false if the selected sample cannot be used.
+	bool selectSample(
+		const cv::Mat &points_,
+		const ModelEstimator &estimator_,
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+		const std::vector<size_t> &pool_,
+		size_t * const sample_,
+		RunContext &context_) const;
+
+	// Building the table of the weight-guided sampling from the MAGSAC++ weights
+	// of the points in the pool w.r.t. the so-far-the-best model
+	void updateSamplingWeights(
+		const cv::Mat &points_,
+		const ModelEstimator &estimator_,
+		const std::vector<size_t> &pool_,
+		const gcransac::Model &best_model_,
+		RunContext &context_) const;
+
+	// Drawing a minimal sample from the pool proportionally to the weights of the points.
+	// It returns false if no sample of distinct points has been found.
+	bool sampleByWeights(
+		const std::vector<size_t> &pool_,
+		size_t * const sample_,
+		RunContext &context_) const;
+
+	// Refining a model by sigma-consensus and replacing the so-far-the-best model by it
+	// if it is better. It returns true if the so-far-the-best model has been replaced.
+	bool refineAndUpdateBest(
+		const cv::Mat &points_,
+		const gcransac::Model &model_,
+		const ModelEstimator &estimator_,
+		const size_t iteration_,
+		gcransac::Model &best_model_,
+		ModelScore &best_score_,
+		RunContext &context_) const;
+
+	// Searching for the best model by the main MAGSAC loop or, in the preemptive mode, by
+	// the breadth-first evaluation of the models
+	void searchModel(
+		const cv::Mat &points_,
+		const ModelEstimator &estimator_,
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+		const std::vector<size_t> &pool_,
+		const std::chrono::time_point<std::chrono::system_clock> &start_,
+		gcransac::Model &best_model_,
+		ModelScore &best_score_,
+		int &iteration_,
+		RunContext &context_) const;
+
+	// Merging the duplicate points into representatives and counting the points each of them stands for
+	void compressPoints(
+		const cv::Mat &points_,
+		RunContext &context_) const;
+
+	// Selecting the subsample of the coarse phase. The points in the pool are bucketed by a grid over 
+	// the coordinates of the first image and they are selected from the cells in a round-robin manner.
+	void selectCoarsePoints(
+		const cv::Mat &points_,
+		const std::vector<size_t> &pool_,
+		RunContext &context_) const;
+
+	// The preemptive, breadth-first evaluation of a fixed number of models
+	void runPreemptively(
+		const cv::Mat &points_,
+		const ModelEstimator &estimator_,
+		gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+		const std::vector<size_t> &pool_,
+		const std::chrono::time_point<std::chrono::system_clock> &start_,
+		gcransac::Model &best_model_,
+		ModelScore &best_score_,
+		int &iteration_,
+		RunContext &context_) const;
+
+	// Scoring a model on the subset of the points. It returns true if the model can be better than
+	// the so-far-the-best one with the required confidence and, thus, it has to be scored on all points.
+	bool isPromisingOnSubset(
+		const cv::Mat &points_,
+		const gcransac::Model &model_,
+		const ModelEstimator &estimator_,
+		const ModelScore &best_score_,
+		double &estimated_score_,
+		RunContext &context_) const;
+
+	// Looking for a refined model in the cache. If it is found, its score and validity are returned.
+	const typename RunContext::RefinedModelEntry *findRefinedModel(
+		const uint64_t key_,
+		RunContext &context_) const;
+
+	// Storing the score and validity of a refined model in the cache
+	void storeRefinedModel(
+		const uint64_t key_,
+		const double score_,
+		const bool is_valid_,
+		RunContext &context_) const;
+
+	// Filling the per-point data of the estimated model from the data of its last weighted fitting
+	void collectRunOutput(
+		const size_t point_number_,
+		const size_t *representative_indices_,
+		const bool is_model_found_,
+		RunContext &context_,
+		RunOutput &output_) const;
+
+	// Checking if the run using the context has been cancelled
+	static bool isCancelled(const RunContext &context_)
+	{
+		return context_.cancellation_token != nullptr &&
+			context_.cancellation_token->isCancelled();
+	}
+
+	// Checking if the time limit has been exceeded since the start of the run
+	bool isTimeLimitExceeded(const std::chrono::time_point<std::chrono::system_clock> &start_) const
+	{
+		if (time_limit == std::numeric_limits<double>::max())
+			return false;
+		const std::chrono::duration<double> elapsed_seconds = std::chrono::system_clock::now() - start_;
+		return elapsed_seconds.count() > time_limit;
+	}
+
+	// Reporting a new so-far-the-best model to the observer and to the snapshot if they are given
+	void reportBestModel(
+		const gcransac::Model &best_model_,
+		const ModelScore &best_score_,
+		const size_t iteration_,
+		const size_t max_iteration_,
+		const RunContext &context_) const;
+
+	// Adding a finished run to the metrics
+	void addRunToMetrics(
+		const std::chrono::steady_clock::time_point &start_,
+		const int iteration_number_,
+		const bool success_,
+		const RunStatistics &statistics_) const;
+
+	// Applying the deferred validity check to a model which would replace the so-far-the-best one.
+	// If the check updates the model, it is re-scored. It returns true if the model is valid and
+	// it is still better than the so-far-the-best model.
+	bool checkValidityLazily(
+		const cv::Mat &points_,
+		gcransac::Model &model_,
+		ModelScore &score_,
+		const ModelEstimator &estimator_,
+		const ModelScore &best_score_,
+		RunContext &context_) const;
 
 	bool sigmaConsensus(
 		const cv::Mat& points_,
@@ -179,7 +949,8 @@ protected:
 		gcransac::Model& refined_model_,
 		ModelScore& score_,
 		const ModelEstimator& estimator_,
-		const ModelScore& best_score_);
+		const ModelScore& best_score_,
+		RunContext &context_) const;
 
 	bool sigmaConsensusPlusPlus(
 		const cv::Mat &points_,
@@ -187,7 +958,8 @@ protected:
 		gcransac::Model& refined_model_,
 		ModelScore &score_,
 		const ModelEstimator &estimator_,
-		const ModelScore &best_score_);
+		const ModelScore &best_score_,
+		RunContext &context_) const;
 };
 
 template <class DatumType, class ModelEstimator>
@@ -198,134 +970,1250 @@ bool MAGSAC<DatumType, ModelEstimator>::run(
 	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
 	gcransac::Model& obtained_model_,
 	int& iteration_number_,
-	ModelScore &model_score_)
+	ModelScore &model_score_,
+	RunOutput *output_) const
 {
+	return runWithThreadContext(points_,
+		confidence_,
+		estimator_,
+		sampler_,
+		obtained_model_,
+		iteration_number_,
+		model_score_,
+		nullptr,
+		output_);
+}
+
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::run(
+	const cv::Mat& points_,
+	const double confidence_,
+	ModelEstimator& estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	gcransac::Model& obtained_model_,
+	int& iteration_number_,
+	ModelScore &model_score_,
+	const std::vector<size_t> &pool_,
+	RunOutput *output_) const
+{
+	return runWithThreadContext(points_,
+		confidence_,
+		estimator_,
+		sampler_,
+		obtained_model_,
+		iteration_number_,
+		model_score_,
+		&pool_,
+		output_);
+}
+
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::run(
+	const cv::Mat& points_,
+	const double confidence_,
+	ModelEstimator& estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	gcransac::Model& obtained_model_,
+	int& iteration_number_,
+	ModelScore &model_score_,
+	RunContext &context_,
+	RunOutput *output_) const
+{
+	return runWithContext(points_,
+		confidence_,
+		estimator_,
+		sampler_,
+		obtained_model_,
+		iteration_number_,
+		model_score_,
+		nullptr,
+		context_,
+		output_);
+}
+
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::run(
+	const cv::Mat& points_,
+	const double confidence_,
+	ModelEstimator& estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	gcransac::Model& obtained_model_,
+	int& iteration_number_,
+	ModelScore &model_score_,
+	const std::vector<size_t> &pool_,
+	RunContext &context_,
+	RunOutput *output_) const
+{
+	return runWithContext(points_,
+		confidence_,
+		estimator_,
+		sampler_,
+		obtained_model_,
+		iteration_number_,
+		model_score_,
+		&pool_,
+		context_,
+		output_);
+}
+
+template <class DatumType, class ModelEstimator>
+std::future<typename MAGSAC<DatumType, ModelEstimator>::AsyncRunResult> MAGSAC<DatumType, ModelEstimator>::runAsync(
+	const cv::Mat &points_,
+	const double confidence_,
+	ModelEstimator& estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	RunContext &context_,
+	const magsac::utils::CancellationToken &cancellation_token_,
+	const std::vector<size_t> *pool_) const
+{
+	return std::async(std::launch::async, [this, &points_, confidence_, &estimator_, &sampler_, &context_, &cancellation_token_, pool_]()
+	{
+		context_.cancellation_token = &cancellation_token_;
+		if constexpr (magsac::estimator::HasCancellation<ModelEstimator>::value)
+			estimator_.setCancellationToken(&cancellation_token_);
+
+		AsyncRunResult result{};
+		const bool success = runWithContext(points_,
+			confidence_,
+			estimator_,
+			sampler_,
+			result.model,
+			result.iteration_number,
+			result.score,
+			pool_,
+			context_,
+			nullptr);
+
+		context_.cancellation_token = nullptr;
+		if constexpr (magsac::estimator::HasCancellation<ModelEstimator>::value)
+			estimator_.setCancellationToken(nullptr);
+
+		if (context_.statistics.is_cancelled)
+			result.status = RunStatus::Cancelled;
+		else
+			result.status = success ? RunStatus::Success : RunStatus::Failed;
+		return result;
+	});
+}
+
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::runWithThreadContext(
+	const cv::Mat& points_,
+	const double confidence_,
+	ModelEstimator& estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	gcransac::Model& obtained_model_,
+	int& iteration_number_,
+	ModelScore &model_score_,
+	const std::vector<size_t> *pool_,
+	RunOutput *output_) const
+{
+	// The context of the calling thread. It is kept between the runs to reuse its buffers.
+	thread_local RunContext thread_context;
+	thread_local bool is_thread_context_used = false;
+
+	// A run started by another one of the same thread, e.g., from its observer, gets its own context
+	if (is_thread_context_used)
+	{
+		RunContext context;
+		return runWithContext(points_,
+			confidence_,
+			estimator_,
+			sampler_,
+			obtained_model_,
+			iteration_number_,
+			model_score_,
+			pool_,
+			context,
+			output_);
+	}
+
+	// The context is released even if the run throws
+	struct ContextRelease
+	{
+		bool &is_used;
+		~ContextRelease() { is_used = false; }
+	} context_release{ is_thread_context_used };
+	is_thread_context_used = true;
+
+	return runWithContext(points_,
+		confidence_,
+		estimator_,
+		sampler_,
+		obtained_model_,
+		iteration_number_,
+		model_score_,
+		pool_,
+		thread_context,
+		output_);
+}
+
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::runWithContext(
+	const cv::Mat& points_,
+	const double confidence_,
+	ModelEstimator& estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	gcransac::Model& obtained_model_,
+	int& iteration_number_,
+	ModelScore &model_score_,
+	const std::vector<size_t> *pool_,
+	RunContext &context_,
+	RunOutput *output_) const
+{
+	static_assert(magsac::estimator::IsMagsacEstimator<ModelEstimator>::value,
+		"The estimator does not provide the interface MAGSAC requires (see magsac::estimator::IsMagsacEstimator).");
+	MAGSAC_TRACE_SPAN_VALUE(tracer, "run", "point_number", points_.rows);
+
+	// The start of the run measured only if the metrics are collected or the run is observed
+	if (metrics != nullptr ||
+		context_.observer != nullptr ||
+		context_.snapshot != nullptr)
+		context_.run_start = std::chrono::steady_clock::now();
+	if (context_.observer != nullptr)
+		context_.observer->onRunStarted();
+	if (context_.snapshot != nullptr)
+		context_.snapshot->reset();
+
+	// Address the input points through a header not owning them. Taking a row of a matrix owning its
+	// data updates the reference counter atomically, which would happen for every point and model.
+	const bool is_header_used = points_.u != nullptr &&
+		points_.isContinuous() &&
+		points_.type() == CV_64F;
+	if (is_header_used)
+		context_.point_header = magsac::utils::wrapPoints(magsac::utils::viewPoints(points_));
+	const cv::Mat &input_points = is_header_used ? context_.point_header : points_; // The input points
+
+	// In MAGSAC++, merge the duplicate points into weighted representatives if needed and use them
+	// instead of the input points. The given pool is replaced by the representatives of its points.
+	const bool is_compressed = compress_points &&
+		magsac_version != Version::MAGSAC_ORIGINAL;
+	context_.multiplicities = nullptr;
+	if (is_compressed)
+	{
+		compressPoints(input_points, context_);
+		context_.multiplicities = context_.point_multiplicities.data();
+
+		if (pool_ != nullptr)
+		{
+			std::vector<size_t> &compressed_pool = context_.compressed_pool;
+			compressed_pool.clear();
+			for (const size_t point_idx : *pool_)
+				compressed_pool.emplace_back(context_.representative_indices[point_idx]);
+			std::sort(compressed_pool.begin(), compressed_pool.end());
+			compressed_pool.erase(std::unique(compressed_pool.begin(), compressed_pool.end()), compressed_pool.end());
+			pool_ = &compressed_pool;
+		}
+	}
+	const cv::Mat &points = is_compressed ? context_.compressed_points : input_points; // The points used for the estimation
+
+	// Use all points as the sampling pool if no pool is given. The pool is kept between 
+	// the runs and it is only rebuilt when the number of points changes.
+	if (pool_ == nullptr)
+	{
+		std::vector<size_t> &full_pool = context_.full_pool;
+		if (full_pool.size() != static_cast<size_t>(points.rows))
+		{
+			full_pool.resize(points.rows);
+			for (size_t point_idx = 0; point_idx < full_pool.size(); ++point_idx)
+				full_pool[point_idx] = point_idx;
+		}
+		pool_ = &full_pool;
+	}
+
 	// Initialize variables
-	std::chrono::time_point<std::chrono::system_clock> start, end; // Variables for time measuring: start and end times
-	std::chrono::duration<double> elapsed_seconds; // Variables for time measuring: elapsed time
-	log_confidence = log(1.0 - confidence_); // The logarithm of 1 - confidence
-	point_number = points_.rows; // Number of points
+	std::chrono::time_point<std::chrono::system_clock> start; // The start time
+	context_.log_confidence = log(1.0 - confidence_); // The logarithm of 1 - confidence
+	context_.point_number = points.rows; // Number of points
 	const int sample_size = estimator_.sampleSize(); // The sample size required for the estimation
-	size_t max_iteration = iteration_limit; // The maximum number of iterations initialized to the iteration limit
 	int iteration = 0; // Current number of iterations
 	gcransac::Model so_far_the_best_model; // Current best model
 	ModelScore so_far_the_best_score; // The score of the current best model
-	std::unique_ptr<size_t[]> minimal_sample(new size_t[sample_size]); // The sample used for the estimation
+	const bool is_time_limited = time_limit < std::numeric_limits<double>::max(); // A flag saying if there is a time limit set
+
+	// Reset the statistics and the outputs, so nothing of a previous run using the context is reported
+	// if this one returns early
+	context_.statistics = RunStatistics();
+	obtained_model_ = gcransac::Model();
+	iteration_number_ = 0;
+	model_score_ = ModelScore();
+	
+	// The samplers with their own termination criterion, e.g., PROSAC, order the points by their indices
+	// in the input, which neither the merged representatives nor the subsample of the coarse phase keep
+	magsac::sampler::IterationFeedback * const iteration_feedback =
+		dynamic_cast<magsac::sampler::IterationFeedback *>(&sampler_);
+	const bool is_feedback_unusable = iteration_feedback != nullptr &&
+		(is_compressed || coarse_point_number > 0);
+	if (is_feedback_unusable)
+		fprintf(stderr, "The sampler providing the iteration number cannot be used with the point compression or the coarse-to-fine mode.\n");
+
+	if (pool_->size() < sample_size)
+		fprintf(stderr, "There are not enough points for applying robust estimation. Minimum is %d; while %d are given.\n", 
+			sample_size, static_cast<int>(pool_->size()));
+
+	if (is_feedback_unusable ||
+		pool_->size() < sample_size)
+	{	
+		if (output_ != nullptr)
+			collectRunOutput(points_.rows, nullptr, false, context_, *output_);
+		if (metrics != nullptr)
+			addRunToMetrics(context_.run_start, 0, false, context_.statistics);
+		return false;
+	}
+
+	// Let the sampler prepare for the pool of this run, e.g., order it by the quality of the points
+	if (iteration_feedback != nullptr)
+		iteration_feedback->prepare(*pool_, sample_size);
+
+	// Set the start time variable if there is some time limit set
+	if (is_time_limited)
+		start = std::chrono::system_clock::now();
+
+	// Forget the validity verdicts of the previous run
+	context_.validity_cache.clear();
+	context_.validity_cache.reserve(validity_cache_size);
+	context_.validity_cache_position = 0;
+
+	// Keep the data of the weighted fittings only if the per-point data has to be returned
+	context_.collect_fit_data = output_ != nullptr;
+	context_.best_fit_data.point_indices.clear();
+
+	// Forget the samples and models of the previous run
+	context_.refined_model_cache.clear();
+	context_.refined_model_cache.reserve(refined_model_cache_size);
+	context_.refined_model_cache_position = 0;
+	if (duplicate_sample_capacity > 0)
+		context_.evaluated_samples.initialize(duplicate_sample_capacity);
+	context_.scoring_subset.clear();
+	context_.sampling_alias_table.clear();
+	context_.sampling_generator.seed(weight_guided_sampling_seed);
+
+	// In the coarse-to-fine mode, estimate the model on a stratified subsample of the points first
+	const bool is_coarse_to_fine = coarse_point_number > 0 &&
+		pool_->size() > MAX(coarse_point_number, static_cast<size_t>(sample_size));
+	if (is_coarse_to_fine)
+	{
+		selectCoarsePoints(points, *pool_, context_);
+		context_.point_number = context_.coarse_points.rows;
+
+		// The points of the subsample stand for themselves
+		const double * const multiplicities = context_.multiplicities;
+		context_.multiplicities = nullptr;
+
+		searchModel(context_.coarse_points,
+			estimator_,
+			sampler_,
+			context_.coarse_pool,
+			start,
+			so_far_the_best_model,
+			so_far_the_best_score,
+			iteration,
+			context_);
+
+		// The samples, the scores, the validity verdicts and the fit data of the subsample do not 
+		// carry over to all points
+		context_.best_fit_data.point_indices.clear();
+		context_.validity_cache.clear();
+		context_.validity_cache_position = 0;
+		context_.point_number = points.rows;
+		context_.multiplicities = multiplicities;
+		context_.refined_model_cache.clear();
+		context_.refined_model_cache_position = 0;
+		if (duplicate_sample_capacity > 0)
+			context_.evaluated_samples.clear();
+		context_.sampling_alias_table.clear();
+	}
+
+	// Select the subset of the points on which the models are scored first. The subset depends
+	// only on the number of points, thus, the results are reproducible with a deterministic sampler.
+	if (subset_scoring_size > 0 &&
+		subset_scoring_size < static_cast<size_t>(points.rows))
+	{
+		std::vector<size_t> &subset = context_.scoring_subset;
+		magsac::utils::FastRandomGenerator random_generator(points.rows);
+		if (context_.multiplicities == nullptr)
+		{
+			subset.resize(points.rows);
+			for (size_t point_idx = 0; point_idx < subset.size(); ++point_idx)
+				subset[point_idx] = point_idx;
+
+			for (size_t position = 0; position < subset_scoring_size; ++position)
+				std::swap(subset[position],
+					subset[position + random_generator.bounded(subset.size() - position)]);
+			subset.resize(subset_scoring_size);
+			context_.represented_point_number = points.rows;
+		}
+		else
+		{
+			// A merged point is selected proportionally to the number of input points it stands for. 
+			// Thus, each selected point stands for a single input point and its loss is bounded by 
+			// the loss of an outlier however many points are merged.
+			magsac::utils::AliasTable multiplicity_table;
+			multiplicity_table.build(context_.multiplicities, points.rows);
+			subset.resize(subset_scoring_size);
+			for (size_t &point_idx : subset)
+				point_idx = multiplicity_table.sample(random_generator);
+			context_.represented_point_number = std::accumulate(
+				context_.multiplicities, context_.multiplicities + points.rows, 0.0);
+		}
+	}
+
+	if (is_coarse_to_fine)
+	{
+		// Refine the model of the subsample on all points. The score is recalculated from scratch 
+		// since the score on the subsample is not comparable with that on all points. If the run
+		// has been cancelled, the model of the subsample is returned.
+		if (so_far_the_best_score.score > 0 &&
+			!context_.statistics.is_cancelled)
+		{
+			gcransac::Model seed_model = so_far_the_best_model; // The model from which the refinement starts
+			so_far_the_best_score = ModelScore();
+			for (size_t refinement_idx = 0; refinement_idx < fine_refinement_iteration_number; ++refinement_idx)
+			{
+				// Stop refining if the run is cancelled once the model has been scored on all points
+				if (refinement_idx > 0 &&
+					isCancelled(context_))
+				{
+					context_.statistics.is_cancelled = true;
+					break;
+				}
+				++iteration;
+				if (!refineAndUpdateBest(points,
+					seed_model,
+					estimator_,
+					iteration,
+					so_far_the_best_model,
+					so_far_the_best_score,
+					context_))
+					break;
+				reportBestModel(so_far_the_best_model, so_far_the_best_score, iteration, iteration_limit, context_);
+				seed_model = so_far_the_best_model;
+			}
+		}
+
+		// If the model could not be refined on all points, search for it as usual
+		if (so_far_the_best_score.score <= 0 &&
+			!context_.statistics.is_cancelled)
+			searchModel(points,
+				estimator_,
+				sampler_,
+				*pool_,
+				start,
+				so_far_the_best_model,
+				so_far_the_best_score,
+				iteration,
+				context_);
+	}
+	else
+		searchModel(points,
+			estimator_,
+			sampler_,
+			*pool_,
+			start,
+			so_far_the_best_model,
+			so_far_the_best_score,
+			iteration,
+			context_);
+	
+	// Apply sigma-consensus as a post processing step if needed and the estimated model is valid
+	if (apply_post_processing)
+	{
+		// TODO
+	}
+	
+	obtained_model_ = so_far_the_best_model;
+	iteration_number_ = iteration;
+	model_score_ = so_far_the_best_score;
+
+	// Return the per-point data of the estimated model if needed
+	if (output_ != nullptr)
+		collectRunOutput(points_.rows,
+			is_compressed ? context_.representative_indices.data() : nullptr,
+			so_far_the_best_score.score > 0,
+			context_,
+			*output_);
+
+	if (metrics != nullptr)
+		addRunToMetrics(context_.run_start, iteration, so_far_the_best_score.score > 0, context_.statistics);
+
+	return so_far_the_best_score.score > 0;
+}
+
+template <class DatumType, class ModelEstimator>
+void MAGSAC<DatumType, ModelEstimator>::searchModel(
+	const cv::Mat &points_,
+	const ModelEstimator &estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	const std::vector<size_t> &pool_,
+	const std::chrono::time_point<std::chrono::system_clock> &start_,
+	gcransac::Model &best_model_,
+	ModelScore &best_score_,
+	int &iteration_,
+	RunContext &context_) const
+{
+	// In the preemptive mode, a fixed number of models is generated and evaluated breadth-first
+	if (magsac_version == Version::MAGSAC_PLUS_PLUS_PREEMPTIVE)
+	{
+		runPreemptively(points_,
+			estimator_,
+			sampler_,
+			pool_,
+			start_,
+			best_model_,
+			best_score_,
+			iteration_,
+			context_);
+		return;
+	}
+
+	std::chrono::time_point<std::chrono::system_clock> end; // The end time
+	std::chrono::duration<double> elapsed_seconds; // Variables for time measuring: elapsed time
+	const bool is_time_limited = time_limit < std::numeric_limits<double>::max(); // A flag saying if there is a time limit set
+	size_t max_iteration = iteration_limit; // The maximum number of iterations initialized to the iteration limit
+	const int initial_iteration = iteration_; // The iteration number before this search
+	int iteration = 0; // Current number of iterations of this search
+	constexpr size_t sample_size = ModelEstimator::sampleSize(); // The sample size required for the estimation
+	// The number of samples whose models are estimated together. It is one if the estimator cannot estimate them together.
+	const size_t batch_size = magsac::solver::HasBatchEstimation<ModelEstimator>::value ? sample_batch_size : 1;
+
+	// If the sampler does not sample uniformly, it decides the number of iterations as well
+	magsac::sampler::IterationFeedback * const iteration_feedback =
+		dynamic_cast<magsac::sampler::IterationFeedback *>(&sampler_);
+
+	// Main MAGSAC iteration
+	while (mininum_iteration_number > iteration ||
+		iteration < max_iteration)
+	{
+		// Increase the current iteration number
+		++iteration;
+		const int block_first_iteration = iteration; // The iteration of the first sampling attempt of the block
+			
+		// Sample a minimal subset, or a block of them, and estimate the implied models
+		std::vector<gcransac::Model> &models = context_.minimal_models; // The set of estimated models
+		size_t model_number, model_generations;
+		if (batch_size > 1)
+		{
+			// The block does not exceed the remaining iterations
+			const size_t remaining_iteration_number = MAX(mininum_iteration_number, max_iteration) - iteration + 1;
+			model_generations = sampleModelBatch(points_,
+				estimator_,
+				sampler_,
+				pool_,
+				MIN(batch_size, remaining_iteration_number),
+				model_number,
+				context_);
+		}
+		else
+		{
+			models.clear();
+			model_generations = sampleModels(points_,
+				estimator_,
+				sampler_,
+				pool_,
+				models,
+				context_);
+			model_number = models.size();
+		}
+
+		// If the method was not able to generate any usable models, break the cycle.
+		iteration += model_generations - 1;
+
+		// Select the so-far-the-best from the estimated models
+		for (size_t model_idx = 0; model_idx < model_number; ++model_idx)
+		{
+			const gcransac::Model &model = models[model_idx];
+			// The models of a block are verified together, but each is found in the iteration its sample was selected
+			const int model_iteration = batch_size > 1 ?
+				block_first_iteration + static_cast<int>(context_.sample_batch_attempts[context_.minimal_model_samples[model_idx]]) - 1 :
+				iteration;
+			// Refine the model and update the best model parameters if needed
+			if (refineAndUpdateBest(points_,
+				model,
+				estimator_,
+				initial_iteration + model_iteration,
+				best_model_,
+				best_score_,
+				context_))
+			{
+				// Only the samples of the given sampler explore models with other inliers in the weight-guided 
+				// sampling, thus, the probability of finding such a model in an iteration is multiplied by their share
+				size_t required_iteration_number = context_.last_iteration_number;
+				if (weight_guided_sampling &&
+					context_.last_iteration_number > 0 &&
+					context_.last_iteration_number < std::numeric_limits<int>::max())
+				{
+					const double success_probability = 1.0 - std::exp(context_.log_confidence / context_.last_iteration_number);
+					required_iteration_number = static_cast<size_t>(std::ceil(context_.log_confidence /
+						std::log(1.0 - weight_guided_uniform_share * success_probability)));
+				}
+				max_iteration = MIN(max_iteration, required_iteration_number); // Update the max iteration number, but do not allow to increase
+
+				// Draw the later samples according to the weights w.r.t. the new so-far-the-best model
+				if (weight_guided_sampling)
+					updateSamplingWeights(points_, estimator_, pool_, best_model_, context_);
+
+				// Let the sampler apply its own termination criterion to the inliers of the new best model
+				if (iteration_feedback != nullptr)
+				{
+					std::vector<bool> &inliers = context_.best_model_inliers;
+					inliers.resize(points_.rows);
+					for (size_t point_idx = 0; point_idx < inliers.size(); ++point_idx)
+						inliers[point_idx] = estimator_.residual(points_.row(point_idx), best_model_) < interrupting_threshold;
+
+					max_iteration = MIN(max_iteration,
+						iteration_feedback->getRequiredIterationNumber(inliers, sample_size, context_.log_confidence));
+				}
+
+				reportBestModel(best_model_, best_score_, initial_iteration + model_iteration, max_iteration, context_);
+			}
+		}
+
+		// Interrupt if the run has been cancelled
+		if (isCancelled(context_))
+		{
+			context_.statistics.is_cancelled = true;
+			break;
+		}
+
+		// Update the time parameters if a time limit is set
+		if (is_time_limited)
+		{
+			end = std::chrono::system_clock::now();
+			elapsed_seconds = end - start_;
+
+			// Interrupt if the time limit is exceeded
+			if (elapsed_seconds.count() > time_limit)
+			{
+				context_.statistics.is_time_limit_reached = true;
+				break;
+			}
+		}
+	}
+
+	iteration_ = initial_iteration + iteration;
+}
+
+template <class DatumType, class ModelEstimator>
+void MAGSAC<DatumType, ModelEstimator>::compressPoints(
+	const cv::Mat &points_, // All data points
+	RunContext &context_) const
+{
+	const size_t point_number = points_.rows;
+	const size_t dimension_number = points_.cols;
+
+	std::unordered_map<uint64_t, size_t> &representative_lookup = context_.representative_lookup;
+	std::vector<size_t> &representative_indices = context_.representative_indices;
+	std::vector<double> &multiplicities = context_.point_multiplicities;
+	std::vector<uint64_t> &representative_cells = context_.representative_cells;
+	representative_lookup.clear();
+	representative_lookup.reserve(point_number);
+	representative_indices.resize(point_number);
+	multiplicities.clear();
+	representative_cells.clear();
+
+	// The sum of the coordinates of the merged points. They are collected here first 
+	// since the number of the representatives is not known in advance.
+	std::vector<double> &coordinate_sums = context_.coordinate_sums;
+	coordinate_sums.clear();
+	coordinate_sums.reserve(point_number * dimension_number);
+
+	for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
+	{
+		const double * const point = points_.ptr<double>(point_idx);
+
+		// Calculate the quantized coordinates and their fingerprint. The coordinates are appended 
+		// to the ones of the representatives and they are kept only if the point becomes a new one.
+		const size_t cell_offset = representative_cells.size();
+		uint64_t fingerprint = magsac::utils::mixBits(dimension_number);
+		for (size_t dimension = 0; dimension < dimension_number; ++dimension)
+		{
+			uint64_t cell;
+			if (compression_tolerance > 0.0)
+				cell = static_cast<uint64_t>(std::llround(point[dimension] / compression_tolerance));
+			else // Use the bits of the coordinate if only the identical points are merged
+				std::memcpy(&cell, point + dimension, sizeof(cell));
+			representative_cells.emplace_back(cell);
+			fingerprint = magsac::utils::mixBits(fingerprint ^ cell);
+		}
+
+		// Find the representative of the cell. If the fingerprint belongs to another cell, the next
+		// fingerprint derived from it is tried, so the points of different cells are never merged.
+		size_t representative_idx;
+		bool is_new_representative;
+		while (true)
+		{
+			const auto lookup_result = representative_lookup.emplace(fingerprint, multiplicities.size());
+			representative_idx = lookup_result.first->second;
+			is_new_representative = lookup_result.second;
+			if (is_new_representative ||
+				std::equal(representative_cells.begin() + cell_offset,
+					representative_cells.end(),
+					representative_cells.begin() + representative_idx * dimension_number))
+				break;
+			fingerprint = magsac::utils::mixBits(fingerprint + 1);
+		}
+
+		// Add the point to the representative of its cell or make it a new representative
+		if (is_new_representative)
+		{
+			multiplicities.emplace_back(0.0);
+			coordinate_sums.insert(coordinate_sums.end(), point, point + dimension_number);
+		}
+		else
+		{
+			representative_cells.resize(cell_offset);
+			for (size_t dimension = 0; dimension < dimension_number; ++dimension)
+				coordinate_sums[representative_idx * dimension_number + dimension] += point[dimension];
+		}
+
+		++multiplicities[representative_idx];
+		representative_indices[point_idx] = representative_idx;
+	}
+
+	// The representatives are the averages of the merged points
+	const size_t representative_number = multiplicities.size();
+	context_.compressed_points.create(static_cast<int>(representative_number), static_cast<int>(dimension_number), points_.type());
+	for (size_t representative_idx = 0; representative_idx < representative_number; ++representative_idx)
+	{
+		double * const representative = context_.compressed_points.template ptr<double>(representative_idx);
+		for (size_t dimension = 0; dimension < dimension_number; ++dimension)
+			representative[dimension] =
+				coordinate_sums[representative_idx * dimension_number + dimension] / multiplicities[representative_idx];
+	}
+}
+
+template <class DatumType, class ModelEstimator>
+void MAGSAC<DatumType, ModelEstimator>::selectCoarsePoints(
+	const cv::Mat &points_, // All data points
+	const std::vector<size_t> &pool_, // The points from which the subsample is selected
+	RunContext &context_) const
+{
+	const size_t pool_size = pool_.size();
+	const size_t grid_size = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(coarse_point_number)))); // The number of cells along an axis
+	const size_t cell_number = grid_size * grid_size;
+
+	// Calculate the bounding box of the points in the first image
+	double min_x = std::numeric_limits<double>::max(),
+		min_y = std::numeric_limits<double>::max(),
+		max_x = std::numeric_limits<double>::lowest(),
+		max_y = std::numeric_limits<double>::lowest();
+	for (const size_t point_idx : pool_)
+	{
+		const double x = points_.at<double>(point_idx, 0),
+			y = points_.at<double>(point_idx, 1);
+		min_x = MIN(min_x, x);
+		min_y = MIN(min_y, y);
+		max_x = MAX(max_x, x);
+		max_y = MAX(max_y, y);
+	}
+	const double scale_x = max_x > min_x ? grid_size / (max_x - min_x) : 0.0,
+		scale_y = max_y > min_y ? grid_size / (max_y - min_y) : 0.0;
+
+	// Shuffle the pool so the points are selected randomly within the cells. The order depends
+	// only on the number of points, thus, the results are reproducible with a deterministic sampler.
+	std::vector<size_t> &shuffled_pool = context_.coarse_pool;
+	shuffled_pool = pool_;
+	magsac::utils::FastRandomGenerator random_generator(pool_size);
+	for (size_t position = pool_size - 1; position > 0; --position)
+		std::swap(shuffled_pool[position], shuffled_pool[random_generator.bounded(position + 1)]);
+
+	// Order the points by their cells by counting sort
+	std::vector<size_t> &cell_offsets = context_.coarse_cell_offsets;
+	std::vector<size_t> &point_order = context_.coarse_point_order;
+	cell_offsets.assign(cell_number + 1, 0);
+	point_order.resize(pool_size);
+
+	const auto getCell = [&](const size_t point_idx_)
+	{
+		const size_t cell_x = MIN(grid_size - 1, static_cast<size_t>((points_.at<double>(point_idx_, 0) - min_x) * scale_x));
+		const size_t cell_y = MIN(grid_size - 1, static_cast<size_t>((points_.at<double>(point_idx_, 1) - min_y) * scale_y));
+		return cell_y * grid_size + cell_x;
+	};
+
+	for (const size_t point_idx : shuffled_pool)
+		++cell_offsets[getCell(point_idx) + 1];
+	for (size_t cell_idx = 0; cell_idx < cell_number; ++cell_idx)
+		cell_offsets[cell_idx + 1] += cell_offsets[cell_idx];
+	for (const size_t point_idx : shuffled_pool)
+		point_order[cell_offsets[getCell(point_idx)]++] = point_idx;
+	// Restore the first positions of the cells
+	for (size_t cell_idx = cell_number; cell_idx > 0; --cell_idx)
+		cell_offsets[cell_idx] = cell_offsets[cell_idx - 1];
+	cell_offsets[0] = 0;
+
+	// Select the points from the non-empty cells in a round-robin manner
+	std::vector<size_t> &active_cells = context_.coarse_active_cells;
+	active_cells.clear();
+	for (size_t cell_idx = 0; cell_idx < cell_number; ++cell_idx)
+		if (cell_offsets[cell_idx] < cell_offsets[cell_idx + 1])
+			active_cells.emplace_back(cell_idx);
+
+	context_.coarse_points.create(static_cast<int>(coarse_point_number), points_.cols, points_.type());
+	size_t selected_number = 0;
+	for (size_t round = 0; selected_number < coarse_point_number; ++round)
+	{
+		size_t kept_cell_number = 0;
+		for (const size_t cell_idx : active_cells)
+		{
+			if (selected_number == coarse_point_number)
+				break;
+
+			const size_t position = cell_offsets[cell_idx] + round;
+			points_.row(point_order[position]).copyTo(
+				context_.coarse_points.row(selected_number++));
+
+			// Keep the cell if it has more points
+			if (position + 1 < cell_offsets[cell_idx + 1])
+				active_cells[kept_cell_number++] = cell_idx;
+		}
+		active_cells.resize(kept_cell_number);
+	}
+
+	// All points of the subsample are used for sampling
+	context_.coarse_pool.resize(coarse_point_number);
+	for (size_t point_idx = 0; point_idx < coarse_point_number; ++point_idx)
+		context_.coarse_pool[point_idx] = point_idx;
+}
+
+template <class DatumType, class ModelEstimator>
+size_t MAGSAC<DatumType, ModelEstimator>::sampleModels(
+	const cv::Mat &points_,
+	const ModelEstimator &estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	const std::vector<size_t> &pool_,
+	std::vector<gcransac::Model> &models_,
+	RunContext &context_) const
+{
+	constexpr size_t max_unsuccessful_model_generations = 50;
+	constexpr size_t sample_size = ModelEstimator::sampleSize(); // The sample size required for the estimation
+	size_t minimal_sample[sample_size]; // The sample used for the estimation
+
+	size_t unsuccessful_model_generations = 0; // The number of unsuccessful model generations
+	// Try to select a minimal sample and estimate the implied model parameters
+	while (++unsuccessful_model_generations < max_unsuccessful_model_generations)
+	{
+		{
+			MAGSAC_TRACE_SPAN(tracer, "selectSample");
+			if (!selectSample(points_,
+				estimator_,
+				sampler_,
+				pool_,
+				minimal_sample,
+				context_))
+				continue;
+		}
+
+		// Estimate the model from the minimal sample
+		MAGSAC_TRACE_SPAN(tracer, "estimateModel");
+		if (estimator_.estimateModel(points_, // All data points
+			minimal_sample, // The selected minimal sample
+			&models_)) // The estimated models
+			break; 
+	}
+	return unsuccessful_model_generations;
+}
+
+template <class DatumType, class ModelEstimator>
+size_t MAGSAC<DatumType, ModelEstimator>::sampleModelBatch(
+	const cv::Mat &points_,
+	const ModelEstimator &estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	const std::vector<size_t> &pool_,
+	const size_t sample_number_,
+	size_t &model_number_,
+	RunContext &context_) const
+{
+	constexpr size_t max_unsuccessful_model_generations = 50;
+	constexpr size_t sample_size = ModelEstimator::sampleSize(); // The sample size required for the estimation
+	std::vector<size_t> &samples = context_.sample_batch;
+	samples.resize(sample_number_ * sample_size);
+	context_.sample_batch_attempts.resize(sample_number_);
+
+	// Select the samples of the block. If no usable sample is found in the given number of
+	// attempts, the block is estimated with the samples selected so far.
+	size_t attempt_number = 0, selected_sample_number = 0;
+	MAGSAC_TRACE_SPAN_VALUE(tracer, "sampleModelBatch", "sample_number", sample_number_);
+	while (selected_sample_number < sample_number_)
+	{
+		size_t selection_attempts = 0;
+		bool is_selected = false;
+		while (!is_selected &&
+			++selection_attempts < max_unsuccessful_model_generations)
+			is_selected = selectSample(points_,
+				estimator_,
+				sampler_,
+				pool_,
+				&samples[selected_sample_number * sample_size],
+				context_);
+		attempt_number += selection_attempts;
+		if (!is_selected)
+			break;
+		context_.sample_batch_attempts[selected_sample_number++] = attempt_number;
+	}
+
+	// Estimate the models of all selected samples at once
+	model_number_ = 0;
+	MAGSAC_TRACE_SPAN(tracer, "estimateModelsBatched");
+	if constexpr (magsac::solver::HasBatchEstimation<ModelEstimator>::value)
+		if (selected_sample_number > 0)
+			model_number_ = estimator_.estimateModelsBatched(points_, // All data points
+				samples.data(), // The selected minimal samples
+				selected_sample_number, // The number of the samples
+				context_.minimal_models, // The estimated models
+				context_.minimal_model_samples); // The index of the sample of each model
+	return attempt_number;
+}
+
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::selectSample(
+	const cv::Mat &points_,
+	const ModelEstimator &estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	const std::vector<size_t> &pool_,
+	size_t * const sample_,
+	RunContext &context_) const
+{
+	constexpr size_t sample_size = ModelEstimator::sampleSize(); // The sample size required for the estimation
+	constexpr size_t max_duplicate_draws = 100; // The number of duplicate samples after which the selection is given up
+
+	for (size_t duplicate_draw = 0; ; ++duplicate_draw)
+	{
+		// Get a minimal sample randomly. In the weight-guided sampling, the sample is drawn according
+		// to the weights w.r.t. the so-far-the-best model unless the given sampler has to be used.
+		if (weight_guided_sampling &&
+			!context_.sampling_alias_table.empty() &&
+			context_.sampling_generator.uniform() >= weight_guided_uniform_share)
+		{
+			if (!sampleByWeights(pool_, sample_, context_))
+				return false;
+		}
+		else if (!sampler_.sample(pool_, // The index pool from which the minimal sample can be selected
+			sample_, // The minimal sample
+			sample_size)) // The size of a minimal sample
+			return false;
+		++context_.statistics.sample_number;
+
+		// Redraw the sample if it has already been evaluated since it would lead to the same models.
+		// The redrawn samples do not consume iterations.
+		if (duplicate_sample_capacity == 0 ||
+			context_.evaluated_samples.insert(sample_, sample_size))
+			break;
+		++context_.statistics.duplicate_sample_number;
+
+		// Most of the samples have been evaluated if the duplicates keep coming
+		if (duplicate_draw + 1 >= max_duplicate_draws)
+			return false;
+	}
+
+	// Check if the selected sample is valid before estimating the model
+	// parameters which usually takes more time. 
+	return estimator_.isValidSample(points_, // All points
+		sample_); // The current sample
+}
+
+template <class DatumType, class ModelEstimator>
+void MAGSAC<DatumType, ModelEstimator>::updateSamplingWeights(
+	const cv::Mat &points_,
+	const ModelEstimator &estimator_,
+	const std::vector<size_t> &pool_,
+	const gcransac::Model &best_model_,
+	RunContext &context_) const
+{
+	MAGSAC_TRACE_SPAN(tracer, "updateSamplingWeights");
+	constexpr size_t sample_size = ModelEstimator::sampleSize(); // The sample size required for the estimation
+	const PlusPlusWeight weight_function(maximum_threshold);
+
+	std::vector<double> &weights = context_.sampling_weights;
+	weights.resize(pool_.size());
+	size_t weighted_point_number = 0; // The number of points with non-zero weight
+	for (size_t position = 0; position < pool_.size(); ++position)
+	{
+		const size_t point_idx = pool_[position];
+		weights[position] = weight_function(estimator_.residual(points_.row(point_idx), best_model_));
+		// A merged point is as likely to be drawn as the input points it stands for together
+		if (context_.multiplicities != nullptr)
+			weights[position] *= context_.multiplicities[point_idx];
+		if (weights[position] > 0.0)
+			++weighted_point_number;
+	}
+
+	// A minimal sample cannot be drawn if there are too few points with non-zero weight
+	if (weighted_point_number < sample_size)
+		context_.sampling_alias_table.clear();
+	else
+		context_.sampling_alias_table.build(weights.data(), weights.size());
+}
+
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::sampleByWeights(
+	const std::vector<size_t> &pool_,
+	size_t * const sample_,
+	RunContext &context_) const
+{
+	constexpr size_t sample_size = ModelEstimator::sampleSize(); // The sample size required for the estimation
+	constexpr size_t max_draws = 100 * sample_size; // The number of draws after which the sampling is given up
+
+	// Draw the points one-by-one and reject the ones already in the sample
+	size_t selected_number = 0;
+	for (size_t draw = 0; draw < max_draws && selected_number < sample_size; ++draw)
+	{
+		const size_t point_idx = pool_[context_.sampling_alias_table.sample(context_.sampling_generator)];
+		if (std::find(sample_, sample_ + selected_number, point_idx) == sample_ + selected_number)
+			sample_[selected_number++] = point_idx;
+	}
+	return selected_number == sample_size;
+}
+
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::refineAndUpdateBest(
+	const cv::Mat &points_,
+	const gcransac::Model &model_,
+	const ModelEstimator &estimator_,
+	const size_t iteration_,
+	gcransac::Model &best_model_,
+	ModelScore &best_score_,
+	RunContext &context_) const
+{
+	ModelScore score; // The score of the current model
+	gcransac::Model &refined_model = context_.refined_model; // The refined model parameters
+
+	// Apply sigma-consensus to refine the model parameters by marginalizing over the noise level sigma
+	bool success;
+	if (magsac_version == Version::MAGSAC_ORIGINAL)
+		success = sigmaConsensus(points_,
+			model_,
+			refined_model,
+			score,
+			estimator_,
+			best_score_,
+			context_);
+	else
+		success = sigmaConsensusPlusPlus(points_,
+			model_,
+			refined_model,
+			score,
+			estimator_,
+			best_score_,
+			context_);
+
+	// Continue if the model was rejected
+	if (!success || score.score == -1)
+		return false;
 
-	std::vector<size_t> pool(points_.rows);
-	for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
-		pool[point_idx] = point_idx;
-	
-	if (points_.rows < sample_size)
-	{	
-		fprintf(stderr, "There are not enough points for applying robust estimation. Minimum is %d; while %d are given.\n", 
-			sample_size, points_.rows);
+	// Save the iteration number when the current model is found
+	score.iteration = iteration_;
+
+	// Update the best model parameters if needed
+	if (!(best_score_ < score))
 		return false;
-	}
 
-	// Set the start time variable if there is some time limit set
-	if (desired_fps > -1)
-		start = std::chrono::system_clock::now();
+	// If the validity check has been deferred, apply it now since the model would 
+	// replace the so-far-the-best one.
+	if (lazy_validity_check &&
+		!checkValidityLazily(points_,
+			refined_model,
+			score,
+			estimator_,
+			best_score_,
+			context_))
+		return false;
 
-	constexpr size_t max_unsuccessful_model_generations = 50;
+	// Update the best model parameters. Swapping the descriptors moves the parameters without 
+	// copying them and the buffer of the refined model is reused by the next candidate.
+	best_model_.descriptor.swap(refined_model.descriptor);
+	best_score_ = score; // Update the best model's score
+	MAGSAC_TRACE_INSTANT(tracer, "updateBestModel", "score", score.score);
+	// Keep the data of the fitting of the new so-far-the-best model
+	if (context_.collect_fit_data)
+		std::swap(context_.best_fit_data, context_.fit_data);
+	return true;
+}
 
-	// Main MAGSAC iteration
-	while (mininum_iteration_number > iteration ||
-		iteration < max_iteration)
+template <class DatumType, class ModelEstimator>
+void MAGSAC<DatumType, ModelEstimator>::runPreemptively(
+	const cv::Mat &points_,
+	const ModelEstimator &estimator_,
+	gcransac::sampler::Sampler<cv::Mat, size_t> &sampler_,
+	const std::vector<size_t> &pool_,
+	const std::chrono::time_point<std::chrono::system_clock> &start_,
+	gcransac::Model &best_model_,
+	ModelScore &best_score_,
+	int &iteration_,
+	RunContext &context_) const
+{
+	MAGSAC_TRACE_SPAN(tracer, "runPreemptively");
+	constexpr size_t max_unsuccessful_model_generations = 50;
+	const size_t point_number = points_.rows;
+	// The MAGSAC++ loss function used for ranking the models
+	const PlusPlusLoss loss_function(maximum_threshold);
+
+	// Generate the models to be evaluated. The number of the sampling attempts is bounded
+	// so the run-time is bounded even if the models cannot be estimated from most samples.
+	std::vector<gcransac::Model> &hypotheses = context_.preemptive_hypotheses;
+	std::vector<gcransac::Model> &models = context_.minimal_models;
+	const size_t batch_size = magsac::solver::HasBatchEstimation<ModelEstimator>::value ? sample_batch_size : 1;
+	hypotheses.clear();
+	size_t model_generations = 0;
+	while (hypotheses.size() < preemptive_hypothesis_number &&
+		model_generations < preemptive_hypothesis_number * max_unsuccessful_model_generations)
 	{
-		// Increase the current iteration number
-		++iteration;
-				
-		// Sample a minimal subset
-		std::vector<gcransac::Model> models; // The set of estimated models
-		size_t unsuccessful_model_generations = 0; // The number of unsuccessful model generations
-		// Try to select a minimal sample and estimate the implied model parameters
-		while (++unsuccessful_model_generations < max_unsuccessful_model_generations)
+		// No model is refined yet, thus, a cancelled run returns none
+		if (isCancelled(context_))
 		{
-			// Get a minimal sample randomly
-			if (!sampler_.sample(pool, // The index pool from which the minimal sample can be selected
-				minimal_sample.get(), // The minimal sample
-				sample_size)) // The size of a minimal sample
-				continue;
+			context_.statistics.is_cancelled = true;
+			iteration_ += static_cast<int>(model_generations);
+			return;
+		}
 
-			// Check if the selected sample is valid before estimating the model
-			// parameters which usually takes more time. 
-			if (!estimator_.isValidSample(points_, // All points
-				minimal_sample.get())) // The current sample
-				continue;
+		// If the time limit is exceeded, continue with the models generated so far
+		if (!hypotheses.empty() &&
+			isTimeLimitExceeded(start_))
+		{
+			context_.statistics.is_time_limit_reached = true;
+			break;
+		}
 
-			// Estimate the model from the minimal sample
- 			if (estimator_.estimateModel(points_, // All data points
-				minimal_sample.get(), // The selected minimal sample
-				&models)) // The estimated models
-				break; 
-		}         
+		size_t model_number;
+		if (batch_size > 1)
+			model_generations += sampleModelBatch(points_,
+				estimator_,
+				sampler_,
+				pool_,
+				MIN(batch_size, preemptive_hypothesis_number - hypotheses.size()),
+				model_number,
+				context_);
+		else
+		{
+			models.clear();
+			model_generations += sampleModels(points_,
+				estimator_,
+				sampler_,
+				pool_,
+				models,
+				context_);
+			model_number = models.size();
+		}
 
-		// If the method was not able to generate any usable models, break the cycle.
-		iteration += unsuccessful_model_generations - 1;
+		for (size_t model_idx = 0; model_idx < model_number; ++model_idx)
+			if (hypotheses.size() < preemptive_hypothesis_number)
+				hypotheses.emplace_back(std::move(models[model_idx]));
+	}
+	// The iterations done before, e.g., on the subsample in the coarse-to-fine mode, are kept
+	iteration_ += static_cast<int>(model_generations);
+
+	const size_t hypothesis_number = hypotheses.size();
+	if (hypothesis_number == 0)
+		return;
+
+	// The accumulated losses of the models and the indices of the models still evaluated
+	std::vector<double> &losses = context_.preemptive_losses;
+	std::vector<size_t> &survivors = context_.preemptive_survivors;
+	losses.assign(hypothesis_number, 0.0);
+	survivors.resize(hypothesis_number);
+	for (size_t hypothesis_idx = 0; hypothesis_idx < hypothesis_number; ++hypothesis_idx)
+		survivors[hypothesis_idx] = hypothesis_idx;
+
+	// The points are evaluated in a random order which is determined block-by-block.
+	// The order depends only on the number of points, thus, the results are reproducible 
+	// with a deterministic sampler.
+	std::vector<size_t> &point_order = context_.preemptive_point_order;
+	point_order.resize(point_number);
+	for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
+		point_order[point_idx] = point_idx;
+	magsac::utils::FastRandomGenerator random_generator(point_number);
+
+	const size_t refined_number = MAX(1, preemptive_refined_hypothesis_number);
+	size_t survivor_number = hypothesis_number;
+	size_t evaluated_point_number = 0;
+	const auto loss_comparator = [&losses](const size_t left_, const size_t right_) { return losses[left_] < losses[right_]; };
+
+	// Evaluate the models on the blocks of points and drop the worst ones after each block
+	while (survivor_number > refined_number &&
+		evaluated_point_number < point_number &&
+		!context_.statistics.is_time_limit_reached)
+	{
+		if (isCancelled(context_))
+		{
+			context_.statistics.is_cancelled = true;
+			return;
+		}
 
-		// Select the so-far-the-best from the estimated models
-		for (const auto &model : models)
+		// If the time limit is exceeded, the models are ranked by their losses on the blocks evaluated so far
+		if (isTimeLimitExceeded(start_))
 		{
-			ModelScore score; // The score of the current model
-			gcransac::Model refined_model; // The refined model parameters
-
-			// Apply sigma-consensus to refine the model parameters by marginalizing over the noise level sigma
-			bool success;
-			if (magsac_version == Version::MAGSAC_ORIGINAL)
-				success = sigmaConsensus(points_,
-					model,
-					refined_model,
-					score,
-					estimator_,
-					so_far_the_best_score);
-			else
-				success = sigmaConsensusPlusPlus(points_,
-					model,
-					refined_model,
-					score,
-					estimator_,
-					so_far_the_best_score);
+			context_.statistics.is_time_limit_reached = true;
+			break;
+		}
 
-			// Continue if the model was rejected
-			if (!success || score.score == -1)
-				continue;
+		const size_t block_end = MIN(evaluated_point_number + preemptive_block_size, point_number);
 
-			// Save the iteration number when the current model is found
-			score.iteration = iteration;
-						
-			// Update the best model parameters if needed
-			if (so_far_the_best_score < score)
+		// Select the points of the current block randomly from the ones not evaluated yet
+		for (size_t position = evaluated_point_number; position < block_end; ++position)
+			std::swap(point_order[position],
+				point_order[position + random_generator.bounded(point_number - position)]);
+
+		// Add the losses implied by the points of the block
+		for (size_t survivor_idx = 0; survivor_idx < survivor_number; ++survivor_idx)
+		{
+			const size_t hypothesis_idx = survivors[survivor_idx];
+			const gcransac::Model &hypothesis = hypotheses[hypothesis_idx];
+			double loss = 0.0;
+			for (size_t position = evaluated_point_number; position < block_end; ++position)
 			{
-				so_far_the_best_model = refined_model; // Update the best model parameters
-				so_far_the_best_score = score; // Update the best model's score
-				max_iteration = MIN(max_iteration, last_iteration_number); // Update the max iteration number, but do not allow to increase
+				const size_t point_idx = point_order[position];
+				const double point_loss = loss_function(
+					estimator_.residualForScoring(points_.row(point_idx), hypothesis));
+				loss += context_.multiplicities == nullptr ?
+					point_loss : context_.multiplicities[point_idx] * point_loss;
 			}
+			losses[hypothesis_idx] += loss;
 		}
+		evaluated_point_number = block_end;
 
-		// Update the time parameters if a time limit is set
-		if (desired_fps > -1)
+		// Keep the best models
+		const size_t kept_number = MAX(refined_number,
+			static_cast<size_t>(std::ceil(survivor_number * preemptive_keep_ratio)));
+		if (kept_number < survivor_number)
 		{
-			end = std::chrono::system_clock::now();
-			elapsed_seconds = end - start;
-
-			// Interrupt if the time limit is exceeded
-			if (elapsed_seconds.count() > time_limit)
-				break;
+			std::nth_element(survivors.begin(), 
+				survivors.begin() + kept_number, 
+				survivors.begin() + survivor_number, 
+				loss_comparator);
+			context_.statistics.pruned_model_number += survivor_number - kept_number;
+			survivor_number = kept_number;
 		}
 	}
-	
-	// Apply sigma-consensus as a post processing step if needed and the estimated model is valid
-	if (apply_post_processing)
+
+	// Refine the best models by sigma-consensus++ starting from the one with the lowest loss.
+	// If the time limit has been exceeded, only the first one is refined.
+	std::sort(survivors.begin(), survivors.begin() + survivor_number, loss_comparator);
+	for (size_t survivor_idx = 0; survivor_idx < MIN(survivor_number, refined_number); ++survivor_idx)
 	{
-		// TODO
-	}
-	
-	obtained_model_ = so_far_the_best_model;
-	iteration_number_ = iteration;
-	model_score_ = so_far_the_best_score;
+		// Keep the models refined so far if the run is cancelled
+		if (best_score_.score > 0 &&
+			isCancelled(context_))
+		{
+			context_.statistics.is_cancelled = true;
+			break;
+		}
 
-	return so_far_the_best_score.score > 0;
+		if (survivor_idx > 0 &&
+			(context_.statistics.is_time_limit_reached || isTimeLimitExceeded(start_)))
+		{
+			context_.statistics.is_time_limit_reached = true;
+			break;
+		}
+
+		if (refineAndUpdateBest(points_,
+			hypotheses[survivors[survivor_idx]],
+			estimator_,
+			iteration_,
+			best_model_,
+			best_score_,
+			context_))
+			// No more samples are drawn, thus, the iterations done are the maximum
+			reportBestModel(best_model_, best_score_, iteration_, iteration_, context_);
+	}
 }
 
 template <class DatumType, class ModelEstimator>
@@ -334,7 +2222,7 @@ bool MAGSAC<DatumType, ModelEstimator>::postProcessing(
 	const gcransac::Model &model_,
 	gcransac::Model &refined_model_,
 	ModelScore &refined_score_,
-	const ModelEstimator &estimator_)
+	const ModelEstimator &estimator_) const
 {
 	fprintf(stderr, "Sigma-consensus++ is not implemented yet as post-processing.\n");
 	return false;
@@ -348,19 +2236,22 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensus(
 	gcransac::Model& refined_model_,
 	ModelScore &score_,
 	const ModelEstimator &estimator_,
-	const ModelScore &best_score_)
+	const ModelScore &best_score_,
+	RunContext &context_) const
 {
+	MAGSAC_TRACE_SPAN(tracer, "sigmaConsensus");
 	// Set up the parameters
 	constexpr double L = 1.05;
 	constexpr double k = ModelEstimator::getSigmaQuantile();
 	constexpr double threshold_to_sigma_multiplier = 1.0 / k;
 	constexpr size_t sample_size = estimator_.sampleSize();
-	static auto comparator = [](std::pair<double, int> left, std::pair<double, int> right) { return left.first < right.first; };
+	const auto comparator = [](std::pair<double, int> left, std::pair<double, int> right) { return left.first < right.first; };
 	const int point_number = points_.rows;
 	double current_maximum_sigma = this->maximum_threshold;
 
 	// Calculating the residuals
-	std::vector< std::pair<double, size_t> > all_residuals;
+	std::vector< std::pair<double, size_t> > &all_residuals = context_.consensus_residuals;
+	all_residuals.clear();
 	all_residuals.reserve(point_number);
 
 	// If it is not the first run, consider the previous best and interrupt the validation when there is no chance of being better
@@ -420,13 +2311,22 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensus(
 		score_.inlier_number = points_close;
 	}
 
-	std::vector<gcransac::Model> sigma_models;
-	std::vector<size_t> sigma_inliers;
-	std::vector<double> final_weights;
+	// The buffers of the weighted least-squares fitting are kept in the context to avoid reallocating them.
+	// The solvers append newly allocated models, thus, only the capacity of the model vector is kept.
+	std::vector<gcransac::Model> &sigma_models = context_.consensus_models;
+	sigma_models.clear();
+	std::vector<size_t> &sigma_inliers = context_.consensus_inliers;
+	sigma_inliers.clear();
+	std::vector<double> &final_weights = context_.consensus_weights;
+	final_weights.clear();
 	
 	// The number of possible inliers
 	const size_t possible_inlier_number = all_residuals.size();
 
+	// If there are fewer possible inliers than the size of the minimal sample interupt the procedure
+	if (possible_inlier_number < sample_size)
+		return false;
+
 	// Sort the residuals in ascending order
 	std::sort(all_residuals.begin(), all_residuals.end(), comparator);
 
@@ -437,18 +2337,44 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensus(
 
 	const double sigma_step = current_maximum_sigma / partition_number;
 
-	last_iteration_number = 10000;
+	context_.last_iteration_number = 10000;
 
 	score_.score = 0;
 
-	// The weights calculated by each parallel process
-	std::vector<std::vector<double>> point_weights_par(partition_number, std::vector<double>(possible_inlier_number, 0));
+	// Store the point indices in the order of their residuals. Since the points closer than
+	// the maximum sigma of a partition form a prefix of this array, it is passed directly to
+	// the non-minimal estimation without copying the indices for each partition.
+	std::vector<size_t> &sorted_point_indices = context_.sorted_point_indices;
+	sorted_point_indices.resize(possible_inlier_number);
+	for (size_t relative_point_idx = 0; relative_point_idx < possible_inlier_number; ++relative_point_idx)
+		sorted_point_indices[relative_point_idx] = all_residuals[relative_point_idx].second;
+
+	// The number of threads accumulating the weights. Each thread has its own row in the flat 
+	// weight buffer so the threads never write the same cache line and no synchronization is needed.
+#ifdef USE_OPENMP
+	const size_t thread_number = MAX(1, MIN(core_number, partition_number));
+#else
+	const size_t thread_number = 1;
+#endif
+	// The length of a row padded to the cache line size
+	const size_t row_length = magsac::utils::paddedRowLength(possible_inlier_number);
+	magsac::utils::AlignedVector<double> &partition_weights = context_.partition_weights;
+	magsac::utils::AlignedVector<double> &partition_squared_residuals = context_.partition_squared_residuals;
+	partition_weights.assign(thread_number * row_length, 0.0);
+	partition_squared_residuals.resize(thread_number * row_length);
 
 	// If OpenMP is used, calculate things in parallel
 #ifdef USE_OPENMP
-#pragma omp parallel for num_threads(core_number)
+#pragma omp parallel for num_threads(thread_number)
+#endif
 	for (int partition_idx = 0; partition_idx < partition_number; ++partition_idx)
 	{
+		// The index of the thread processing the current partition
+#ifdef USE_OPENMP
+		const size_t thread_idx = omp_get_thread_num();
+#else
+		const size_t thread_idx = 0;
+#endif
 		// The maximum sigma value in the current partition
 		const double max_sigma = (partition_idx + 1) * sigma_step;
 
@@ -457,21 +2383,13 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensus(
 		const auto &last_element = std::upper_bound(all_residuals.begin(), all_residuals.end(), std::make_pair(max_sigma, 0), comparator);
 		const size_t sigma_inlier_number = last_element - all_residuals.begin();
 
-		// Put the indices into a vector
-		std::vector<size_t> sigma_inliers;
-		sigma_inliers.reserve(sigma_inlier_number);
-
-		// Store the points which are closer than the current sigma limit
-		for (size_t relative_point_idx = 0; relative_point_idx < sigma_inlier_number; ++relative_point_idx)
-			sigma_inliers.emplace_back(all_residuals[relative_point_idx].second);
-
 		// Check if there are enough inliers to fit a model
-		if (sigma_inliers.size() > sample_size)
+		if (sigma_inlier_number > sample_size)
 		{
 			// Estimating the model which the current set of inliers imply
 			std::vector<gcransac::Model> sigma_models;
 			estimator_.estimateModelNonminimal(points_,
-				&(sigma_inliers)[0],
+				&sorted_point_indices[0],
 				sigma_inlier_number,
 				&sigma_models);
 
@@ -479,54 +2397,61 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensus(
 			if (sigma_models.size() == 1)
 			{
 				const double max_sigma_squared_2 = 2 * max_sigma * max_sigma;
-				double residual_i_2, // The residual of the i-th point
-					probability_i; // The probability of the i-th point
-
-				// Iterate through all points to estimate the related probabilities
-				for (size_t relative_point_idx = 0; relative_point_idx < sigma_inliers.size(); ++relative_point_idx)
-				{
-					// TODO: Replace with Chi-square instead of normal distribution
-					const size_t &point_idx = sigma_inliers[relative_point_idx];
+				// The rows of the current thread in the flat buffers
+				double * const squared_residuals = &partition_squared_residuals[thread_idx * row_length];
+				double * const weights = &partition_weights[thread_idx * row_length];
 
-					// Calculate the residual of the current point
-					residual_i_2 = estimator_.squaredResidual(points_.row(point_idx),
+				// Calculate the residuals of the points w.r.t. the model of the current partition
+				for (size_t relative_point_idx = 0; relative_point_idx < sigma_inlier_number; ++relative_point_idx)
+					squared_residuals[relative_point_idx] = estimator_.squaredResidual(points_.row(sorted_point_indices[relative_point_idx]),
 						sigma_models[0]);
 
-					// Calculate the probability of the i-th point assuming Gaussian distribution
-					// TODO: replace by Chi-square distribution
-					probability_i = exp(-residual_i_2 / max_sigma_squared_2);
-
-					// Store the probability of the i-th point coming from the current partition
-					point_weights_par[partition_idx][relative_point_idx] += probability_i;
-
-
-				}
+				// Calculate the probability of each point assuming Gaussian distribution and add
+				// it to the weights accumulated by the current thread.
+				// TODO: replace by Chi-square distribution
+				magsac::utils::accumulateGaussianWeights(squared_residuals,
+					sigma_inlier_number,
+					1.0 / max_sigma_squared_2,
+					weights);
 			}
 		}
 	}
-#else
-	fprintf(stderr, "Not implemented yet.\n");
-#endif
 
 	// The weights used for the final weighted least-squares fitting
 	final_weights.reserve(possible_inlier_number);
 
+	// Keep the data of the fitting if the per-point data of the run has to be returned
+	RunOutput &fit_data = context_.fit_data;
+	if (context_.collect_fit_data)
+	{
+		fit_data.point_indices.clear();
+		fit_data.residuals.clear();
+		fit_data.weights.clear();
+	}
+
 	// Collect all points which has higher probability of being inlier than zero
 	sigma_inliers.reserve(possible_inlier_number);
 	for (size_t point_idx = 0; point_idx < possible_inlier_number; ++point_idx)
 	{
-		// Calculate the weight of the current point
+		// Calculate the weight of the current point by reducing the rows of the threads
 		double weight = 0.0;
-		for (size_t partition_idx = 0; partition_idx < partition_number; ++partition_idx)
-			weight += point_weights_par[partition_idx][point_idx];
+		for (size_t thread_idx = 0; thread_idx < thread_number; ++thread_idx)
+			weight += partition_weights[thread_idx * row_length + point_idx];
 
 		// If the weight is approx. zero, continue.
 		if (weight < std::numeric_limits<double>::epsilon())
 			continue;
 
 		// Store the index and weight of the current point
-		sigma_inliers.emplace_back(all_residuals[point_idx].second);
+		sigma_inliers.emplace_back(sorted_point_indices[point_idx]);
 		final_weights.emplace_back(weight);
+
+		if (context_.collect_fit_data)
+		{
+			fit_data.point_indices.emplace_back(sorted_point_indices[point_idx]);
+			fit_data.residuals.emplace_back(all_residuals[point_idx].first);
+			fit_data.weights.emplace_back(weight);
+		}
 	}
 
 	// If there are fewer inliers than the size of the minimal sample interupt the procedure
@@ -543,32 +2468,80 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensus(
 		return false;
 
 	bool is_model_updated = false;
+
+	// The refined model is recognized by the possible inliers it has been fitted to
+	uint64_t model_key = 0;
+	if (refined_model_cache_size > 0)
+		model_key = magsac::utils::fingerprintIndexSet(&sigma_inliers[0], sigma_inliers.size());
+
+	// If the validity check is deferred, keep the inliers for the check
+	if (lazy_validity_check)
+		context_.candidate_inliers.swap(sigma_inliers);
+
+	if (sigma_models.size() != 1)
+		return false;
+
+	// If the same model has already been obtained and it cannot be better than the
+	// so-far-the-best one, use the stored score instead of checking and scoring it again.
+	++context_.statistics.refined_model_number;
+	if (refined_model_cache_size > 0)
+	{
+		const auto *entry = findRefinedModel(model_key, context_);
+		if (entry != nullptr &&
+			(!entry->is_valid || entry->score <= best_score_.score))
+		{
+			++context_.statistics.refined_model_cache_hits;
+			if (!entry->is_valid)
+			{
+				++context_.statistics.invalid_model_number;
+				return false;
+			}
+			refined_model_.descriptor.swap(sigma_models.back().descriptor);
+			score_.score = entry->score;
+			context_.last_iteration_number = entry->iteration_number;
+			return true;
+		}
+	}
 	
-	if (sigma_models.size() == 1 && // If only a single model is estimated
-		estimator_.isValidModel(sigma_models.back(),
+	bool is_valid = lazy_validity_check; // The model is considered valid if the validity is checked later
+	if (!is_valid)
+	{
+		MAGSAC_TRACE_SPAN(tracer, "isValidModel");
+		is_valid = estimator_.isValidModel(sigma_models.back(),
 			points_,
 			sigma_inliers,
 			&(sigma_inliers)[0],
 			interrupting_threshold,
-			is_model_updated)) // and it is valid
+			is_model_updated);
+	}
+
+	if (is_valid)
 	{
 		// Return the refined model
-		refined_model_ = sigma_models.back();
+		refined_model_.descriptor.swap(sigma_models.back().descriptor);
 
 		// Calculate the score of the model and the implied iteration number
 		double marginalized_iteration_number;
 		getModelQuality(points_, // All the input points
 			refined_model_, // The estimated model
 			estimator_, // The estimator
+			context_.log_confidence, // The logarithm of 1 - the required confidence
 			marginalized_iteration_number, // The marginalized inlier ratio
 			score_.score); // The marginalized score
 
 		if (marginalized_iteration_number < 0 || std::isnan(marginalized_iteration_number))
-			last_iteration_number = std::numeric_limits<int>::max();
+			context_.last_iteration_number = std::numeric_limits<int>::max();
 		else
-			last_iteration_number = static_cast<int>(round(marginalized_iteration_number));
+			context_.last_iteration_number = static_cast<int>(round(marginalized_iteration_number));
+
+		if (refined_model_cache_size > 0)
+			storeRefinedModel(model_key, score_.score, true, context_);
 		return true;
 	}
+
+	++context_.statistics.invalid_model_number;
+	if (refined_model_cache_size > 0)
+		storeRefinedModel(model_key, 0.0, false, context_);
 	return false;
 }
 
@@ -579,8 +2552,10 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
 	gcransac::Model& refined_model_,
 	ModelScore &score_,
 	const ModelEstimator &estimator_,
-	const ModelScore &best_score_)
+	const ModelScore &best_score_,
+	RunContext &context_) const
 {
+	MAGSAC_TRACE_SPAN(tracer, "sigmaConsensusPlusPlus");
 	// The degrees of freedom of the data from which the model is estimated.
 	// E.g., for models coming from point correspondences (x1,y1,x2,y2), it is 4.
 	constexpr size_t degrees_of_freedom = ModelEstimator::getDegreesOfFreedom();
@@ -600,24 +2575,25 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
 	constexpr size_t sample_size = estimator_.sampleSize();
 	// Calculating 2^(DoF - 1) which will be used for the estimation and, 
 	// due to being constant, it is better to calculate it a priori.
-	static const double two_ad_dof = std::pow(2.0, dof_minus_one_per_two);
+	const double two_ad_dof = std::pow(2.0, dof_minus_one_per_two);
 	// Calculating C * 2^(DoF - 1) which will be used for the estimation and, 
 	// due to being constant, it is better to calculate it a priori.
-	static const double C_times_two_ad_dof = C * two_ad_dof;
+	const double C_times_two_ad_dof = C * two_ad_dof;
 	// Calculating the gamma value of (DoF - 1) / 2 which will be used for the estimation and, 
 	// due to being constant, it is better to calculate it a priori.
-	static const double gamma_value = tgamma(dof_minus_one_per_two);
+	const double gamma_value = tgamma(dof_minus_one_per_two);
 	// Calculating the upper incomplete gamma value of (DoF - 1) / 2 with k^2 / 2.
 	constexpr double gamma_k = ModelEstimator::getUpperIncompleteGammaOfK();
 	// Calculating the lower incomplete gamma value of (DoF - 1) / 2 which will be used for the estimation and, 
 	// due to being constant, it is better to calculate it a priori.
-	static const double gamma_difference = gamma_value - gamma_k;
+	const double gamma_difference = gamma_value - gamma_k;
 	// The number of points provided
 	const int point_number = points_.rows;
 	// The manually set maximum inlier-outlier threshold
 	double current_maximum_sigma = this->maximum_threshold;
-	// Calculating the pairs of (residual, point index).
-	std::vector< std::pair<double, size_t> > residuals;
+	// Calculating the pairs of (residual, point index). The buffer is kept between the calls.
+	std::vector< std::pair<double, size_t> > &residuals = context_.consensus_residuals;
+	residuals.clear();
 	// Occupy the maximum required memory to avoid doing it later.
 	residuals.reserve(point_number);
 
@@ -680,12 +2656,16 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
 		score_.inlier_number = points_close;
 	}
 
-	// Models fit by weighted least-squares fitting
-	std::vector<gcransac::Model> sigma_models;
+	// Models fit by weighted least-squares fitting. The solvers append newly allocated models, 
+	// thus, only the capacity of the vector is kept between the calls.
+	std::vector<gcransac::Model> &sigma_models = context_.consensus_models;
+	sigma_models.clear();
 	// Points used in the weighted least-squares fitting
-	std::vector<size_t> sigma_inliers;
+	std::vector<size_t> &sigma_inliers = context_.consensus_inliers;
+	sigma_inliers.clear();
 	// Weights used in the the weighted least-squares fitting
-	std::vector<double> sigma_weights;
+	std::vector<double> &sigma_weights = context_.consensus_weights;
+	sigma_weights.clear();
 	// Number of points considered in the fitting
 	const size_t possible_inlier_number = residuals.size();
 	// Occupy the memory to avoid doing it inside the calculation possibly multiple times
@@ -700,14 +2680,21 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
 	// Calculate the weight of a point with 0 residual (i.e., fitting perfectly) a priori
 	const double weight_zero = one_over_sigma * gamma_difference;
 
-	// Initialize the polished model with the initial one
-	gcransac::Model polished_model = model_;
+	// The polished model. It is set by the first fitting before it is used, thus, the initial model does
+	// not have to be copied. The buffer is kept in the context to avoid reallocating its descriptor.
+	gcransac::Model &polished_model = context_.polished_model;
 	// A flag to determine if the initial model has been updated
 	bool updated = false;
 
 	// Do the iteratively re-weighted least squares fitting
 	for (size_t iterations = 0; iterations < number_of_irwls_iters; ++iterations)
 	{
+		MAGSAC_TRACE_SPAN_VALUE(tracer, "irlsIteration", "iteration", iterations);
+		// Keep the model of the previous iteration if the run is cancelled
+		if (iterations > 0 &&
+			isCancelled(context_))
+			break;
+
 		// If the current iteration is not the first, the set of possibly inliers 
 		// (i.e., points closer than the maximum threshold) have to be recalculated. 
 		if (iterations > 0)
@@ -759,6 +2746,8 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
       size_t idx = std::get<1>(residualAndIdx);
 			// The weight
 			double weight = 0.0;
+			// Put the index of the point into the vector of points used for the least squares fitting
+			sigma_inliers.emplace_back(idx);
 			// If the residual is ~0, the point fits perfectly and it is handled differently
 			if (residual < std::numeric_limits<double>::epsilon())
 				weight = weight_zero;
@@ -768,8 +2757,6 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
 				const double squared_residual = residual * residual;
 				// Get the position of the gamma value in the lookup table
 				size_t x = round(precision_of_stored_gammas * squared_residual / squared_sigma_max_2);
-				// Put the index of the point into the vector of points used for the least squares fitting
-				sigma_inliers.emplace_back(idx);
 
 				// If the sought gamma value is not stored in the lookup, return the closest element
 				if (stored_gamma_number < x)
@@ -779,6 +2766,10 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
 				weight = one_over_sigma * (stored_gamma_values[x] - gamma_k);
 			}
 
+			// A merged point counts as many times as the number of points it stands for
+			if (context_.multiplicities != nullptr)
+				weight *= context_.multiplicities[idx];
+
 			// Store the weight of the point 
 			sigma_weights.emplace_back(weight);
 		}
@@ -805,9 +2796,10 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
 			break;
 		}
 
-		// Update the model parameters
-		polished_model = sigma_models[0];
-		// Clear the vector of models and keep only the best
+		// Update the model parameters. The swap moves the new parameters without copying them. 
+		// The previous parameters are released when the vector is cleared for the next fitting
+		// since the solver allocates the next model anyway.
+		polished_model.descriptor.swap(sigma_models[0].descriptor);
 		sigma_models.clear();
 		// The model has been updated
 		updated = true;
@@ -815,16 +2807,92 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
 
 	bool is_model_updated = false;
 
-	if (updated && // If the model has been updated
-		estimator_.isValidModel(polished_model,
+	// Keep the data of the last fitting if the per-point data of the run has to be returned
+	if (updated &&
+		context_.collect_fit_data)
+	{
+		RunOutput &fit_data = context_.fit_data;
+		fit_data.point_indices.clear();
+		fit_data.residuals.clear();
+		fit_data.weights.clear();
+		for (size_t position = 0; position < residuals.size(); ++position)
+		{
+			const size_t point_idx = residuals[position].second;
+			fit_data.point_indices.emplace_back(point_idx);
+			fit_data.residuals.emplace_back(residuals[position].first);
+			fit_data.weights.emplace_back(context_.multiplicities == nullptr ?
+				sigma_weights[position] : sigma_weights[position] / context_.multiplicities[point_idx]);
+		}
+	}
+
+	// The refined model is recognized by the possible inliers it has been fitted to last
+	uint64_t model_key = 0;
+	if (updated && refined_model_cache_size > 0)
+		model_key = magsac::utils::fingerprintIndexSet(&sigma_inliers[0], sigma_inliers.size());
+
+	// If the validity check is deferred, keep the inliers for the check
+	if (lazy_validity_check)
+		context_.candidate_inliers.swap(sigma_inliers);
+
+	if (!updated)
+		return false;
+
+	// If the same model has already been obtained and it cannot be better than the
+	// so-far-the-best one, use the stored score instead of checking and scoring it again.
+	++context_.statistics.refined_model_number;
+	if (refined_model_cache_size > 0)
+	{
+		const auto *entry = findRefinedModel(model_key, context_);
+		if (entry != nullptr &&
+			(!entry->is_valid || entry->score <= best_score_.score))
+		{
+			++context_.statistics.refined_model_cache_hits;
+			if (!entry->is_valid)
+			{
+				++context_.statistics.invalid_model_number;
+				return false;
+			}
+			refined_model_.descriptor.swap(polished_model.descriptor);
+			score_.score = entry->score;
+			context_.last_iteration_number = entry->iteration_number;
+			return true;
+		}
+	}
+
+	bool is_valid = lazy_validity_check; // The model is considered valid if the validity is checked later
+	if (!is_valid)
+	{
+		MAGSAC_TRACE_SPAN(tracer, "isValidModel");
+		is_valid = estimator_.isValidModel(polished_model,
 			points_,
 			sigma_inliers,
 			&(sigma_inliers[0]),
 			interrupting_threshold,
-			is_model_updated)) // and it is valid
+			is_model_updated);
+	}
+
+	if (is_valid)
 	{
+		// If the set of points is large, score the refined model on the subset of the points first and
+		// drop it, before it is scored on all points, if it cannot be better than the so-far-the-best 
+		// model with the required confidence.
+		if (!context_.scoring_subset.empty() &&
+			best_score_.score > 0)
+		{
+			double estimated_score;
+			++context_.statistics.subset_scored_model_number;
+			if (!isPromisingOnSubset(points_,
+				polished_model,
+				estimator_,
+				best_score_,
+				estimated_score,
+				context_))
+				return false;
+			++context_.statistics.promoted_model_number;
+		}
+
 		// Return the refined model
-		refined_model_ = polished_model;
+		refined_model_.descriptor.swap(polished_model.descriptor);
 
 		// Calculate the score of the model and the implied iteration number
 		double marginalized_iteration_number;
@@ -832,106 +2900,327 @@ bool MAGSAC<DatumType, ModelEstimator>::sigmaConsensusPlusPlus(
 			refined_model_, // The estimated model
 			estimator_, // The estimator
 			score_.score, // The marginalized score
-			best_score_.score); // The score of the previous so-far-the-best model
+			best_score_.score, // The score of the previous so-far-the-best model
+			context_.multiplicities); // The multiplicities of the points if they are merged
 			
 		// Update the iteration number
-		last_iteration_number =
-			log_confidence / log(1.0 - std::pow(static_cast<double>(score_.inlier_number) / point_number, sample_size));
+		context_.last_iteration_number =
+			context_.log_confidence / log(1.0 - std::pow(static_cast<double>(score_.inlier_number) / point_number, sample_size));
+
+		if (refined_model_cache_size > 0)
+			storeRefinedModel(model_key, score_.score, true, context_);
 		return true;
 	}
+
+	++context_.statistics.invalid_model_number;
+	if (refined_model_cache_size > 0)
+		storeRefinedModel(model_key, 0.0, false, context_);
 	return false;
 }
 
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::checkValidityLazily(
+	const cv::Mat &points_,
+	gcransac::Model &model_,
+	ModelScore &score_,
+	const ModelEstimator &estimator_,
+	const ModelScore &best_score_,
+	RunContext &context_) const
+{
+	typedef typename RunContext::ValidityVerdict ValidityVerdict;
+	std::vector<ValidityVerdict> &validity_cache = context_.validity_cache;
+	std::vector<size_t> &candidate_inliers = context_.candidate_inliers;
+
+	// Look up the verdict if a model fitted to the same possible inliers has already been checked.
+	// Models with different inliers never share a verdict or the parameters updated by the check.
+	const uint64_t model_key = magsac::utils::fingerprintIndexSet(candidate_inliers.data(), candidate_inliers.size());
+	const ValidityVerdict *verdict = nullptr;
+	for (const auto &cached_verdict : validity_cache)
+		if (cached_verdict.key == model_key)
+		{
+			verdict = &cached_verdict;
+			break;
+		}
+
+	// If the model has not been checked yet, apply the validity check and store the verdict
+	if (verdict == nullptr)
+	{
+		// Store the verdict replacing the oldest one if the cache is full. The verdict is written
+		// in place so the updated model of a replaced verdict is overwritten without reallocating it.
+		if (validity_cache.size() < validity_cache_size)
+			validity_cache.emplace_back();
+		ValidityVerdict &new_verdict = validity_cache[context_.validity_cache_position];
+		context_.validity_cache_position = (context_.validity_cache_position + 1) % validity_cache_size;
+
+		new_verdict.key = model_key;
+		new_verdict.is_updated = false;
+		MAGSAC_TRACE_SPAN(tracer, "isValidModel");
+		new_verdict.is_valid = !candidate_inliers.empty() &&
+			estimator_.isValidModel(model_, // The model to be checked. It might be updated by the check.
+				points_, // All data points
+				candidate_inliers, // The possible inliers of the model
+				&(candidate_inliers[0]), // The sample used in the check
+				interrupting_threshold, // The inlier-outlier threshold
+				new_verdict.is_updated); // A flag saying if the model has been updated
+		if (new_verdict.is_updated)
+			new_verdict.updated_model = model_;
+		verdict = &new_verdict;
+	}
+	// If the model has been updated by a previous check, use the updated parameters
+	else if (verdict->is_valid && verdict->is_updated)
+		model_ = verdict->updated_model;
+
+	if (!verdict->is_valid)
+	{
+		++context_.statistics.invalid_model_number;
+		return false;
+	}
+
+	// If the model has not been changed by the check, its score is still correct
+	if (!verdict->is_updated)
+		return true;
+
+	// Otherwise, the updated model has to be re-scored and the iteration number it implies has
+	// to be recalculated from its own inliers
+	size_t inlier_number = 0;
+	for (int point_idx = 0; point_idx < points_.rows; ++point_idx)
+		if (estimator_.residual(points_.row(point_idx), model_) < interrupting_threshold)
+			++inlier_number;
+	score_.inlier_number = inlier_number;
+
+	if (magsac_version == Version::MAGSAC_ORIGINAL)
+	{
+		double marginalized_iteration_number;
+		getModelQuality(points_, // All the input points
+			model_, // The updated model
+			estimator_, // The estimator
+			context_.log_confidence, // The logarithm of 1 - the required confidence
+			marginalized_iteration_number, // The marginalized inlier ratio
+			score_.score); // The marginalized score
+
+		if (marginalized_iteration_number < 0 || std::isnan(marginalized_iteration_number))
+			context_.last_iteration_number = std::numeric_limits<int>::max();
+		else
+			context_.last_iteration_number = static_cast<int>(round(marginalized_iteration_number));
+	}
+	else
+	{
+		getModelQualityPlusPlus(points_, // All the input points
+			model_, // The updated model
+			estimator_, // The estimator
+			score_.score, // The marginalized score
+			best_score_.score, // The score of the previous so-far-the-best model
+			context_.multiplicities); // The multiplicities of the points if they are merged
+
+		context_.last_iteration_number =
+			context_.log_confidence / log(1.0 - std::pow(static_cast<double>(inlier_number) / points_.rows, ModelEstimator::sampleSize()));
+	}
+
+	// The updated model still has to be better than the so-far-the-best one
+	return best_score_.score < score_.score;
+}
+
+template <class DatumType, class ModelEstimator>
+bool MAGSAC<DatumType, ModelEstimator>::isPromisingOnSubset(
+	const cv::Mat &points_, // All data points
+	const gcransac::Model &model_, // The model to be scored
+	const ModelEstimator &estimator_, // The model estimator
+	const ModelScore &best_score_, // The score of the so-far-the-best model
+	double &estimated_score_, // The score estimated from the subset
+	RunContext &context_) const
+{
+	MAGSAC_TRACE_SPAN(tracer, "scoreModelOnSubset");
+	// The MAGSAC++ loss function
+	const PlusPlusLoss loss_function(maximum_threshold);
+	const std::vector<size_t> &subset = context_.scoring_subset;
+	const size_t subset_size = subset.size();
+	// The number of input points. If the points are merged, the subset is selected proportionally 
+	// to the multiplicities, thus, each selected point stands for a single input point.
+	const double point_number = context_.represented_point_number;
+
+	// Calculate the average loss on the subset
+	double subset_loss = 0.0;
+	for (const size_t point_idx : subset)
+		subset_loss += loss_function(
+			estimator_.residualForScoring(points_.row(point_idx), model_));
+	const double average_loss = subset_loss / subset_size;
+
+	// The score implied by the average loss if it held for all points
+	estimated_score_ = 1.0 / (average_loss * point_number);
+
+	// The average loss of the so-far-the-best model on all points
+	const double best_average_loss = 1.0 / (best_score_.score * point_number);
+
+	// Since the loss of a point is in [0, outlier_loss], the Hoeffding inequality implies that the 
+	// average loss on all points is larger than the following bound with the required confidence.
+	const double bound_width = loss_function.outlier_loss *
+		std::sqrt(-std::log(1.0 - subset_scoring_confidence) / (2.0 * subset_size));
+
+	return average_loss - bound_width < best_average_loss;
+}
+
+template <class DatumType, class ModelEstimator>
+const typename MAGSAC<DatumType, ModelEstimator>::RunContext::RefinedModelEntry *MAGSAC<DatumType, ModelEstimator>::findRefinedModel(
+	const uint64_t key_,
+	RunContext &context_) const
+{
+	for (const auto &entry : context_.refined_model_cache)
+		if (entry.key == key_)
+			return &entry;
+	return nullptr;
+}
+
+template <class DatumType, class ModelEstimator>
+void MAGSAC<DatumType, ModelEstimator>::storeRefinedModel(
+	const uint64_t key_,
+	const double score_,
+	const bool is_valid_,
+	RunContext &context_) const
+{
+	typename RunContext::RefinedModelEntry entry;
+	entry.key = key_;
+	entry.score = score_;
+	entry.iteration_number = context_.last_iteration_number;
+	entry.is_valid = is_valid_;
+
+	// Replace the oldest entry if the cache is full
+	if (context_.refined_model_cache.size() < refined_model_cache_size)
+		context_.refined_model_cache.emplace_back(entry);
+	else
+		context_.refined_model_cache[context_.refined_model_cache_position] = entry;
+	context_.refined_model_cache_position = (context_.refined_model_cache_position + 1) % refined_model_cache_size;
+}
+
+template <class DatumType, class ModelEstimator>
+void MAGSAC<DatumType, ModelEstimator>::collectRunOutput(
+	const size_t point_number_, // The number of input points
+	const size_t *representative_indices_, // The representative of each input point if the points are merged, otherwise, null
+	const bool is_model_found_, // A flag saying if a model has been found
+	RunContext &context_, // The state of the run
+	RunOutput &output_) const // The per-point data to be filled
+{
+	const RunOutput &fit_data = context_.best_fit_data;
+
+	output_.point_indices.clear();
+	output_.residuals.clear();
+	output_.weights.clear();
+	output_.inlier_mask.clear();
+	if (!is_model_found_ ||
+		fit_data.point_indices.empty())
+		return;
+	output_.inlier_mask.assign((point_number_ + 63) / 64, 0);
+
+	// The position of each point of the estimation in the data of the fitting. It is needed since the
+	// points are ordered by their residuals in sigma-consensus and since a merged point stands for
+	// multiple input points.
+	constexpr size_t not_fitted = std::numeric_limits<size_t>::max();
+	std::vector<size_t> &positions = context_.fit_data_positions;
+	positions.assign(context_.point_number, not_fitted);
+	for (size_t position = 0; position < fit_data.point_indices.size(); ++position)
+		positions[fit_data.point_indices[position]] = position;
+
+	for (size_t point_idx = 0; point_idx < point_number_; ++point_idx)
+	{
+		const size_t position = positions[representative_indices_ == nullptr ?
+			point_idx : representative_indices_[point_idx]];
+		if (position == not_fitted)
+			continue;
+
+		// Set the bit of the point if it is closer than the reference threshold
+		const double residual = fit_data.residuals[position];
+		if (residual < interrupting_threshold)
+			output_.inlier_mask[point_idx >> 6] |= uint64_t(1) << (point_idx & 63);
+
+		output_.point_indices.emplace_back(point_idx);
+		output_.residuals.emplace_back(residual);
+		output_.weights.emplace_back(fit_data.weights[position]);
+	}
+}
+
+template <class DatumType, class ModelEstimator>
+void MAGSAC<DatumType, ModelEstimator>::reportBestModel(
+	const gcransac::Model &best_model_, // The new so-far-the-best model
+	const ModelScore &best_score_, // The score of the model
+	const size_t iteration_, // The number of iterations done
+	const size_t max_iteration_, // The maximum number of iterations implied by the model
+	const RunContext &context_) const // The state of the run
+{
+	if (context_.observer == nullptr &&
+		context_.snapshot == nullptr)
+		return;
+
+	const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - context_.run_start;
+	magsac::utils::BestModelUpdate update;
+	update.model = &best_model_;
+	update.iteration = iteration_;
+	update.elapsed_seconds = elapsed_seconds.count();
+	update.score = best_score_.score;
+	update.inlier_number = best_score_.inlier_number;
+	update.max_iteration = max_iteration_;
+
+	if (context_.snapshot != nullptr)
+		context_.snapshot->update(update);
+	if (context_.observer != nullptr)
+		context_.observer->onBestModelUpdated(update);
+}
+
+template <class DatumType, class ModelEstimator>
+void MAGSAC<DatumType, ModelEstimator>::addRunToMetrics(
+	const std::chrono::steady_clock::time_point &start_, // The start of the run
+	const int iteration_number_, // The number of iterations done
+	const bool success_, // A flag saying if a model has been found
+	const RunStatistics &statistics_) const // The statistics of the run
+{
+	const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start_;
+	metrics->latency_seconds.observe(elapsed_seconds.count());
+	metrics->iteration_number.observe(iteration_number_);
+
+	metrics->add(magsac::utils::EstimationMetrics::RunNumber);
+	if (!success_)
+		metrics->add(magsac::utils::EstimationMetrics::FailedRunNumber);
+	if (statistics_.is_time_limit_reached)
+		metrics->add(magsac::utils::EstimationMetrics::TimeLimitHits);
+	metrics->add(magsac::utils::EstimationMetrics::SampleNumber, statistics_.sample_number);
+	metrics->add(magsac::utils::EstimationMetrics::DuplicateSampleNumber, statistics_.duplicate_sample_number);
+	metrics->add(magsac::utils::EstimationMetrics::RefinedModelNumber, statistics_.refined_model_number);
+	metrics->add(magsac::utils::EstimationMetrics::SubsetScoredModelNumber, statistics_.subset_scored_model_number);
+	metrics->add(magsac::utils::EstimationMetrics::SubsetRejectedModelNumber,
+		statistics_.subset_scored_model_number - statistics_.promoted_model_number);
+	metrics->add(magsac::utils::EstimationMetrics::InvalidModelNumber, statistics_.invalid_model_number);
+	metrics->add(magsac::utils::EstimationMetrics::PrunedModelNumber, statistics_.pruned_model_number);
+}
+
 template <class DatumType, class ModelEstimator>
 void MAGSAC<DatumType, ModelEstimator>::getModelQualityPlusPlus(
 	const cv::Mat &points_, // All data points
 	const gcransac::Model &model_, // The model parameter
 	const ModelEstimator &estimator_, // The model estimator class
 	double &score_, // The score to be calculated
-	const double &previous_best_score_) // The score of the previous so-far-the-best model 
+	const double &previous_best_score_, // The score of the previous so-far-the-best model 
+	const double *multiplicities_) const // If given, the number of input points each point stands for
 {
-	// The degrees of freedom of the data from which the model is estimated.
-	// E.g., for models coming from point correspondences (x1,y1,x2,y2), it is 4.
-	constexpr size_t degrees_of_freedom = ModelEstimator::getDegreesOfFreedom();
-	// A 0.99 quantile of the Chi^2-distribution to convert sigma values to residuals
-	constexpr double k = ModelEstimator::getSigmaQuantile();
-	// A multiplier to convert residual values to sigmas
-	constexpr double threshold_to_sigma_multiplier = 1.0 / k;
-	// Calculating k^2 / 2 which will be used for the estimation and, 
-	// due to being constant, it is better to calculate it a priori.
-	constexpr double squared_k_per_2 = k * k / 2.0;
-	// Calculating (DoF - 1) / 2 which will be used for the estimation and, 
-	// due to being constant, it is better to calculate it a priori.
-	constexpr double dof_minus_one_per_two = (degrees_of_freedom - 1.0) / 2.0;
-	// Calculating (DoF + 1) / 2 which will be used for the estimation and, 
-	// due to being constant, it is better to calculate it a priori.
-	constexpr double dof_plus_one_per_two = (degrees_of_freedom + 1.0) / 2.0;
-	// TODO: check
-	constexpr double C = 0.25;
-	// Calculating 2^(DoF - 1) which will be used for the estimation and, 
-	// due to being constant, it is better to calculate it a priori.
-	static const double two_ad_dof_minus_one = std::pow(2.0, dof_minus_one_per_two);
-	// Calculating 2^(DoF + 1) which will be used for the estimation and, 
-	// due to being constant, it is better to calculate it a priori.
-	static const double two_ad_dof_plus_one = std::pow(2.0, dof_plus_one_per_two);
-	// Calculate the gamma value of k
-	constexpr double gamma_value_of_k = ModelEstimator::getUpperIncompleteGammaOfK();
-	// Calculate the lower incomplete gamma value of k
-	constexpr double lower_gamma_value_of_k = ModelEstimator::getLowerIncompleteGammaOfK();
+	MAGSAC_TRACE_SPAN(tracer, "getModelQualityPlusPlus");
+	// The MAGSAC++ loss function
+	const PlusPlusLoss loss_function(maximum_threshold);
 	// The number of points provided
 	const int point_number = points_.rows;
 	// The previous best loss
 	const double previous_best_loss = 1.0 / previous_best_score_;
-	// Convert the maximum threshold to a sigma value
-	const double maximum_sigma = threshold_to_sigma_multiplier * maximum_threshold;
-	// Calculate the squared maximum sigma
-	const double maximum_sigma_2 = maximum_sigma * maximum_sigma;
-	// Calculate \sigma_{max}^2 / 2
-	const double maximum_sigma_2_per_2 = maximum_sigma_2 / 2.0;
-	// Calculate 2 * \sigma_{max}^2
-	const double maximum_sigma_2_times_2 = maximum_sigma_2 * 2.0;
-	// Calculate the loss implied by an outlier
-	const double outlier_loss = maximum_sigma * two_ad_dof_minus_one  * lower_gamma_value_of_k;
-	// Calculating 2^(DoF + 1) / \sigma_{max} which will be used for the estimation and, 
-	// due to being constant, it is better to calculate it a priori.
-	const double two_ad_dof_plus_one_per_maximum_sigma = two_ad_dof_plus_one / maximum_sigma;
-	// The loss which a point implies
-	double loss = 0.0,
-		// The total loss regarding the current model
-		total_loss = 0.0;
+	// The total loss regarding the current model
+	double total_loss = 0.0;
 
 	// Iterate through all points to calculate the implied loss
 	for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
 	{
 		// Calculate the residual of the current point
 		const double residual =
-			estimator_.residualForScoring(points_.row(point_idx), model_.descriptor);
-
-		// If the residual is smaller than the maximum threshold, consider it outlier
-		// and add the loss implied to the total loss.
-		if (maximum_threshold < residual)
-			loss = outlier_loss;
-		else // Otherwise, consider the point inlier, and calculate the implied loss
-		{
-			// Calculate the squared residual
-			const double squared_residual = residual * residual;
-			// Divide the residual by the 2 * \sigma^2
-			const double squared_residual_per_sigma = squared_residual / maximum_sigma_2_times_2;
-			// Get the position of the gamma value in the lookup table
-			size_t x = round(precision_of_stored_incomplete_gammas * squared_residual_per_sigma);
-			// If the sought gamma value is not stored in the lookup, return the closest element
-			if (stored_incomplete_gamma_number < x)
-				x = stored_incomplete_gamma_number;
-
-			// Calculate the loss implied by the current point
-			loss = maximum_sigma_2_per_2 * stored_lower_incomplete_gamma_values[x] +
-				squared_residual / 4.0 * (stored_complete_gamma_values[x] -
-					gamma_value_of_k);
-			loss = loss * two_ad_dof_plus_one_per_maximum_sigma;
-		}
+			estimator_.residualForScoring(points_.row(point_idx), model_);
 
-		// Update the total loss
-		total_loss += loss;
+		// Update the total loss. A merged point implies the loss of all points it stands for.
+		if (multiplicities_ == nullptr)
+			total_loss += loss_function(residual);
+		else
+			total_loss += multiplicities_[point_idx] * loss_function(residual);
 
 		// Break the validation if there is no chance of being better than the previous
 		// so-far-the-best model.
@@ -948,9 +3237,11 @@ void MAGSAC<DatumType, ModelEstimator>::getModelQuality(
 	const cv::Mat &points_, // All data points
 	const gcransac::Model &model_, // The model parameter
 	const ModelEstimator &estimator_, // The model estimator class
+	const double log_confidence_, // The logarithm of 1 - the required confidence
 	double &marginalized_iteration_number_, // The marginalized iteration number to be calculated
-	double &score_) // The score to be calculated
+	double &score_) const // The score to be calculated
 {
+	MAGSAC_TRACE_SPAN(tracer, "getModelQuality");
 	// Set up the parameters
 	constexpr size_t sample_size = estimator_.sampleSize();
 	const size_t point_number = points_.rows;
@@ -964,7 +3255,7 @@ void MAGSAC<DatumType, ModelEstimator>::getModelQuality(
 	{
 		// Calculate the residual of the current point
 		const double residual =
-			estimator_.residualForScoring(points_.row(point_idx), model_.descriptor);
+			estimator_.residualForScoring(points_.row(point_idx), model_);
 		// If the residual is smaller than the maximum threshold, add it to the set of possible inliers
 		if (maximum_threshold > residual)
 		{
@@ -1023,7 +3314,7 @@ void MAGSAC<DatumType, ModelEstimator>::getModelQuality(
 	for (auto i = 0; i < partition_number; ++i)
 	{
 		score_ += probabilities[i];
-		marginalized_iteration_number_ += log_confidence / log(1.0 - std::pow(inliers[i] / point_number, sample_size));
+		marginalized_iteration_number_ += log_confidence_ / log(1.0 - std::pow(inliers[i] / point_number, sample_size));
 	}
 	marginalized_iteration_number_ = marginalized_iteration_number_ / partition_number;
 }
@@ -1037,29 +3328,16 @@ void MAGSAC<DatumType, ModelEstimator>::getModelInliersMask(
 	const gcransac::Model &model_, // The model parameter
 	const ModelEstimator &estimator_,
 	const double threshold_,	// Inlier/outlier threshold
-	std::vector<bool> &inliers_mask_) {
+	std::vector<bool> &inliers_mask_) const {
 	
 	if (inliers_mask_.size() != points_.rows) 
 		inliers_mask_.resize(points_.rows);
 	
-	// Iterate through all points to calculate the implied loss
-  // TODO: Remove after debugging
-  //int cnt = 0;
+	// Iterate through all points and classify them by the residual used
+	// for comparing the resulting models.
 	for (size_t point_idx = 0; point_idx < points_.rows; ++point_idx)
 	{
 		// Compare with threshold to set a flag
-		inliers_mask_[point_idx] = threshold_ > estimator_.residualForScoring(points_.row(point_idx), model_.descriptor);
-	}
-  //printf("\t\tTotal inliers by epipolar error: %d\n", std::count(inliers_mask_.begin(), inliers_mask_.end(), true));
-  
-
-  // TODO: Right 
-  for (size_t point_idx = 0; point_idx < points_.rows; ++point_idx)
-	{
-		// Compare with threshold to set a flag
-		//inliers_mask_[point_idx] = threshold_ > estimator_.residualForScoring(points_.row(point_idx), model_.descriptor);
-    inliers_mask_[point_idx] = threshold_ > estimator_.residualOtherForScoring(points_.row(point_idx), model_.descriptor);
+		inliers_mask_[point_idx] = threshold_ > estimator_.residualOtherForScoring(points_.row(point_idx), model_);
 	}
-  //printf("\t\tTotal inliers by sampson error: %d\n", std::count(inliers_mask_.begin(), inliers_mask_.end(), true));
-
 }
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <Eigen/Core>
+#include <opencv2/core.hpp>
+#include "model.h"
+#include "model_score.h"
+
+namespace magsac
+{
+	namespace api
+	{
+		// The settings of a run. The thresholds are given in the units of the point coordinates,
+		// i.e., in normalized coordinates in essential matrix fitting.
+		struct Settings
+		{
+			double confidence = 0.99; // The required confidence in the results
+			double maximum_threshold = 10.0; // The maximum noise scale sigma allowed
+			double reference_threshold = 0.0; // The reference threshold of MAGSAC++, the default one is used if it is not positive
+			size_t iteration_limit = 10000; // The maximum number of iterations
+			bool use_magsac_plus_plus = true; // Decides if MAGSAC++ or the original MAGSAC is applied
+		};
+
+		// Fitting a homography to point correspondences of format x1 y1 x2 y2
+		bool findHomography(
+			const cv::Mat &points_, // The point correspondences
+			const Settings &settings_, // The settings of the run
+			gcransac::Model &model_, // The estimated homography
+			ModelScore &score_, // The score of the estimated homography
+			int &iteration_number_); // The number of iterations done
+
+		// Fitting a fundamental matrix to point correspondences of format x1 y1 x2 y2
+		bool findFundamentalMatrix(
+			const cv::Mat &points_, // The point correspondences
+			const Settings &settings_, // The settings of the run
+			gcransac::Model &model_, // The estimated fundamental matrix
+			ModelScore &score_, // The score of the estimated fundamental matrix
+			int &iteration_number_); // The number of iterations done
+
+		// Fitting an essential matrix to point correspondences normalized by the intrinsic camera matrices
+		bool findEssentialMatrix(
+			const cv::Mat &normalized_points_, // The normalized point correspondences
+			const Eigen::Matrix3d &intrinsics_source_, // The intrinsic parameters of the source camera
+			const Eigen::Matrix3d &intrinsics_destination_, // The intrinsic parameters of the destination camera
+			const Settings &settings_, // The settings of the run
+			gcransac::Model &model_, // The estimated essential matrix
+			ModelScore &score_, // The score of the estimated essential matrix
+			int &iteration_number_); // The number of iterations done
+	}
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace magsac
+{
+	namespace utils
+	{
+		// A histogram with fixed bucket bounds. The buckets are atomic counters, thus, it can be
+		// updated by multiple threads without locking.
+		class AtomicHistogram
+		{
+		public:
+			explicit AtomicHistogram(const std::vector<double> &upper_bounds_) : // The increasing upper bounds of the buckets
+				upper_bounds(upper_bounds_),
+				bucket_counts(new std::atomic<uint64_t>[upper_bounds_.size() + 1]),
+				sum(0.0)
+			{
+				for (size_t bucket_idx = 0; bucket_idx <= upper_bounds.size(); ++bucket_idx)
+					bucket_counts[bucket_idx].store(0, std::memory_order_relaxed);
+			}
+
+			void observe(const double value_)
+			{
+				size_t bucket_idx = 0;
+				while (bucket_idx < upper_bounds.size() &&
+					value_ > upper_bounds[bucket_idx])
+					++bucket_idx;
+				bucket_counts[bucket_idx].fetch_add(1, std::memory_order_relaxed);
+
+				double current_sum = sum.load(std::memory_order_relaxed);
+				while (!sum.compare_exchange_weak(current_sum, current_sum + value_, std::memory_order_relaxed))
+				{
+				}
+			}
+
+			// Appending the histogram in the Prometheus text format
+			void write(
+				std::string &text_, // The exported text
+				const std::string &name_, // The name of the metric
+				const std::string &labels_) const // The labels of the metric, e.g., estimator="homography"
+			{
+				char line[256];
+				uint64_t cumulative_count = 0;
+				for (size_t bucket_idx = 0; bucket_idx <= upper_bounds.size(); ++bucket_idx)
+				{
+					cumulative_count += bucket_counts[bucket_idx].load(std::memory_order_relaxed);
+					if (bucket_idx < upper_bounds.size())
+						snprintf(line, sizeof(line), "%s_bucket{%s,le=\"%g\"} %llu\n",
+							name_.c_str(), labels_.c_str(), upper_bounds[bucket_idx], static_cast<unsigned long long>(cumulative_count));
+					else
+						snprintf(line, sizeof(line), "%s_bucket{%s,le=\"+Inf\"} %llu\n",
+							name_.c_str(), labels_.c_str(), static_cast<unsigned long long>(cumulative_count));
+					text_ += line;
+				}
+				snprintf(line, sizeof(line), "%s_sum{%s} %.9g\n%s_count{%s} %llu\n",
+					name_.c_str(), labels_.c_str(), sum.load(std::memory_order_relaxed),
+					name_.c_str(), labels_.c_str(), static_cast<unsigned long long>(cumulative_count));
+				text_ += line;
+			}
+
+		protected:
+			const std::vector<double> upper_bounds; // The upper bounds of the buckets except the last one
+			std::unique_ptr<std::atomic<uint64_t>[]> bucket_counts; // The number of values in each bucket
+			std::atomic<double> sum; // The sum of the values
+		};
+
+		// The metrics of the runs of an estimator. MAGSAC and the estimators add to them by relaxed
+		// atomic operations once per run (and once per DEGENSAC check), thus, they can be shared by the
+		// threads running the same kind of estimation.
+		struct EstimationMetrics
+		{
+			enum Counter
+			{
+				RunNumber, // The number of runs
+				FailedRunNumber, // The number of runs not returning a model
+				TimeLimitHits, // The number of runs interrupted by the time limit
+				SampleNumber, // The number of minimal samples selected
+				DuplicateSampleNumber, // The number of minimal samples skipped as they had been evaluated
+				RefinedModelNumber, // The number of models refined by sigma-consensus
+				SubsetScoredModelNumber, // The number of models scored on the subset of the points first
+				SubsetRejectedModelNumber, // The number of models rejected after scoring them on the subset
+				InvalidModelNumber, // The number of refined models rejected by the validity check
+				PrunedModelNumber, // The number of models dropped after a block of points in the preemptive mode
+				DegensacCheckNumber, // The number of models checked by DEGENSAC
+				DegensacTriggerNumber, // The number of models whose minimal sample was found to be H-degenerate
+				CounterNumber
+			};
+
+			explicit EstimationMetrics(const std::string &estimator_name_) :
+				estimator_name(estimator_name_),
+				latency_seconds({ 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0 }),
+				iteration_number({ 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000 })
+			{
+				for (std::atomic<uint64_t> &counter : counters)
+					counter.store(0, std::memory_order_relaxed);
+			}
+
+			const std::string estimator_name; // The value of the estimator label
+			AtomicHistogram latency_seconds; // The run times
+			AtomicHistogram iteration_number; // The number of iterations of the runs
+			std::atomic<uint64_t> counters[CounterNumber]; // The counters indexed by Counter
+
+			void add(const Counter counter_, const uint64_t value_ = 1)
+			{
+				counters[counter_].fetch_add(value_, std::memory_order_relaxed);
+			}
+
+			// The name of a counter in the exported metrics
+			static const char *getCounterName(const Counter counter_)
+			{
+				static const char * const names[CounterNumber] = {
+					"magsac_runs_total",
+					"magsac_failed_runs_total",
+					"magsac_time_limit_hits_total",
+					"magsac_samples_total",
+					"magsac_duplicate_samples_total",
+					"magsac_refined_models_total",
+					"magsac_subset_scored_models_total",
+					"magsac_subset_rejected_models_total",
+					"magsac_invalid_models_total",
+					"magsac_pruned_models_total",
+					"magsac_degensac_checks_total",
+					"magsac_degensac_triggers_total" };
+				return names[counter_];
+			}
+
+			// The description of a counter in the exported metrics
+			static const char *getCounterHelp(const Counter counter_)
+			{
+				static const char * const descriptions[CounterNumber] = {
+					"The number of MAGSAC runs.",
+					"The number of MAGSAC runs not returning a model.",
+					"The number of MAGSAC runs interrupted by the time limit.",
+					"The number of minimal samples selected.",
+					"The number of minimal samples skipped as they had been evaluated.",
+					"The number of models refined by sigma-consensus.",
+					"The number of models scored on a subset of the points first.",
+					"The number of models rejected after scoring them on a subset of the points.",
+					"The number of refined models rejected by the validity check.",
+					"The number of models dropped after a block of points in the preemptive mode.",
+					"The number of models checked by DEGENSAC.",
+					"The number of models whose minimal sample was found to be H-degenerate." };
+				return descriptions[counter_];
+			}
+		};
+
+		// The metrics of the estimators of a process. Only registering an estimator and exporting
+		// the metrics lock, the runs update the metrics without locking.
+		class MetricsRegistry
+		{
+		public:
+			// Returning the metrics of an estimator, e.g., "homography". They are created on the first call
+			// and their address does not change later.
+			EstimationMetrics &getEstimationMetrics(const std::string &estimator_name_)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				for (EstimationMetrics &metrics : estimation_metrics)
+					if (metrics.estimator_name == estimator_name_)
+						return metrics;
+				estimation_metrics.emplace_back(estimator_name_);
+				return estimation_metrics.back();
+			}
+
+			// The metrics in the Prometheus text format. The samples of a metric are written
+			// together for all estimators as the format requires.
+			std::string exportText()
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				std::string text;
+				char line[256];
+
+				text += "# HELP magsac_run_duration_seconds The run time of MAGSAC.\n"
+					"# TYPE magsac_run_duration_seconds histogram\n";
+				for (const EstimationMetrics &metrics : estimation_metrics)
+					metrics.latency_seconds.write(text, "magsac_run_duration_seconds", getLabels(metrics));
+
+				text += "# HELP magsac_run_iterations The number of iterations of a MAGSAC run.\n"
+					"# TYPE magsac_run_iterations histogram\n";
+				for (const EstimationMetrics &metrics : estimation_metrics)
+					metrics.iteration_number.write(text, "magsac_run_iterations", getLabels(metrics));
+
+				for (size_t counter_idx = 0; counter_idx < EstimationMetrics::CounterNumber; ++counter_idx)
+				{
+					const EstimationMetrics::Counter counter = static_cast<EstimationMetrics::Counter>(counter_idx);
+					const char * const name = EstimationMetrics::getCounterName(counter);
+					snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s counter\n", name, EstimationMetrics::getCounterHelp(counter), name);
+					text += line;
+					for (const EstimationMetrics &metrics : estimation_metrics)
+					{
+						snprintf(line, sizeof(line), "%s{%s} %llu\n",
+							name,
+							getLabels(metrics).c_str(),
+							static_cast<unsigned long long>(metrics.counters[counter_idx].load(std::memory_order_relaxed)));
+						text += line;
+					}
+				}
+				return text;
+			}
+
+			// Writing the metrics in the Prometheus text format to a file, e.g., for the textfile collector
+			// of the node exporter. The file is replaced at once, so it is never read half-written.
+			bool writeToFile(const std::string &path_)
+			{
+				const std::string text = exportText();
+				const std::string temporary_path = path_ + ".tmp";
+				FILE * const file = fopen(temporary_path.c_str(), "w");
+				if (file == nullptr)
+				{
+					fprintf(stderr, "The metrics cannot be written to '%s'.\n", temporary_path.c_str());
+					return false;
+				}
+				const bool is_written = fwrite(text.data(), 1, text.size(), file) == text.size();
+				fclose(file);
+				return is_written &&
+					rename(temporary_path.c_str(), path_.c_str()) == 0;
+			}
+
+		protected:
+			std::mutex mutex; // Guards the list of the metrics
+			std::deque<EstimationMetrics> estimation_metrics; // The metrics of the estimators
+
+			static std::string getLabels(const EstimationMetrics &metrics_)
+			{
+				return "estimator=\"" + metrics_.estimator_name + "\"";
+			}
+		};
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "sampler.h"
+#include "grid_neighborhood.h"
+#include "fast_random_generator.h"
+
+namespace magsac
+{
+	namespace sampler
+	{
+		// A spatially local sampler in the spirit of NAPSAC (D. R. Myatt et al., "NAPSAC: High noise,
+		// high dimensional robust estimation - it's in the bag", BMVC 2002). A minimal sample consists of
+		// a randomly selected point and its neighbors in a grid over the coordinates in both images.
+		// The grid is built when the sampler is initialized, i.e., once for the points of a run.
+		// A given share of the samples, the samples whose point has too few neighbors and the samples
+		// from a pool not containing all points are selected globally, i.e., uniformly from the pool.
+		class GridNapsacSampler : public gcransac::sampler::Sampler<cv::Mat, size_t>
+		{
+		protected:
+			magsac::utils::FastRandomGenerator random_generator; // The random number generator
+			magsac::utils::GridNeighborhood neighborhood; // The grid index over the correspondences
+			uint64_t seed; // The seed of the generator
+			size_t cell_number_per_dimension; // The number of cells along each dimension of the grid
+			double global_sampling_share; // The share of the samples selected uniformly from the pool
+
+			// Selecting a minimal sample uniformly from the pool
+			inline void sampleGlobally(
+				const std::vector<size_t> &pool_,
+				size_t * const subset_,
+				const size_t sample_size_)
+			{
+				random_generator.uniqueSample(subset_, sample_size_, pool_.size());
+				for (size_t i = 0; i < sample_size_; ++i)
+					subset_[i] = pool_[subset_[i]];
+			}
+
+		public:
+			explicit GridNapsacSampler(
+				const cv::Mat * const container_, // The point correspondences, each is of format x1 y1 x2 y2
+				const size_t cell_number_per_dimension_ = 8, // The number of cells along each dimension of the grid
+				const double global_sampling_share_ = 0.1, // The share of the samples selected uniformly from the pool
+				const uint64_t seed_ = 0) // The seed of the random number generator
+				: Sampler(container_),
+				random_generator(seed_),
+				seed(seed_),
+				cell_number_per_dimension(cell_number_per_dimension_),
+				global_sampling_share(global_sampling_share_)
+			{
+				initialized = initialize(container_);
+			}
+
+			~GridNapsacSampler() {}
+
+			const std::string getName() const { return "Grid NAPSAC Sampler"; }
+
+			void reset()
+			{
+				random_generator.seed(seed);
+			}
+
+			// Building the grid over the points
+			bool initialize(const cv::Mat * const container_)
+			{
+				if (container_->cols < 4)
+				{
+					fprintf(stderr, "The grid NAPSAC sampler requires correspondences of format x1 y1 x2 y2.\n");
+					return false;
+				}
+				neighborhood.build(*container_, cell_number_per_dimension);
+				return true;
+			}
+
+			// Selecting a minimal sample from the neighborhood of a random point
+			inline bool sample(
+				const std::vector<size_t> &pool_, // The indices of the points from which the sample is selected
+				size_t * const subset_, // The selected sample
+				size_t sample_size_) // The size of the sample
+			{
+				constexpr size_t max_center_selections = 20; // The number of points tried before sampling globally
+
+				if (sample_size_ > pool_.size())
+					return false;
+
+				// The neighborhoods contain all points, thus, they can only be used if the pool contains all points
+				const bool is_local = initialized &&
+					pool_.size() == neighborhood.getPointNumber() &&
+					random_generator.uniform() >= global_sampling_share;
+
+				if (is_local)
+					for (size_t selection = 0; selection < max_center_selections; ++selection)
+					{
+						// Select the center of the sample and check if it has enough neighbors
+						const size_t center_idx = pool_[random_generator.bounded(pool_.size())];
+						const size_t * const neighbors = neighborhood.getNeighborsBegin(center_idx);
+						const size_t neighbor_number = neighborhood.getNeighborsEnd(center_idx) - neighbors;
+						if (neighbor_number < sample_size_)
+							continue;
+
+						// Select the other points among the neighbors skipping the center
+						const size_t center_position = neighborhood.getPositionInCell(center_idx);
+						random_generator.uniqueSample(subset_, sample_size_ - 1, neighbor_number - 1);
+						for (size_t i = 0; i < sample_size_ - 1; ++i)
+							subset_[i] = neighbors[subset_[i] < center_position ? subset_[i] : subset_[i] + 1];
+						subset_[sample_size_ - 1] = center_idx;
+						return true;
+					}
+
+				sampleGlobally(pool_, subset_, sample_size_);
+				return true;
+			}
+		};
+	}
+}
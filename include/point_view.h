@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <type_traits>
+#include <Eigen/Core>
+#include <opencv2/core.hpp>
+
+namespace magsac
+{
+	namespace utils
+	{
+		// A non-owning view of points stored row-by-row in a buffer of doubles, e.g., of correspondences
+		// of format x1 y1 x2 y2 in an aligned buffer of the caller. Consecutive points are 'stride'
+		// values apart, thus, the buffer has to hold 'point_number * stride' values.
+		struct PointView
+		{
+			const double *data; // The first coordinate of the first point
+			size_t point_number; // The number of points
+			size_t dimension; // The number of coordinates of a point
+			size_t stride; // The distance of consecutive points in doubles
+
+			PointView(
+				const double * const data_, // The first coordinate of the first point
+				const size_t point_number_, // The number of points
+				const size_t dimension_, // The number of coordinates of a point
+				const size_t stride_ = 0) // The distance of consecutive points in doubles, 0 if they are dense
+				: data(data_),
+				point_number(point_number_),
+				dimension(dimension_),
+				stride(stride_ == 0 ? dimension_ : stride_)
+			{
+			}
+
+			// The view of a row-major Eigen matrix or map, e.g., Eigen::Map<const Eigen::Matrix<double,
+			// Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>, 0, Eigen::OuterStride<>>
+			template <class _Derived>
+			explicit PointView(const Eigen::DenseBase<_Derived> &points_)
+				: data(points_.derived().data()),
+				point_number(points_.rows()),
+				dimension(points_.cols()),
+				stride(points_.derived().outerStride())
+			{
+				static_assert(_Derived::IsRowMajor, "The points have to be stored row-by-row.");
+				static_assert(std::is_same<typename _Derived::Scalar, double>::value, "The coordinates have to be doubles.");
+				static_assert(_Derived::InnerStrideAtCompileTime == 1, "The coordinates of a point have to be consecutive.");
+			}
+		};
+
+		// Wrapping the points of a view into a matrix header without copying them, so they can be passed
+		// to MAGSAC, the samplers and the estimators. The estimators and the minimal solvers address the
+		// points by the number of columns, thus, the padding of a strided view becomes trailing columns of
+		// the header which the estimators ignore. Only when merging the duplicate points is the padding
+		// compared as well, thus, it should not hold data differing per point in that case. The header does
+		// not own the data, i.e., the buffer has to outlive it and it must not be written through it.
+		inline cv::Mat wrapPoints(const PointView &view_)
+		{
+			if (view_.stride < view_.dimension)
+			{
+				fprintf(stderr, "The stride (%zu) of the points is smaller than their dimension (%zu).\n",
+					view_.stride, view_.dimension);
+				return cv::Mat();
+			}
+
+			// The header addresses the points and the coordinates by int
+			if (view_.point_number > static_cast<size_t>(std::numeric_limits<int>::max()) ||
+				view_.stride > static_cast<size_t>(std::numeric_limits<int>::max()))
+			{
+				fprintf(stderr, "The number of points (%zu) or their stride (%zu) is too large.\n",
+					view_.point_number, view_.stride);
+				return cv::Mat();
+			}
+
+			return cv::Mat(static_cast<int>(view_.point_number),
+				static_cast<int>(view_.stride),
+				CV_64F,
+				const_cast<double *>(view_.data));
+		}
+
+		// The view of a double matrix, e.g., to run the same code on points coming from OpenCV. The rows
+		// may be padded, e.g., in a submatrix of a wider one. The view of other matrices has no points.
+		inline PointView viewPoints(const cv::Mat &points_)
+		{
+			if (points_.type() != CV_64F)
+			{
+				fprintf(stderr, "The points have to be stored in a single-channel matrix of doubles.\n");
+				return PointView(nullptr, 0, 0);
+			}
+
+			return PointView(points_.ptr<double>(),
+				points_.rows,
+				points_.cols,
+				points_.step1());
+		}
+	}
+}
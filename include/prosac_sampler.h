@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "sampler.h"
+#include "sampler_feedback.h"
+#include "fast_random_generator.h"
+
+namespace magsac
+{
+	namespace sampler
+	{
+		// The progressive sampler of PROSAC (O. Chum and J. Matas, "Matching with PROSAC - progressive
+		// sample consensus", CVPR 2005). The points are ordered by their quality, e.g., by the score of
+		// the ratio test, and the minimal samples are selected from a progressively growing set of the best
+		// points. After the given number of samples, the sampling becomes uniform as in RANSAC.
+		// The termination criterion of PROSAC, i.e., the non-randomness and the maximality of the
+		// solution, is provided to MAGSAC through the IterationFeedback interface.
+		// The quality scores refer to the indices of the points passed to MAGSAC::run, thus, MAGSAC
+		// fails the runs using the sampler together with the point compression or the coarse-to-fine mode.
+		// The pool is ordered again and the sampling restarts from the best points in every run.
+		class ProsacSampler : public gcransac::sampler::Sampler<cv::Mat, size_t>, public IterationFeedback
+		{
+		protected:
+			magsac::utils::FastRandomGenerator random_generator; // The random number generator
+			uint64_t seed; // The seed of the generator
+			std::vector<double> quality_scores; // The quality of each point. Higher is better.
+			size_t growth_max_samples; // The number of samples after which the sampling is uniform
+			double outlier_consistency_probability; // The probability that an outlier is consistent with a wrong model
+			double non_randomness_significance; // The probability that the solution is random
+
+			std::vector<size_t> ordered_pool; // The pool ordered by the quality of the points
+			std::vector<size_t> growth_function; // The sample number from which the set of the best n + 1 points is used
+			std::vector<size_t> minimum_inlier_numbers; // The inlier number the best n + 1 points need to be non-random
+			size_t prepared_sample_size; // The sample size for which the growth function was calculated
+			size_t sample_number; // The number of samples selected so far
+			size_t subset_size; // The number of the best points from which the samples are currently selected
+			size_t termination_length; // The number of the best points beyond which the set is not grown
+
+			// Ordering the pool by quality and calculating the growth function and the
+			// minimum inlier numbers of the non-randomness test
+			void preparePool(
+				const std::vector<size_t> &pool_,
+				const size_t sample_size_)
+			{
+				const size_t point_number = pool_.size();
+
+				// Order the points by decreasing quality. The points without a score come last.
+				ordered_pool = pool_;
+				std::stable_sort(ordered_pool.begin(), ordered_pool.end(),
+					[this](const size_t left_, const size_t right_)
+					{
+						return getQuality(left_) > getQuality(right_);
+					});
+
+				// Calculate T'_n, i.e., the number of samples after which the best n points
+				// are used, as it is proposed in the paper
+				growth_function.resize(point_number);
+				double T_n = static_cast<double>(growth_max_samples);
+				for (size_t i = 0; i < sample_size_; ++i)
+					T_n *= static_cast<double>(sample_size_ - i) / (point_number - i);
+				size_t T_n_prime = 1;
+				for (size_t i = 0; i < sample_size_; ++i)
+					growth_function[i] = T_n_prime;
+				for (size_t i = sample_size_; i < point_number; ++i)
+				{
+					const double T_n_plus_1 = static_cast<double>(i + 1) * T_n / (i + 1 - sample_size_);
+					growth_function[i] = T_n_prime + static_cast<size_t>(std::ceil(T_n_plus_1 - T_n));
+					T_n = T_n_plus_1;
+					T_n_prime = growth_function[i];
+				}
+
+				// The minimum number of inliers among the best n points so that the solution is not random.
+				// The binomial distribution of the inliers of a random model is approximated by the normal one.
+				const double z = getNormalQuantile(non_randomness_significance);
+				const double beta = outlier_consistency_probability;
+				minimum_inlier_numbers.resize(point_number);
+				for (size_t n = 1; n <= point_number; ++n)
+				{
+					const double outlier_number = n > sample_size_ ? static_cast<double>(n - sample_size_) : 0.0;
+					minimum_inlier_numbers[n - 1] = sample_size_ + static_cast<size_t>(std::ceil(
+						outlier_number * beta + z * std::sqrt(outlier_number * beta * (1.0 - beta))));
+				}
+
+				prepared_sample_size = sample_size_;
+				sample_number = 0;
+				subset_size = sample_size_;
+				termination_length = point_number;
+			}
+
+			inline double getQuality(const size_t point_idx_) const
+			{
+				return point_idx_ < quality_scores.size() ?
+					quality_scores[point_idx_] :
+					std::numeric_limits<double>::lowest();
+			}
+
+			// The z value for which the upper tail of the standard normal distribution equals the probability
+			static double getNormalQuantile(const double probability_)
+			{
+				double lower = 0.0, upper = 10.0;
+				for (size_t iteration = 0; iteration < 64; ++iteration)
+				{
+					const double middle = (lower + upper) / 2.0;
+					if (0.5 * std::erfc(middle / std::sqrt(2.0)) > probability_)
+						lower = middle;
+					else
+						upper = middle;
+				}
+				return upper;
+			}
+
+		public:
+			explicit ProsacSampler(
+				const cv::Mat * const container_, // The data points
+				const std::vector<double> &quality_scores_, // The quality of each point. Higher is better.
+				const size_t growth_max_samples_ = 100000, // The number of samples after which the sampling is uniform
+				const double outlier_consistency_probability_ = 0.05, // The probability that an outlier is consistent with a wrong model
+				const double non_randomness_significance_ = 0.05, // The probability that the solution is random
+				const uint64_t seed_ = 0) // The seed of the random number generator
+				: Sampler(container_),
+				random_generator(seed_),
+				seed(seed_),
+				quality_scores(quality_scores_),
+				growth_max_samples(growth_max_samples_),
+				outlier_consistency_probability(outlier_consistency_probability_),
+				non_randomness_significance(non_randomness_significance_),
+				prepared_sample_size(0),
+				sample_number(0),
+				subset_size(0),
+				termination_length(0)
+			{
+				initialized = initialize(container_);
+			}
+
+			~ProsacSampler() {}
+
+			const std::string getName() const { return "PROSAC Sampler"; }
+
+			// Restarting the sampling from the best points
+			void reset()
+			{
+				random_generator.seed(seed);
+				ordered_pool.clear();
+			}
+
+			bool initialize(const cv::Mat * const)
+			{
+				ordered_pool.clear();
+				return true;
+			}
+
+			// Ordering the pool of a new run by quality and restarting the sampling from the best points
+			void prepare(
+				const std::vector<size_t> &pool_, // The indices of the points from which the samples are selected
+				const size_t sample_size_) // The size of a minimal sample
+			{
+				if (sample_size_ <= pool_.size())
+					preparePool(pool_, sample_size_);
+			}
+
+			// Selecting a minimal sample from the best points
+			inline bool sample(
+				const std::vector<size_t> &pool_, // The indices of the points from which the sample is selected
+				size_t * const subset_, // The selected sample
+				size_t sample_size_) // The size of the sample
+			{
+				if (sample_size_ > pool_.size())
+					return false;
+
+				// Order the pool if the sampler is used without MAGSAC preparing it
+				if (ordered_pool.size() != pool_.size() ||
+					prepared_sample_size != sample_size_)
+					preparePool(pool_, sample_size_);
+
+				// After the given number of samples, sample uniformly from all points as RANSAC does
+				if (sample_number > growth_max_samples)
+				{
+					random_generator.uniqueSample(subset_, sample_size_, ordered_pool.size());
+					for (size_t i = 0; i < sample_size_; ++i)
+						subset_[i] = ordered_pool[subset_[i]];
+					return true;
+				}
+
+				// Grow the set of the best points if the growth function says so
+				++sample_number;
+				if (sample_number >= growth_function[subset_size - 1] &&
+					subset_size < termination_length)
+					++subset_size;
+
+				if (growth_function[subset_size - 1] < sample_number)
+					// Select all points from the best ones uniformly
+					random_generator.uniqueSample(subset_, sample_size_, subset_size);
+				else
+				{
+					// Select the last point of the set and the others from the better points
+					random_generator.uniqueSample(subset_, sample_size_ - 1, subset_size - 1);
+					subset_[sample_size_ - 1] = subset_size - 1;
+				}
+
+				for (size_t i = 0; i < sample_size_; ++i)
+					subset_[i] = ordered_pool[subset_[i]];
+				return true;
+			}
+
+			// The termination criterion of PROSAC. From the sets of the best n points in which the
+			// so-far-the-best model is not random, the one needing the fewest iterations is selected.
+			// The set of the best points is not grown beyond this one.
+			size_t getRequiredIterationNumber(
+				const std::vector<bool> &inliers_, // The inlier flags of all points w.r.t. the so-far-the-best model
+				const size_t sample_size_, // The size of a minimal sample
+				const double log_confidence_) // The logarithm of 1 - the required confidence
+			{
+				if (ordered_pool.empty() ||
+					prepared_sample_size != sample_size_)
+					return std::numeric_limits<size_t>::max();
+
+				double best_iteration_number = std::numeric_limits<double>::max();
+				size_t best_length = 0;
+				size_t inlier_number = 0;
+
+				for (size_t n = 1; n <= ordered_pool.size(); ++n)
+				{
+					if (inliers_[ordered_pool[n - 1]])
+						++inlier_number;
+
+					// Non-randomness: there have to be more inliers than a random model would get
+					if (n < sample_size_ ||
+						inlier_number < minimum_inlier_numbers[n - 1])
+						continue;
+
+					// Maximality: the probability of missing a better model among the best n points
+					double all_inlier_probability = 1.0;
+					for (size_t i = 0; i < sample_size_; ++i)
+						all_inlier_probability *= static_cast<double>(inlier_number - i) / (n - i);
+
+					const double iteration_number = all_inlier_probability >= 1.0 ? 1.0 :
+						log_confidence_ / std::log(1.0 - all_inlier_probability);
+					if (iteration_number < best_iteration_number)
+					{
+						best_iteration_number = iteration_number;
+						best_length = n;
+					}
+				}
+
+				if (best_length == 0)
+					return std::numeric_limits<size_t>::max();
+
+				termination_length = MAX(best_length, subset_size);
+				if (best_iteration_number >= static_cast<double>(std::numeric_limits<size_t>::max()))
+					return std::numeric_limits<size_t>::max();
+				return static_cast<size_t>(std::ceil(best_iteration_number));
+			}
+		};
+	}
+}
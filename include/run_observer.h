@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include "model.h"
+#include "model_score.h"
+
+namespace magsac
+{
+	namespace utils
+	{
+		// The state of a run when its so-far-the-best model has been replaced
+		struct BestModelUpdate
+		{
+			const gcransac::Model *model; // The new so-far-the-best model. It is valid only during the call.
+			size_t iteration; // The number of iterations done so far
+			double elapsed_seconds; // The time since the start of the run
+			double score; // The score of the new so-far-the-best model
+			size_t inlier_number; // The number of points closer to the model than the reference threshold
+			size_t max_iteration; // The maximum number of iterations of the current search after the update, capped by the iteration limit. In the preemptive mode, the models are refined after all samples are drawn, thus, it equals the iterations done.
+		};
+
+		// The interface of the objects observing the convergence of MAGSAC, e.g., to record the
+		// score-versus-time curve of the runs. The observer is set in the RunContext of the runs, thus,
+		// the concurrent runs using their own contexts are observed separately. It is called from the
+		// thread running MAGSAC whenever the so-far-the-best model is replaced, thus, it should return
+		// quickly. In the coarse-to-fine mode, the scores of the coarse phase are calculated on the
+		// subsample of the points and they are not comparable with the later ones, and the fine search
+		// has its own maximum number of iterations.
+		class RunObserver
+		{
+		public:
+			virtual ~RunObserver() {}
+
+			// Called when a run starts, before the search for the model
+			virtual void onRunStarted() {}
+
+			// Called when the so-far-the-best model has been replaced
+			virtual void onBestModelUpdated(const BestModelUpdate &update_) = 0;
+		};
+
+		// The so-far-the-best model of a run which other threads can read while the run is going on,
+		// e.g., to show intermediate results. It is set in the RunContext of the run and a snapshot should
+		// not be shared by the contexts of concurrent runs. MAGSAC writes it only when the so-far-the-best
+		// model is replaced, and the readers copy it under a lock.
+		class BestModelSnapshot
+		{
+		public:
+			BestModelSnapshot() :
+				version(0),
+				has_model(false),
+				elapsed_seconds(0.0)
+			{
+			}
+
+			// Forgetting the model of the previous run
+			void reset()
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				has_model = false;
+				version.fetch_add(1, std::memory_order_release);
+			}
+
+			void update(const BestModelUpdate &update_)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				model.descriptor = update_.model->descriptor;
+				score.score = update_.score;
+				score.inlier_number = update_.inlier_number;
+				score.iteration = update_.iteration;
+				elapsed_seconds = update_.elapsed_seconds;
+				has_model = true;
+				version.fetch_add(1, std::memory_order_release);
+			}
+
+			// Copying the so-far-the-best model and its score. It returns false if no model has been found yet.
+			bool get(
+				gcransac::Model &model_, // The so-far-the-best model
+				ModelScore &score_, // The score of the model
+				double *elapsed_seconds_ = nullptr) const // If given, the time when the model was found
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!has_model)
+					return false;
+				model_.descriptor = model.descriptor;
+				score_ = score;
+				if (elapsed_seconds_ != nullptr)
+					*elapsed_seconds_ = elapsed_seconds;
+				return true;
+			}
+
+			// The number of changes of the snapshot. A reader can poll it without locking and copy the
+			// model only if it has changed since the last read.
+			size_t getVersion() const
+			{
+				return version.load(std::memory_order_acquire);
+			}
+
+		protected:
+			mutable std::mutex mutex; // Guards the model and its score
+			std::atomic<size_t> version; // The number of changes of the snapshot
+			bool has_model; // A flag saying if a model has been found in the current run
+			gcransac::Model model; // The so-far-the-best model
+			ModelScore score; // The score of the so-far-the-best model
+			double elapsed_seconds; // The time since the start of the run when the model was found
+		};
+	}
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+// The spans of the runs are recorded only if USE_TRACING is defined (see the USE_TRACING option of
+// CMake). Otherwise, the macros below are empty and a tracer given to MAGSAC stays empty as well.
+#ifdef USE_TRACING
+	#define MAGSAC_TRACE_CONCATENATE_(first_, second_) first_##second_
+	#define MAGSAC_TRACE_CONCATENATE(first_, second_) MAGSAC_TRACE_CONCATENATE_(first_, second_)
+	// Recording a span from this point until the end of the enclosing scope
+	#define MAGSAC_TRACE_SPAN(tracer_, name_) \
+		magsac::utils::TraceSpan MAGSAC_TRACE_CONCATENATE(trace_span_, __LINE__)(tracer_, name_)
+	// Recording a span with a value shown as its argument, e.g., the index of an IRLS iteration
+	#define MAGSAC_TRACE_SPAN_VALUE(tracer_, name_, value_name_, value_) \
+		magsac::utils::TraceSpan MAGSAC_TRACE_CONCATENATE(trace_span_, __LINE__)(tracer_, name_, value_name_, value_)
+	// Recording an instant event, e.g., an update of the so-far-the-best model
+	#define MAGSAC_TRACE_INSTANT(tracer_, name_, value_name_, value_) \
+		do { if ((tracer_) != nullptr) (tracer_)->recordInstant(name_, value_name_, value_); } while (false)
+#else
+	#define MAGSAC_TRACE_SPAN(tracer_, name_) do {} while (false)
+	#define MAGSAC_TRACE_SPAN_VALUE(tracer_, name_, value_name_, value_) do {} while (false)
+	#define MAGSAC_TRACE_INSTANT(tracer_, name_, value_name_, value_) do {} while (false)
+#endif
+
+namespace magsac
+{
+	namespace utils
+	{
+		// Recording the timeline of runs, i.e., the spans of the sampling, the model estimation, the
+		// sigma-consensus and the validity checks, into a ring buffer of fixed size. When the buffer
+		// is full, the oldest events are overwritten. The events can be written as a Chrome trace
+		// (JSON) to be opened in chrome://tracing or in Perfetto. The events can be recorded by
+		// multiple threads, but the trace must not be written or cleared while recording. Each slot
+		// of the buffer has a sequence number telling which event it holds and whether it is being
+		// written, thus, the threads whose events fall into the same slot do not write it together.
+		class RunTracer
+		{
+		public:
+			struct Event
+			{
+				const char *name; // The name of the event. It has to be a string literal.
+				const char *value_name; // The name of the value of the event or null if it has none
+				double value; // The value of the event, e.g., the score of a new so-far-the-best model
+				int64_t start_ns; // The start of the event in nanoseconds since the creation of the tracer
+				int64_t duration_ns; // The duration of the event in nanoseconds, -1 for instant events
+				uint32_t thread_idx; // The identifier of the recording thread
+			};
+
+			explicit RunTracer(const size_t capacity_ = 1 << 16) : // The maximum number of events kept
+				capacity(capacity_ > 0 ? capacity_ : 1),
+				events(new Event[capacity]),
+				sequences(new std::atomic<size_t>[capacity]),
+				next_event(0),
+				origin(std::chrono::steady_clock::now())
+			{
+				for (size_t slot = 0; slot < capacity; ++slot)
+					sequences[slot].store(0, std::memory_order_relaxed);
+			}
+
+			// The time since the creation of the tracer in nanoseconds
+			int64_t now() const
+			{
+				return std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - origin).count();
+			}
+
+			void recordSpan(
+				const char * const name_, // The name of the span
+				const int64_t start_ns_, // The start of the span obtained by now()
+				const char * const value_name_ = nullptr, // The name of the value, if there is one
+				const double value_ = 0.0) // The value of the span
+			{
+				record(name_, value_name_, value_, start_ns_, now() - start_ns_);
+			}
+
+			void recordInstant(
+				const char * const name_, // The name of the event
+				const char * const value_name_ = nullptr, // The name of the value, if there is one
+				const double value_ = 0.0) // The value of the event
+			{
+				record(name_, value_name_, value_, now(), -1);
+			}
+
+			// The number of events kept in the buffer
+			size_t getEventNumber() const
+			{
+				return std::min(next_event.load(std::memory_order_relaxed), capacity);
+			}
+
+			// The number of events overwritten since the buffer was full
+			size_t getDroppedEventNumber() const
+			{
+				const size_t recorded_number = next_event.load(std::memory_order_relaxed);
+				return recorded_number > capacity ? recorded_number - capacity : 0;
+			}
+
+			void clear()
+			{
+				for (size_t slot = 0; slot < capacity; ++slot)
+					sequences[slot].store(0, std::memory_order_relaxed);
+				next_event.store(0, std::memory_order_relaxed);
+			}
+
+			// Writing the kept events in the Chrome trace-event format
+			bool writeChromeTrace(const std::string &path_) const
+			{
+				FILE * const file = fopen(path_.c_str(), "w");
+				if (file == nullptr)
+				{
+					fprintf(stderr, "The trace cannot be written to '%s'.\n", path_.c_str());
+					return false;
+				}
+
+				const size_t recorded_number = next_event.load(std::memory_order_acquire);
+				const size_t event_number = std::min(recorded_number, capacity);
+				fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+				bool is_first = true;
+				for (size_t position = 0; position < event_number; ++position)
+				{
+					// Write the events from the oldest one kept. The slots whose event has not been
+					// completed are skipped.
+					const size_t event_idx = recorded_number - event_number + position;
+					if (sequences[event_idx % capacity].load(std::memory_order_acquire) != completedSequence(event_idx))
+						continue;
+					const Event &event = events[event_idx % capacity];
+					fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"magsac\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,",
+						is_first ? "" : ",",
+						event.name,
+						event.thread_idx,
+						event.start_ns / 1000.0);
+					if (event.duration_ns >= 0)
+						fprintf(file, "\"ph\":\"X\",\"dur\":%.3f", event.duration_ns / 1000.0);
+					else
+						fprintf(file, "\"ph\":\"i\",\"s\":\"t\"");
+					if (event.value_name != nullptr)
+						fprintf(file, ",\"args\":{\"%s\":%.17g}", event.value_name, event.value);
+					fprintf(file, "}");
+					is_first = false;
+				}
+				fprintf(file, "\n]}\n");
+				return fclose(file) == 0;
+			}
+
+		protected:
+			const size_t capacity; // The maximum number of events kept
+			std::unique_ptr<Event[]> events; // The ring buffer of the events
+			// The sequence number of each slot. It is 2 * i + 1 while the i-th event is written into the
+			// slot, 2 * i + 2 once it has been written, and 0 if the slot has not been used.
+			std::unique_ptr<std::atomic<size_t>[]> sequences;
+			std::atomic<size_t> next_event; // The number of events recorded so far
+			const std::chrono::steady_clock::time_point origin; // The time from which the events are measured
+
+			static size_t completedSequence(const size_t event_idx_)
+			{
+				return 2 * event_idx_ + 2;
+			}
+
+			void record(
+				const char * const name_,
+				const char * const value_name_,
+				const double value_,
+				const int64_t start_ns_,
+				const int64_t duration_ns_)
+			{
+				const size_t event_idx = next_event.fetch_add(1, std::memory_order_relaxed);
+				std::atomic<size_t> &sequence = sequences[event_idx % capacity];
+
+				// Take the slot unless a later event has already taken it, in which case this event is
+				// dropped. If an earlier event is being written into the slot, wait until it is done.
+				size_t current_sequence = sequence.load(std::memory_order_acquire);
+				while (true)
+				{
+					if (current_sequence >= 2 * event_idx + 1)
+						return;
+					if (current_sequence % 2 == 1)
+					{
+						std::this_thread::yield();
+						current_sequence = sequence.load(std::memory_order_acquire);
+					}
+					else if (sequence.compare_exchange_weak(current_sequence, 2 * event_idx + 1,
+						std::memory_order_acquire, std::memory_order_acquire))
+						break;
+				}
+
+				Event &event = events[event_idx % capacity];
+				event.name = name_;
+				event.value_name = value_name_;
+				event.value = value_;
+				event.start_ns = start_ns_;
+				event.duration_ns = duration_ns_;
+				event.thread_idx = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xffff);
+				sequence.store(completedSequence(event_idx), std::memory_order_release);
+			}
+		};
+
+		// Recording a span of a tracer from its construction until its destruction. Nothing is
+		// measured if no tracer is given.
+		class TraceSpan
+		{
+		public:
+			TraceSpan(
+				RunTracer * const tracer_, // The tracer, or null
+				const char * const name_, // The name of the span. It has to be a string literal.
+				const char * const value_name_ = nullptr, // The name of the value of the span, if there is one
+				const double value_ = 0.0) : // The value of the span
+				tracer(tracer_),
+				name(name_),
+				value_name(value_name_),
+				value(value_),
+				start_ns(tracer_ != nullptr ? tracer_->now() : 0)
+			{
+			}
+
+			~TraceSpan()
+			{
+				if (tracer != nullptr)
+					tracer->recordSpan(name, start_ns, value_name, value);
+			}
+
+			TraceSpan(const TraceSpan &) = delete;
+			TraceSpan &operator=(const TraceSpan &) = delete;
+
+		protected:
+			RunTracer * const tracer;
+			const char * const name;
+			const char * const value_name;
+			const double value;
+			const int64_t start_ns;
+		};
+	}
+}
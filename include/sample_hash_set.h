@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "hashing.h"
+
+namespace magsac
+{
+	namespace utils
+	{
+		// A compact hash set storing the minimal samples which have already been evaluated.
+		// A sample is stored as a 64-bit fingerprint of its point indices, thus, the order of the
+		// indices does not matter and the memory used is bounded by the capacity. Two different samples
+		// are considered to be the same only if their fingerprints collide which happens with a negligible
+		// probability. When the set gets full, it is emptied and it starts storing the new samples.
+		class SampleHashSet
+		{
+		public:
+			SampleHashSet() : element_number(0), maximum_element_number(0), mask(0)
+			{
+			}
+
+			// Setting the maximum number of samples stored and emptying the set.
+			// The table is allocated with twice the size to keep the probe sequences short.
+			void initialize(const size_t capacity_)
+			{
+				size_t table_size = 16;
+				while (table_size < 2 * capacity_)
+					table_size <<= 1;
+
+				table.assign(table_size, 0);
+				mask = table_size - 1;
+				element_number = 0;
+				maximum_element_number = capacity_;
+			}
+
+			// Emptying the set while keeping the allocated memory
+			void clear()
+			{
+				if (element_number > 0)
+					std::fill(table.begin(), table.end(), 0);
+				element_number = 0;
+			}
+
+			bool empty() const
+			{
+				return element_number == 0;
+			}
+
+			// Inserting a sample into the set. It returns false if the sample has already been stored.
+			bool insert(
+				const size_t * const sample_, // The point indices of the sample
+				const size_t sample_size_) // The size of the sample
+			{
+				const uint64_t fingerprint = fingerprintIndexSet(sample_, sample_size_);
+
+				// Look for the fingerprint by linear probing
+				size_t position = static_cast<size_t>(fingerprint) & mask;
+				while (table[position] != 0)
+				{
+					if (table[position] == fingerprint)
+						return false;
+					position = (position + 1) & mask;
+				}
+
+				// Start again with an empty set if the set is full
+				if (element_number >= maximum_element_number)
+				{
+					clear();
+					position = static_cast<size_t>(fingerprint) & mask;
+				}
+
+				table[position] = fingerprint;
+				++element_number;
+				return true;
+			}
+
+		protected:
+			std::vector<uint64_t> table; // The open-addressing hash table of the fingerprints. Zero marks an empty slot.
+			size_t element_number; // The number of stored samples
+			size_t maximum_element_number; // The maximum number of stored samples
+			size_t mask; // The mask selecting a position in the table from a fingerprint
+		};
+	}
+}
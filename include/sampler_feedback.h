@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace magsac
+{
+	namespace sampler
+	{
+		// The interface of the samplers which do not select the minimal samples uniformly. The number
+		// of iterations MAGSAC needs is calculated assuming uniform sampling, thus, such samplers have to
+		// provide their own termination criterion. MAGSAC finds the interface by dynamic_cast, lets the sampler
+		// prepare at the start of each run and asks for the number of iterations whenever the so-far-the-best
+		// model changes. Such samplers refer to the indices of the points passed to MAGSAC::run, thus, MAGSAC
+		// refuses to use them with the point compression and the coarse-to-fine mode. The sampler derives from
+		// gcransac::sampler::Sampler as usual and from this class in addition.
+		class IterationFeedback
+		{
+		public:
+			virtual ~IterationFeedback() {}
+
+			// Called at the start of every run with the sampling pool of the run, before the first sample
+			// is selected. The state of the previous run, e.g., the number of samples, is dropped.
+			virtual void prepare(
+				const std::vector<size_t> &pool_, // The indices of the points from which the samples are selected
+				const size_t sample_size_) = 0; // The size of a minimal sample
+
+			// Returns the number of iterations required for finding an all-inlier sample with the given
+			// confidence given the inliers of the so-far-the-best model. If the criterion of the sampler
+			// is not met, the maximum of size_t is returned, i.e., the iteration number is not limited.
+			virtual size_t getRequiredIterationNumber(
+				const std::vector<bool> &inliers_, // The inlier flags of all points w.r.t. the so-far-the-best model
+				const size_t sample_size_, // The size of a minimal sample
+				const double log_confidence_) = 0; // The logarithm of 1 - the required confidence
+		};
+	}
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <vector>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+#endif
+
+namespace magsac
+{
+	namespace utils
+	{
+		// The assumed size of a cache line in bytes
+		constexpr size_t cache_line_size = 64;
+
+		// An allocator returning memory aligned to the cache line size. It is used for
+		// the flat weight buffers so that each per-thread row starts on its own cache line
+		// and the SIMD kernels can use aligned loads.
+		template <typename T, size_t _Alignment = cache_line_size>
+		class AlignedAllocator
+		{
+		public:
+			typedef T value_type;
+
+			template <typename U>
+			struct rebind { typedef AlignedAllocator<U, _Alignment> other; };
+
+			AlignedAllocator() noexcept {}
+
+			template <typename U>
+			AlignedAllocator(const AlignedAllocator<U, _Alignment> &) noexcept {}
+
+			T *allocate(const size_t n_)
+			{
+				// Round the size up to a multiple of the alignment as required by aligned_alloc
+				const size_t bytes = ((n_ * sizeof(T) + _Alignment - 1) / _Alignment) * _Alignment;
+#ifdef _WIN32
+				void *ptr = _aligned_malloc(bytes, _Alignment);
+#else
+				void *ptr = std::aligned_alloc(_Alignment, bytes);
+#endif
+				if (ptr == nullptr)
+					throw std::bad_alloc();
+				return static_cast<T *>(ptr);
+			}
+
+			void deallocate(T *ptr_, const size_t) noexcept
+			{
+#ifdef _WIN32
+				_aligned_free(ptr_);
+#else
+				std::free(ptr_);
+#endif
+			}
+
+			template <typename U>
+			bool operator==(const AlignedAllocator<U, _Alignment> &) const noexcept { return true; }
+
+			template <typename U>
+			bool operator!=(const AlignedAllocator<U, _Alignment> &) const noexcept { return false; }
+		};
+
+		// A vector whose data is aligned to the cache line size
+		template <typename T>
+		using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+		// The number of elements a row of the flat buffers has to contain so that
+		// every row starts on a new cache line.
+		constexpr size_t paddedRowLength(const size_t element_number_)
+		{
+			constexpr size_t elements_per_line = cache_line_size / sizeof(double);
+			return ((element_number_ + elements_per_line - 1) / elements_per_line) * elements_per_line;
+		}
+
+		// Constants of the exponential approximation. The argument is reduced as x = n * ln(2) + r
+		// with |r| <= ln(2) / 2, where ln(2) is split into a high and a low part (Cody-Waite reduction).
+		// exp(r) is approximated by its degree-12 Taylor polynomial whose truncation error is below
+		// |r|^13 / 13! < 1.8e-16. Together with the rounding errors of the evaluation, the relative
+		// error of the result stays below 1e-15 for every x in [-708, 0].
+		namespace exp_constants
+		{
+			constexpr double log2_e = 1.4426950408889634;
+			constexpr double ln2_high = 6.93145751953125e-1;
+			constexpr double ln2_low = 1.42860682030941723212e-6;
+			// Arguments below this value underflow to denormals and zero is returned instead
+			constexpr double minimum_argument = -708.0;
+			// Adding this value rounds a double to the nearest integer stored in the low bits of the mantissa
+			constexpr double rounding_magic = 6755399441055744.0; // 1.5 * 2^52
+			// The Taylor coefficients 1 / k! from k = 12 down to k = 0
+			constexpr double coefficients[] = {
+				2.08767569878680989792e-9, 2.50521083854417187751e-8, 2.75573192239858906526e-7,
+				2.75573192239858906526e-6, 2.48015873015873015873e-5, 1.98412698412698412698e-4,
+				1.38888888888888888889e-3, 8.33333333333333333333e-3, 4.16666666666666666667e-2,
+				1.66666666666666666667e-1, 5.0e-1, 1.0, 1.0 };
+			constexpr size_t coefficient_number = 13;
+		}
+
+		// Approximating exp(x_) for non-positive arguments. This is the scalar counterpart of
+		// the vectorized kernel below and it returns exactly the same values.
+		inline double expNonPositive(const double x_)
+		{
+			using namespace exp_constants;
+
+			if (x_ < minimum_argument)
+				return 0.0;
+
+			// Round x / ln(2) to the nearest integer
+			const double n = (x_ * log2_e + rounding_magic) - rounding_magic;
+			// The reduced argument
+			const double r = (x_ - n * ln2_high) - n * ln2_low;
+
+			// Evaluate the polynomial by Horner's method
+			double p = coefficients[0];
+			for (size_t i = 1; i < coefficient_number; ++i)
+				p = p * r + coefficients[i];
+
+			// Multiply the result by 2^n by constructing the double from its bits
+			const int64_t exponent = (static_cast<int64_t>(n) + 1023) << 52;
+			double scale;
+			std::memcpy(&scale, &exponent, sizeof(double));
+			return p * scale;
+		}
+
+		// The kernel calculating the Gaussian weights used in the partitions of the original MAGSAC:
+		//   weights_[i] += exp(-squared_residuals_[i] * multiplier_)
+		// where multiplier_ = 1 / (2 \sigma^2). It uses AVX2 or SSE2 if the compiler targets them
+		// and falls back to the scalar approximation otherwise. The pointers do not have to be aligned.
+		inline void accumulateGaussianWeights(
+			const double * const squared_residuals_, // The squared residuals of the points
+			const size_t point_number_, // The number of points
+			const double multiplier_, // The multiplier of the squared residuals, i.e., 1 / (2 \sigma^2)
+			double * const weights_) // The weights to which the probabilities are added
+		{
+			using namespace exp_constants;
+			size_t point_idx = 0;
+
+#if defined(__AVX2__)
+			const __m256d negative_multiplier = _mm256_set1_pd(-multiplier_);
+			const __m256d minimum = _mm256_set1_pd(minimum_argument);
+			const __m256d log2e = _mm256_set1_pd(log2_e);
+			const __m256d magic = _mm256_set1_pd(rounding_magic);
+			const __m256d c_high = _mm256_set1_pd(ln2_high);
+			const __m256d c_low = _mm256_set1_pd(ln2_low);
+			const __m256i bias = _mm256_set1_epi64x(1023);
+			const __m256i magic_bits = _mm256_castpd_si256(magic);
+
+			for (; point_idx + 4 <= point_number_; point_idx += 4)
+			{
+				const __m256d x = _mm256_mul_pd(_mm256_loadu_pd(squared_residuals_ + point_idx), negative_multiplier);
+				// Lanes which would underflow are set to zero at the end
+				const __m256d underflow = _mm256_cmp_pd(x, minimum, _CMP_LT_OQ);
+				const __m256d clamped = _mm256_max_pd(x, minimum);
+
+				// Round x / ln(2) to the nearest integer. The integer is stored in the low bits of 'shifted'.
+				const __m256d shifted = _mm256_add_pd(_mm256_mul_pd(clamped, log2e), magic);
+				const __m256d n = _mm256_sub_pd(shifted, magic);
+				const __m256d r = _mm256_sub_pd(_mm256_sub_pd(clamped, _mm256_mul_pd(n, c_high)), _mm256_mul_pd(n, c_low));
+
+				__m256d p = _mm256_set1_pd(coefficients[0]);
+				for (size_t i = 1; i < coefficient_number; ++i)
+					p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(coefficients[i]));
+
+				// Build 2^n from the integer part
+				const __m256i exponent = _mm256_slli_epi64(
+					_mm256_add_epi64(_mm256_sub_epi64(_mm256_castpd_si256(shifted), magic_bits), bias), 52);
+				const __m256d probabilities = _mm256_andnot_pd(underflow,
+					_mm256_mul_pd(p, _mm256_castsi256_pd(exponent)));
+
+				_mm256_storeu_pd(weights_ + point_idx,
+					_mm256_add_pd(_mm256_loadu_pd(weights_ + point_idx), probabilities));
+			}
+#elif defined(__SSE2__) || defined(_M_X64)
+			const __m128d negative_multiplier = _mm_set1_pd(-multiplier_);
+			const __m128d minimum = _mm_set1_pd(minimum_argument);
+			const __m128d log2e = _mm_set1_pd(log2_e);
+			const __m128d magic = _mm_set1_pd(rounding_magic);
+			const __m128d c_high = _mm_set1_pd(ln2_high);
+			const __m128d c_low = _mm_set1_pd(ln2_low);
+			const __m128i bias = _mm_set1_epi64x(1023);
+			const __m128i magic_bits = _mm_castpd_si128(magic);
+
+			for (; point_idx + 2 <= point_number_; point_idx += 2)
+			{
+				const __m128d x = _mm_mul_pd(_mm_loadu_pd(squared_residuals_ + point_idx), negative_multiplier);
+				// Lanes which would underflow are set to zero at the end
+				const __m128d underflow = _mm_cmplt_pd(x, minimum);
+				const __m128d clamped = _mm_max_pd(x, minimum);
+
+				// Round x / ln(2) to the nearest integer. The integer is stored in the low bits of 'shifted'.
+				const __m128d shifted = _mm_add_pd(_mm_mul_pd(clamped, log2e), magic);
+				const __m128d n = _mm_sub_pd(shifted, magic);
+				const __m128d r = _mm_sub_pd(_mm_sub_pd(clamped, _mm_mul_pd(n, c_high)), _mm_mul_pd(n, c_low));
+
+				__m128d p = _mm_set1_pd(coefficients[0]);
+				for (size_t i = 1; i < coefficient_number; ++i)
+					p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(coefficients[i]));
+
+				// Build 2^n from the integer part
+				const __m128i exponent = _mm_slli_epi64(
+					_mm_add_epi64(_mm_sub_epi64(_mm_castpd_si128(shifted), magic_bits), bias), 52);
+				const __m128d probabilities = _mm_andnot_pd(underflow,
+					_mm_mul_pd(p, _mm_castsi128_pd(exponent)));
+
+				_mm_storeu_pd(weights_ + point_idx,
+					_mm_add_pd(_mm_loadu_pd(weights_ + point_idx), probabilities));
+			}
+#endif
+
+			// Process the remaining points one-by-one
+			for (; point_idx < point_number_; ++point_idx)
+				weights_[point_idx] += expNonPositive(-squared_residuals_[point_idx] * multiplier_);
+		}
+	}
+}
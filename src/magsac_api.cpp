@@ -0,0 +1,89 @@
+#include "magsac_api.h"
+#include "magsac.h"
+#include "estimators.h"
+#include "uniform_sampler.h"
+
+// The instances of MAGSAC which the other translation units only declare (see estimators.h)
+template class MAGSAC<cv::Mat, magsac::utils::DefaultEssentialMatrixEstimator>;
+template class MAGSAC<cv::Mat, magsac::utils::DefaultFundamentalMatrixEstimator>;
+template class MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator>;
+template class MAGSAC<cv::Mat, magsac::estimator::FundamentalMatrixEstimator<
+	gcransac::estimator::solver::FundamentalMatrixPlaneParallaxSolver,
+	gcransac::estimator::solver::FundamentalMatrixEightPointSolver>>;
+
+namespace magsac
+{
+	namespace api
+	{
+		namespace
+		{
+			// Running MAGSAC(++) with the given estimator and a uniform sampler
+			template <class _Estimator>
+			bool run(
+				const cv::Mat &points_,
+				const Settings &settings_,
+				_Estimator &estimator_,
+				gcransac::Model &model_,
+				ModelScore &score_,
+				int &iteration_number_)
+			{
+				typedef MAGSAC<cv::Mat, _Estimator> Magsac;
+
+				Magsac magsac(settings_.use_magsac_plus_plus ?
+					Magsac::MAGSAC_PLUS_PLUS :
+					Magsac::MAGSAC_ORIGINAL);
+				magsac.setMaximumThreshold(settings_.maximum_threshold);
+				magsac.setIterationLimit(settings_.iteration_limit);
+				if (settings_.reference_threshold > 0.0)
+					magsac.setReferenceThreshold(settings_.reference_threshold);
+
+				gcransac::sampler::UniformSampler sampler(&points_);
+				return magsac.run(points_,
+					settings_.confidence,
+					estimator_,
+					sampler,
+					model_,
+					iteration_number_,
+					score_);
+			}
+		}
+
+		bool findHomography(
+			const cv::Mat &points_,
+			const Settings &settings_,
+			gcransac::Model &model_,
+			ModelScore &score_,
+			int &iteration_number_)
+		{
+			magsac::utils::DefaultHomographyEstimator estimator;
+			return run(points_, settings_, estimator, model_, score_, iteration_number_);
+		}
+
+		bool findFundamentalMatrix(
+			const cv::Mat &points_,
+			const Settings &settings_,
+			gcransac::Model &model_,
+			ModelScore &score_,
+			int &iteration_number_)
+		{
+			magsac::utils::DefaultFundamentalMatrixEstimator estimator(settings_.maximum_threshold);
+			return run(points_, settings_, estimator, model_, score_, iteration_number_);
+		}
+
+		bool findEssentialMatrix(
+			const cv::Mat &normalized_points_,
+			const Eigen::Matrix3d &intrinsics_source_,
+			const Eigen::Matrix3d &intrinsics_destination_,
+			const Settings &settings_,
+			gcransac::Model &model_,
+			ModelScore &score_,
+			int &iteration_number_)
+		{
+			magsac::utils::DefaultEssentialMatrixEstimator estimator(
+				intrinsics_source_,
+				intrinsics_destination_,
+				0.0);
+			return run(normalized_points_, settings_, estimator, model_, score_, iteration_number_);
+		}
+	}
+}
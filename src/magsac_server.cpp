@@ -0,0 +1,684 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "fast_uniform_sampler.h"
+#include "point_view.h"
+#include "metrics.h"
+#include "estimation_server.h"
+
+// A server keeping MAGSAC warm between the estimations of a batch job. Each worker thread owns its
+// MAGSAC objects, their run contexts, estimators and samplers, and the mappings of the shared memory
+// objects of its clients, thus, they are created only once and the requests only configure them.
+// The points are copied from the shared memory into the buffer of the worker, so a client truncating
+// its object cannot crash the server while the points are used.
+//
+// The main thread waits for the requests on all connections. A connection with a request is queued
+// until a worker is free, and the worker gives it back after answering the request. Thus, the idle
+// clients do not hold the workers.
+//
+// The metrics of the estimations are written to a file every second in the Prometheus text format
+// if its path is given.
+//
+// Usage: MAGSACServer [socket path = /tmp/magsac.sock] [worker number = hardware concurrency] [metrics file]
+
+namespace
+{
+	volatile sig_atomic_t stop_requested = 0; // Set by SIGINT and SIGTERM
+
+	void requestStop(int)
+	{
+		stop_requested = 1;
+	}
+
+	// The time within which a client has to send the rest of a started request and read a response,
+	// so a stalled client holds a worker only for a bounded time
+	constexpr int connection_timeout_seconds = 10;
+
+	// The time for which no connections are accepted after accept() failed, e.g., since the
+	// descriptors have run out
+	constexpr int accept_pause_milliseconds = 1000;
+
+	// The jump buffer of the worker thread copying the points of a request from a shared memory object.
+	// If the client truncates the object meanwhile, reading it raises SIGBUS and the handler returns
+	// to the worker through this buffer.
+	thread_local sigjmp_buf *bus_error_jump = nullptr;
+
+	void recoverFromBusError(int signal_)
+	{
+		if (bus_error_jump != nullptr)
+			siglongjmp(*bus_error_jump, 1);
+
+		// A bus error outside of the copying is not caused by a client, thus, the server terminates
+		signal(signal_, SIG_DFL);
+		raise(signal_);
+	}
+
+	// A shared memory object mapped into the server
+	struct SharedMemoryMapping
+	{
+		void *address = nullptr; // The start of the mapping
+		size_t size = 0; // The size of the mapping in bytes
+		ino_t inode = 0; // The identifier of the mapped object
+	};
+
+	// The MAGSAC objects of a problem type and their state kept between the requests
+	template <class _Estimator>
+	struct EstimationSlot
+	{
+		typedef MAGSAC<cv::Mat, _Estimator> Magsac;
+
+		Magsac original; // The original MAGSAC
+		Magsac plus_plus; // MAGSAC++
+		typename Magsac::RunContext context; // The scratch buffers of the runs
+		typename Magsac::RunOutput output; // The per-point data of the estimated model
+		double default_reference_threshold; // The reference threshold used when the request does not set it
+
+		explicit EstimationSlot(magsac::utils::EstimationMetrics &metrics_) :
+			original(Magsac::MAGSAC_ORIGINAL),
+			plus_plus(Magsac::MAGSAC_PLUS_PLUS),
+			default_reference_threshold(plus_plus.getReferenceThreshold())
+		{
+			// The workers already run in parallel
+			original.setCoreNumber(1);
+			original.setMetrics(&metrics_);
+			plus_plus.setMetrics(&metrics_);
+		}
+
+		// Configuring the MAGSAC selected by the request. The default reference threshold is given in
+		// pixels, thus, it is multiplied by the given value if the points are normalized.
+		const Magsac &configure(
+			const magsac::server::EstimationRequest &request_,
+			const double threshold_multiplier_)
+		{
+			Magsac &magsac = request_.use_magsac_plus_plus ? plus_plus : original;
+			magsac.setMaximumThreshold(request_.maximum_threshold);
+			magsac.setIterationLimit(request_.iteration_limit);
+			magsac.setReferenceThreshold(std::isfinite(request_.reference_threshold) && request_.reference_threshold > 0.0 ?
+				request_.reference_threshold :
+				default_reference_threshold * threshold_multiplier_);
+			return magsac;
+		}
+	};
+
+	class Worker
+	{
+	protected:
+		EstimationSlot<magsac::utils::DefaultHomographyEstimator> homography_slot;
+		EstimationSlot<magsac::utils::DefaultFundamentalMatrixEstimator> fundamental_matrix_slot;
+		EstimationSlot<magsac::utils::DefaultEssentialMatrixEstimator> essential_matrix_slot;
+		magsac::utils::DefaultHomographyEstimator homography_estimator;
+		// The fundamental matrix estimator depends on the maximum threshold. It is kept while the
+		// threshold does not change, so the state of its DEGENSAC is kept as well.
+		std::unique_ptr<magsac::utils::DefaultFundamentalMatrixEstimator> fundamental_matrix_estimator;
+		double fundamental_matrix_threshold;
+		magsac::utils::EstimationMetrics &fundamental_matrix_metrics; // The metrics to which the DEGENSAC checks are added
+		cv::Mat points; // The points of the current request copied from the shared memory
+		magsac::sampler::FastUniformSampler sampler; // The sampler used in all runs of the worker
+		std::unordered_map<std::string, SharedMemoryMapping> mappings; // The mapped shared memory objects by their names
+		static constexpr size_t maximum_mapping_number = 16; // The number of mappings kept by a worker
+
+		// Returning the mapping of a shared memory object which is at least as large as required.
+		// The mapping is reused while the object under the name is the same and it is not resized.
+		const SharedMemoryMapping *mapSharedMemory(
+			const std::string &name_,
+			const size_t required_size_)
+		{
+			const int descriptor = shm_open(name_.c_str(), O_RDONLY, 0);
+			if (descriptor < 0)
+			{
+				fprintf(stderr, "The shared memory object '%s' cannot be opened (%s).\n", name_.c_str(), strerror(errno));
+				return nullptr;
+			}
+
+			struct stat status;
+			if (fstat(descriptor, &status) < 0 ||
+				static_cast<size_t>(status.st_size) < required_size_)
+			{
+				fprintf(stderr, "The shared memory object '%s' is smaller than the points of the request.\n", name_.c_str());
+				close(descriptor);
+				return nullptr;
+			}
+
+			// Clients using a new object for each job would make the mappings accumulate, and the
+			// memory of the unlinked objects is only released when they are unmapped
+			if (mappings.size() >= maximum_mapping_number &&
+				mappings.find(name_) == mappings.end())
+			{
+				for (const auto &mapping : mappings)
+					munmap(mapping.second.address, mapping.second.size);
+				mappings.clear();
+			}
+
+			SharedMemoryMapping &mapping = mappings[name_];
+			if (mapping.address != nullptr &&
+				mapping.inode == status.st_ino &&
+				mapping.size == static_cast<size_t>(status.st_size))
+			{
+				close(descriptor);
+				return &mapping;
+			}
+
+			if (mapping.address != nullptr)
+				munmap(mapping.address, mapping.size);
+			mapping.address = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+			close(descriptor);
+			if (mapping.address == MAP_FAILED)
+			{
+				fprintf(stderr, "The shared memory object '%s' cannot be mapped (%s).\n", name_.c_str(), strerror(errno));
+				mappings.erase(name_);
+				return nullptr;
+			}
+			mapping.size = status.st_size;
+			mapping.inode = status.st_ino;
+			return &mapping;
+		}
+
+		// Unmapping a shared memory object, e.g., since it has been truncated by the client
+		void unmapSharedMemory(const std::string &name_)
+		{
+			const auto mapping = mappings.find(name_);
+			if (mapping == mappings.end())
+				return;
+			munmap(mapping->second.address, mapping->second.size);
+			mappings.erase(mapping);
+		}
+
+		// Copying the points from the shared memory. It returns false if the object has been truncated
+		// by the client since it was mapped, i.e., reading it raised SIGBUS.
+		bool copySharedPoints(const cv::Mat &shared_points_)
+		{
+			points.create(shared_points_.rows, shared_points_.cols, CV_64F);
+
+			sigjmp_buf jump;
+			if (sigsetjmp(jump, 1) != 0)
+			{
+				bus_error_jump = nullptr;
+				return false;
+			}
+			bus_error_jump = &jump;
+			for (int row = 0; row < shared_points_.rows; ++row)
+				memcpy(points.ptr<double>(row), shared_points_.ptr<double>(row), shared_points_.cols * sizeof(double));
+			bus_error_jump = nullptr;
+			return true;
+		}
+
+		// Running the estimation and filling the response from its results
+		template <class _Estimator>
+		void estimate(
+			EstimationSlot<_Estimator> &slot_,
+			_Estimator &estimator_,
+			const magsac::server::EstimationRequest &request_,
+			magsac::server::EstimationResponse &response_,
+			const std::vector<uint64_t> *&inlier_mask_,
+			const double threshold_multiplier_ = 1.0)
+		{
+			const auto &magsac = slot_.configure(request_, threshold_multiplier_);
+
+			gcransac::Model model;
+			ModelScore score;
+			int iteration_number = 0;
+
+			const auto start = std::chrono::steady_clock::now();
+			const bool success = magsac.run(points,
+				request_.confidence,
+				estimator_,
+				sampler,
+				model,
+				iteration_number,
+				score,
+				slot_.context,
+				&slot_.output);
+			const std::chrono::duration<double> elapsed_seconds = std::chrono::steady_clock::now() - start;
+
+			response_.status = success ? magsac::server::Success : magsac::server::NoModel;
+			response_.iteration_number = iteration_number;
+			response_.score = score.score;
+			response_.elapsed_seconds = elapsed_seconds.count();
+
+			if (!success)
+				return;
+
+			const Eigen::MatrixXd &descriptor = model.descriptor;
+			for (size_t row = 0; row < 3 && row < static_cast<size_t>(descriptor.rows()); ++row)
+				for (size_t col = 0; col < 3 && col < static_cast<size_t>(descriptor.cols()); ++col)
+					response_.model[row * 3 + col] = descriptor(row, col);
+
+			for (const uint64_t word : slot_.output.inlier_mask)
+				response_.inlier_number += __builtin_popcountll(word);
+
+			if (request_.return_inlier_mask)
+			{
+				inlier_mask_ = &slot_.output.inlier_mask;
+				response_.inlier_mask_word_number = static_cast<uint32_t>(slot_.output.inlier_mask.size());
+			}
+		}
+
+		// Processing a request
+		void process(
+			const magsac::server::EstimationRequest &request_,
+			magsac::server::EstimationResponse &response_,
+			const std::vector<uint64_t> *&inlier_mask_)
+		{
+			memset(&response_, 0, sizeof(response_));
+			response_.magic = magsac::server::protocol_magic;
+			response_.status = magsac::server::InvalidRequest;
+			inlier_mask_ = nullptr;
+
+			const bool is_name_valid =
+				memchr(request_.shared_memory_name, 0, magsac::server::shared_memory_name_length) != nullptr;
+			if (request_.magic != magsac::server::protocol_magic ||
+				!is_name_valid ||
+				request_.problem_type > magsac::server::EssentialMatrix ||
+				request_.dimension < 4 ||
+				request_.stride < request_.dimension ||
+				request_.stride > magsac::server::maximum_stride ||
+				request_.point_number == 0 ||
+				request_.point_number > static_cast<uint64_t>(std::numeric_limits<int>::max()) ||
+				request_.offset % sizeof(double) != 0 ||
+				!std::isfinite(request_.maximum_threshold) ||
+				request_.maximum_threshold <= 0.0 ||
+				!(request_.confidence > 0.0 && request_.confidence < 1.0))
+				return;
+
+			// The size of the points cannot overflow given the bounds above, but the offset is arbitrary
+			size_t required_size;
+			if (__builtin_add_overflow(request_.offset,
+				request_.point_number * request_.stride * sizeof(double),
+				&required_size))
+				return;
+			const SharedMemoryMapping * const mapping = mapSharedMemory(request_.shared_memory_name, required_size);
+			if (mapping == nullptr)
+			{
+				response_.status = magsac::server::SharedMemoryError;
+				return;
+			}
+
+			const cv::Mat shared_points = magsac::utils::wrapPoints(magsac::utils::PointView(
+				reinterpret_cast<const double *>(static_cast<const char *>(mapping->address) + request_.offset),
+				request_.point_number,
+				request_.dimension,
+				request_.stride));
+			if (!copySharedPoints(shared_points))
+			{
+				fprintf(stderr, "The shared memory object '%s' has been truncated while reading the points.\n", request_.shared_memory_name);
+				unmapSharedMemory(request_.shared_memory_name);
+				response_.status = magsac::server::SharedMemoryError;
+				return;
+			}
+
+			switch (request_.problem_type)
+			{
+			case magsac::server::Homography:
+				estimate(homography_slot, homography_estimator, request_, response_, inlier_mask_);
+				break;
+			case magsac::server::FundamentalMatrix:
+				if (fundamental_matrix_estimator == nullptr ||
+					fundamental_matrix_threshold != request_.maximum_threshold)
+				{
+					fundamental_matrix_estimator = std::unique_ptr<magsac::utils::DefaultFundamentalMatrixEstimator>(
+						new magsac::utils::DefaultFundamentalMatrixEstimator(request_.maximum_threshold));
+					fundamental_matrix_estimator->setMetrics(&fundamental_matrix_metrics);
+					fundamental_matrix_threshold = request_.maximum_threshold;
+				}
+				estimate(fundamental_matrix_slot, *fundamental_matrix_estimator, request_, response_, inlier_mask_);
+				break;
+			case magsac::server::EssentialMatrix:
+			{
+				const Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor>>
+					intrinsics_source(request_.intrinsics_source),
+					intrinsics_destination(request_.intrinsics_destination);
+
+				// The points and the thresholds of the request are normalized by the intrinsics, thus, the
+				// default reference threshold is normalized by the average of the focal lengths as well
+				const double average_focal_length = (intrinsics_source(0, 0) + intrinsics_source(1, 1) +
+					intrinsics_destination(0, 0) + intrinsics_destination(1, 1)) / 4.0;
+				if (!std::isfinite(average_focal_length) ||
+					average_focal_length <= 0.0)
+				{
+					response_.status = magsac::server::InvalidRequest;
+					return;
+				}
+
+				magsac::utils::DefaultEssentialMatrixEstimator estimator(
+					intrinsics_source,
+					intrinsics_destination,
+					0.0);
+				estimate(essential_matrix_slot, estimator, request_, response_, inlier_mask_, 1.0 / average_focal_length);
+				break;
+			}
+			}
+		}
+
+	public:
+		Worker(magsac::utils::MetricsRegistry &metrics_registry_, const uint64_t seed_, const size_t stream_) :
+			homography_slot(metrics_registry_.getEstimationMetrics("homography")),
+			fundamental_matrix_slot(metrics_registry_.getEstimationMetrics("fundamental_matrix")),
+			essential_matrix_slot(metrics_registry_.getEstimationMetrics("essential_matrix")),
+			fundamental_matrix_threshold(0.0),
+			fundamental_matrix_metrics(metrics_registry_.getEstimationMetrics("fundamental_matrix")),
+			sampler(&points, seed_, stream_)
+		{
+		}
+
+		~Worker()
+		{
+			for (const auto &mapping : mappings)
+				munmap(mapping.second.address, mapping.second.size);
+		}
+
+		// Answering the next request of a connection. It returns false if the connection has been closed
+		// by the client or it has failed.
+		bool serve(const int connection_)
+		{
+			magsac::server::EstimationRequest request;
+			magsac::server::EstimationResponse response;
+			const std::vector<uint64_t> *inlier_mask;
+
+			if (!magsac::server::receiveAll(connection_, &request, sizeof(request)))
+				return false;
+			process(request, response, inlier_mask);
+			if (!magsac::server::sendAll(connection_, &response, sizeof(response)))
+				return false;
+			return inlier_mask == nullptr ||
+				magsac::server::sendAll(connection_, inlier_mask->data(), inlier_mask->size() * sizeof(uint64_t));
+		}
+	};
+
+	// The connections whose request is waiting for a free worker, and the ones whose request has been
+	// answered and whose next request is waited for by the main thread
+	class RequestQueue
+	{
+	protected:
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<int> pending_connections; // The connections with a request waiting for a worker
+		std::vector<int> answered_connections; // The connections given back by the workers
+		int wake_pipe[2] = { -1, -1 }; // Written by the workers to wake the main thread waiting in poll()
+		bool is_closed = false;
+
+	public:
+		~RequestQueue()
+		{
+			for (const int descriptor : wake_pipe)
+				if (descriptor >= 0)
+					::close(descriptor);
+		}
+
+		bool open()
+		{
+			return pipe(wake_pipe) == 0 &&
+				fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK) == 0 &&
+				fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK) == 0;
+		}
+
+		// The descriptor which becomes readable when a connection is given back
+		int getWakeDescriptor() const
+		{
+			return wake_pipe[0];
+		}
+
+		// Queuing a connection whose request can be read
+		void push(const int connection_)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				pending_connections.emplace_back(connection_);
+			}
+			condition.notify_one();
+		}
+
+		// Returns -1 when the queue is closed
+		int pop()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this] { return is_closed || !pending_connections.empty(); });
+			if (pending_connections.empty())
+				return -1;
+			const int connection = pending_connections.front();
+			pending_connections.pop_front();
+			return connection;
+		}
+
+		// Giving back a connection returned by pop() when its request has been answered
+		void giveBack(const int connection_)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (is_closed)
+				{
+					::close(connection_);
+					return;
+				}
+				answered_connections.emplace_back(connection_);
+			}
+
+			// If the pipe is full, the main thread is woken up anyway
+			const char wake_byte = 0;
+			const ssize_t written = write(wake_pipe[1], &wake_byte, 1);
+			(void)written;
+		}
+
+		// Appending the connections given back by the workers to the given ones
+		void takeAnswered(std::vector<int> &connections_)
+		{
+			char buffer[64];
+			while (read(wake_pipe[0], buffer, sizeof(buffer)) > 0)
+				;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			connections_.insert(connections_.end(), answered_connections.begin(), answered_connections.end());
+			answered_connections.clear();
+		}
+
+		// Closing the queue and the connections in it. The workers close the connections they are
+		// serving after answering the current request.
+		void close()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				is_closed = true;
+				for (const int connection : pending_connections)
+					::close(connection);
+				pending_connections.clear();
+				for (const int connection : answered_connections)
+					::close(connection);
+				answered_connections.clear();
+			}
+			condition.notify_all();
+		}
+	};
+}
+
+int main(int argc, const char* argv[])
+{
+	const std::string socket_path = argc > 1 ? argv[1] : "/tmp/magsac.sock";
+	const size_t worker_number = argc > 2 ?
+		std::max(1, atoi(argv[2])) :
+		std::max(1u, std::thread::hardware_concurrency());
+	const std::string metrics_path = argc > 3 ? argv[3] : "";
+
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(address.sun_path))
+	{
+		fprintf(stderr, "The socket path '%s' is too long.\n", socket_path.c_str());
+		return -1;
+	}
+	strcpy(address.sun_path, socket_path.c_str());
+
+	// The listening socket does not block, so a connection closed before it is accepted does not stop the main thread
+	const int listening_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+	unlink(socket_path.c_str());
+	if (listening_socket < 0 ||
+		fcntl(listening_socket, F_SETFL, O_NONBLOCK) < 0 ||
+		bind(listening_socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0 ||
+		listen(listening_socket, 64) < 0)
+	{
+		fprintf(stderr, "The server cannot listen on '%s' (%s).\n", socket_path.c_str(), strerror(errno));
+		return -1;
+	}
+
+	RequestQueue queue;
+	if (!queue.open())
+	{
+		fprintf(stderr, "The queue of the requests cannot be created (%s).\n", strerror(errno));
+		return -1;
+	}
+
+	// Stop on SIGINT and SIGTERM. The handler is installed without SA_RESTART, so poll() is interrupted.
+	// The signals are blocked while the threads are created, so they inherit the mask and only the main
+	// thread, waiting in poll(), receives them.
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = requestStop;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	// A bus error raised while copying the points of a truncated shared memory object returns to the worker
+	struct sigaction bus_error_action;
+	memset(&bus_error_action, 0, sizeof(bus_error_action));
+	bus_error_action.sa_handler = recoverFromBusError;
+	sigaction(SIGBUS, &bus_error_action, nullptr);
+
+	sigset_t stop_signals;
+	sigemptyset(&stop_signals);
+	sigaddset(&stop_signals, SIGINT);
+	sigaddset(&stop_signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+	// The workers are created before accepting connections, so the first requests are served warm
+	magsac::utils::MetricsRegistry metrics_registry;
+	std::vector<std::thread> threads;
+	threads.reserve(worker_number + 1);
+	for (size_t worker_idx = 0; worker_idx < worker_number; ++worker_idx)
+		threads.emplace_back([&queue, &metrics_registry, worker_idx]()
+		{
+			Worker worker(metrics_registry, 0, worker_idx);
+			int connection;
+			while ((connection = queue.pop()) >= 0)
+				if (worker.serve(connection))
+					queue.giveBack(connection);
+				else
+					close(connection);
+		});
+
+	if (!metrics_path.empty())
+		threads.emplace_back([&metrics_registry, &metrics_path]()
+		{
+			while (!stop_requested)
+			{
+				metrics_registry.writeToFile(metrics_path);
+				std::this_thread::sleep_for(std::chrono::seconds(1));
+			}
+			metrics_registry.writeToFile(metrics_path);
+		});
+
+	pthread_sigmask(SIG_UNBLOCK, &stop_signals, nullptr);
+
+	printf("Serving on '%s' with %d workers.\n", socket_path.c_str(), static_cast<int>(worker_number));
+	fflush(stdout);
+
+	// The connections whose next request is waited for
+	std::vector<int> idle_connections;
+	std::vector<pollfd> descriptors;
+	std::chrono::steady_clock::time_point accept_resume_time;
+	bool is_accept_paused = false;
+
+	while (!stop_requested)
+	{
+		queue.takeAnswered(idle_connections);
+
+		// The listening socket is left out while accepting is paused
+		descriptors.resize(2 + idle_connections.size());
+		descriptors[0] = { is_accept_paused ? -1 : listening_socket, POLLIN, 0 };
+		descriptors[1] = { queue.getWakeDescriptor(), POLLIN, 0 };
+		for (size_t connection_idx = 0; connection_idx < idle_connections.size(); ++connection_idx)
+			descriptors[2 + connection_idx] = { idle_connections[connection_idx], POLLIN, 0 };
+
+		int timeout = -1;
+		if (is_accept_paused)
+			timeout = static_cast<int>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::milliseconds>(
+				accept_resume_time - std::chrono::steady_clock::now()).count()));
+
+		if (poll(descriptors.data(), descriptors.size(), timeout) < 0)
+		{
+			if (errno != EINTR)
+				fprintf(stderr, "The connections cannot be polled (%s).\n", strerror(errno));
+			continue;
+		}
+
+		if (is_accept_paused &&
+			std::chrono::steady_clock::now() >= accept_resume_time)
+			is_accept_paused = false;
+
+		// Queue the connections with a request or closed by the client. The rest are kept in their order.
+		size_t kept_number = 0;
+		for (size_t connection_idx = 0; connection_idx < idle_connections.size(); ++connection_idx)
+			if (descriptors[2 + connection_idx].revents != 0)
+				queue.push(idle_connections[connection_idx]);
+			else
+				idle_connections[kept_number++] = idle_connections[connection_idx];
+		idle_connections.resize(kept_number);
+
+		if (descriptors[0].revents & POLLIN)
+		{
+			const int connection = accept(listening_socket, nullptr, nullptr);
+			if (connection >= 0)
+			{
+				// The connections are read by blocking calls, but some systems inherit O_NONBLOCK from the listening socket
+				fcntl(connection, F_SETFL, 0);
+				const timeval timeout_value = { connection_timeout_seconds, 0 };
+				setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout_value, sizeof(timeout_value));
+				setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout_value, sizeof(timeout_value));
+				idle_connections.emplace_back(connection);
+			}
+			else if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED)
+			{
+				// The failure, e.g., running out of descriptors (EMFILE), would repeat right away since the
+				// connection stays in the backlog, thus, accepting is paused instead of retrying it
+				fprintf(stderr, "A connection cannot be accepted (%s). Accepting is paused for %d ms.\n",
+					strerror(errno), accept_pause_milliseconds);
+				is_accept_paused = true;
+				accept_resume_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(accept_pause_milliseconds);
+			}
+		}
+	}
+
+	// The workers exit after answering their current request
+	close(listening_socket);
+	unlink(socket_path.c_str());
+	for (const int connection : idle_connections)
+		close(connection);
+	queue.close();
+	for (std::thread &thread : threads)
+		thread.join();
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include <cstdio>
+#include <cstdlib>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "cancellation_token.h"
+#include "run_observer.h"
+#include "uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+
+// Cancelling the run, in the middle of it, when a model with enough inliers has been found
+class CancellingObserver : public magsac::utils::RunObserver
+{
+public:
+	CancellingObserver(magsac::utils::CancellationToken &token_,
+		const size_t inlier_number_) : // The number of inliers of the model after which the run is cancelled
+		token(token_),
+		inlier_number(inlier_number_),
+		update_number(0)
+	{
+	}
+
+	void onBestModelUpdated(const magsac::utils::BestModelUpdate &update_) override
+	{
+		++update_number;
+		if (update_.inlier_number >= inlier_number)
+			token.cancel();
+	}
+
+	size_t getUpdateNumber() const
+	{
+		return update_number;
+	}
+
+protected:
+	magsac::utils::CancellationToken &token;
+	const size_t inlier_number;
+	size_t update_number;
+};
+
+int main()
+{
+	constexpr size_t iteration_limit = 100000; // High enough not to end the run before the cancellation
+	bool success = true;
+
+	cv::Mat points = magsac::test::generateHomographyCorrespondences(500, 0.5, 0.5, 1);
+	magsac::utils::DefaultHomographyEstimator estimator;
+	gcransac::sampler::UniformSampler sampler(&points);
+
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setReferenceThreshold(3.0);
+	magsac.setIterationLimit(iteration_limit);
+	magsac.setMinimumIterationNumber(iteration_limit);
+
+	HomographyMAGSAC::RunContext context;
+	magsac::utils::CancellationToken token;
+	CancellingObserver observer(token, 150);
+	context.observer = &observer;
+
+	// The run cancelled in the middle returns the model found before the cancellation
+	HomographyMAGSAC::AsyncRunResult result = magsac.runAsync(points,
+		0.99,
+		estimator,
+		sampler,
+		context,
+		token).get();
+	success &= check(result.status == HomographyMAGSAC::RunStatus::Cancelled, "the cancelled run is reported as cancelled");
+	success &= check(observer.getUpdateNumber() >= 1, "the run finds a model before the cancellation");
+	success &= check(result.score.score > 0, "the cancelled run returns the model found before");
+	success &= check(result.model.descriptor.rows() == 3 && result.model.descriptor.cols() == 3, "the returned model is a homography");
+	success &= check(result.iteration_number > 0 && static_cast<size_t>(result.iteration_number) < iteration_limit,
+		"the cancelled run stops before the iteration limit");
+	success &= check(context.statistics.is_cancelled, "the statistics of the context say that the run is cancelled");
+
+	// The returned model is close to the ground truth
+	if (result.score.score > 0)
+	{
+		size_t inlier_number = 0;
+		for (int point_idx = 0; point_idx < 250; ++point_idx)
+			if (estimator.residual(points.row(point_idx), result.model.descriptor) < 3.0)
+				++inlier_number;
+		success &= check(inlier_number > 200, "the model of the cancelled run fits the inliers");
+	}
+
+	// Reusing the context of the cancelled run, a run failing early is not reported as cancelled
+	context.observer = nullptr;
+	token.reset();
+	cv::Mat too_few_points = points.rowRange(0, 3).clone();
+	gcransac::sampler::UniformSampler too_few_points_sampler(&too_few_points);
+	result = magsac.runAsync(too_few_points,
+		0.99,
+		estimator,
+		too_few_points_sampler,
+		context,
+		token).get();
+	success &= check(result.status == HomographyMAGSAC::RunStatus::Failed, "the run without enough points fails");
+	success &= check(result.iteration_number == 0, "the run without enough points does no iterations");
+	success &= check(result.score.score == 0, "the run without enough points returns no model");
+	success &= check(!context.statistics.is_cancelled, "the statistics of the previous run are reset");
+
+	// A run which is not cancelled finishes
+	magsac.setMinimumIterationNumber(50);
+	result = magsac.runAsync(points,
+		0.99,
+		estimator,
+		sampler,
+		context,
+		token).get();
+	success &= check(result.status == HomographyMAGSAC::RunStatus::Success, "the run which is not cancelled succeeds");
+	success &= check(result.score.score > 0, "the run which is not cancelled returns a model");
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The asynchronous runs passed.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "batch_solvers.h"
+#include "fast_uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+using magsac::test::countInliers;
+using magsac::test::modelDistance;
+
+// Storing the points with a row step larger than their size, as a view into a wider matrix, so the
+// solvers have to address the points by their rows instead of assuming continuous data
+static cv::Mat makeStridedView(const cv::Mat &points_, std::vector<double> &buffer_)
+{
+	constexpr int row_length = 7; // The number of doubles per row of the wider matrix
+	buffer_.assign(static_cast<size_t>(points_.rows) * row_length, -1.0);
+	cv::Mat view(points_.rows, points_.cols, CV_64F, buffer_.data(), row_length * sizeof(double));
+	for (int point_idx = 0; point_idx < points_.rows; ++point_idx)
+		points_.row(point_idx).copyTo(view.row(point_idx));
+	return view;
+}
+
+// Drawing minimal samples of distinct points stored one after the other
+static std::vector<size_t> drawSamples(const size_t point_number_, const size_t sample_size_, const size_t sample_number_)
+{
+	std::mt19937 generator(7);
+	std::uniform_int_distribution<size_t> distribution(0, point_number_ - 1);
+	std::vector<size_t> samples;
+	samples.reserve(sample_size_ * sample_number_);
+	while (samples.size() < sample_size_ * sample_number_)
+	{
+		const size_t point_idx = distribution(generator);
+		const size_t sample_start = samples.size() - samples.size() % sample_size_;
+		if (std::find(samples.begin() + sample_start, samples.end(), point_idx) == samples.end())
+			samples.emplace_back(point_idx);
+	}
+	return samples;
+}
+
+// The batched four-point solver gives the homography of the per-sample solver for every sample
+static bool checkHomographySolver()
+{
+	constexpr size_t sample_number = 200;
+	bool success = true;
+
+	std::vector<double> buffer;
+	const cv::Mat points = makeStridedView(magsac::test::generateHomographyCorrespondences(100, 1.0, 0.0, 4), buffer);
+	success &= check(!points.isContinuous(), "the points of the homography test are not continuous");
+	const std::vector<size_t> samples = drawSamples(points.rows, 4, sample_number);
+
+	std::vector<gcransac::Model> batched_models;
+	std::vector<size_t> model_samples;
+	const size_t model_number = magsac::solver::HomographyFourPointBatchSolver().estimateModels(points,
+		samples.data(),
+		sample_number,
+		batched_models,
+		model_samples);
+	success &= check(model_number == sample_number, "the batched homography solver estimates a model for every sample");
+
+	const gcransac::estimator::solver::HomographyFourPointSolver solver;
+	for (size_t model_idx = 0; success && model_idx < model_number; ++model_idx)
+	{
+		std::vector<gcransac::Model> models;
+		success &= check(solver.estimateModel(points, &samples[4 * model_samples[model_idx]], 4, models) &&
+			models.size() == 1 &&
+			modelDistance(models[0].descriptor, batched_models[model_idx].descriptor) < 1e-6,
+			"the batched homography equals the one of the per-sample solver");
+	}
+	return success;
+}
+
+// The batched seven-point solver gives the fundamental matrices of the per-sample solver, except the ones
+// violating the oriented epipolar constraint, and it finds the true fundamental matrix in every sample
+static bool checkFundamentalMatrixSolver()
+{
+	constexpr size_t sample_number = 200;
+	bool success = true;
+
+	const magsac::test::CameraPair cameras;
+	const Eigen::Matrix3d true_fundamental_matrix = cameras.fundamentalMatrix();
+	std::vector<double> buffer;
+	const cv::Mat points = makeStridedView(magsac::test::generateFundamentalCorrespondences(cameras, 100, 1.0, 0.0, 5), buffer);
+	success &= check(!points.isContinuous(), "the points of the fundamental matrix test are not continuous");
+	const std::vector<size_t> samples = drawSamples(points.rows, 7, sample_number);
+
+	std::vector<gcransac::Model> batched_models;
+	std::vector<size_t> model_samples;
+	const size_t model_number = magsac::solver::FundamentalMatrixSevenPointBatchSolver().estimateModels(points,
+		samples.data(),
+		sample_number,
+		batched_models,
+		model_samples);
+
+	const gcransac::estimator::solver::FundamentalMatrixSevenPointSolver solver;
+	size_t model_idx = 0;
+	for (size_t sample_idx = 0; success && sample_idx < sample_number; ++sample_idx)
+	{
+		std::vector<gcransac::Model> models;
+		solver.estimateModel(points, &samples[7 * sample_idx], 7, models);
+
+		bool is_true_model_found = false;
+		for (; model_idx < model_number && model_samples[model_idx] == sample_idx; ++model_idx)
+		{
+			const Eigen::MatrixXd &batched_model = batched_models[model_idx].descriptor;
+			bool is_matched = false;
+			for (const gcransac::Model &model : models)
+				is_matched |= modelDistance(model.descriptor, batched_model) < 1e-6;
+			success &= check(is_matched, "the batched fundamental matrix is found by the per-sample solver");
+			is_true_model_found |= modelDistance(true_fundamental_matrix, batched_model) < 1e-6;
+		}
+		success &= check(is_true_model_found, "the batched solver finds the true fundamental matrix");
+	}
+	success &= check(model_idx == model_number, "the models of the batched solver are ordered by their samples");
+	return success;
+}
+
+// Running MAGSAC++ for a fixed number of iterations with a sampler of fixed seed, thus, the same
+// samples are drawn in the same order whatever the size of the blocks is
+static bool runWithBatchSize(const cv::Mat &points_,
+	const size_t sample_batch_size_,
+	gcransac::Model &model_,
+	int &iteration_number_,
+	ModelScore &score_)
+{
+	magsac::utils::DefaultHomographyEstimator estimator;
+	magsac::sampler::FastUniformSampler sampler(&points_, 8);
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setMinimumIterationNumber(320);
+	magsac.setIterationLimit(320);
+	magsac.setSampleBatchSize(sample_batch_size_);
+	return magsac.run(points_, 0.99, estimator, sampler, model_, iteration_number_, score_);
+}
+
+// The models of a block are verified in the order of their samples and each is recorded with the
+// iteration in which its sample was drawn, thus, the run is the same as the one without blocks
+static bool checkBatchedRun()
+{
+	const cv::Mat points = magsac::test::generateHomographyCorrespondences(500, 0.5, 0.5, 26);
+	magsac::utils::DefaultHomographyEstimator estimator;
+	gcransac::Model model, batched_model;
+	int iteration_number, batched_iteration_number;
+	ModelScore score, batched_score;
+
+	bool success = check(runWithBatchSize(points, 1, model, iteration_number, score), "the run without blocks");
+	success &= check(runWithBatchSize(points, 16, batched_model, batched_iteration_number, batched_score), "the run with blocks of 16 samples");
+	success &= check(batched_iteration_number == iteration_number, "the samples of the blocks are counted as iterations");
+	success &= check(batched_score.iteration == score.iteration &&
+		batched_score.iteration % 16 != 0, "the model is recorded with the iteration of its sample");
+	success &= check(modelDistance(model.descriptor, batched_model.descriptor) < 1e-6 &&
+		countInliers(estimator, points, batched_model, 250) > 0.95 * 250 &&
+		modelDistance(batched_model.descriptor, magsac::test::groundTruthHomography()) < 0.01,
+		"the run with blocks returns the model of the one without them");
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+	success &= checkHomographySolver();
+	success &= checkFundamentalMatrixSolver();
+	success &= checkBatchedRun();
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The batched solvers passed.\n");
+	return EXIT_SUCCESS;
+}
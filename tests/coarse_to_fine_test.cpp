@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "fast_uniform_sampler.h"
+#include "run_observer.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+using magsac::test::check;
+using magsac::test::countInliers;
+using magsac::test::modelDistance;
+
+// The default homography estimator which rejects every sample of the points having fewer rows than
+// the given number. In the coarse-to-fine mode, no model is found on the subsample, thus, the model
+// is searched on all points. The default estimator is final, therefore, it is wrapped.
+class SubsampleRejectingEstimator
+{
+public:
+	typedef magsac::utils::DefaultHomographyEstimator Estimator;
+
+	explicit SubsampleRejectingEstimator(const int point_number_) :
+		point_number(point_number_)
+	{
+	}
+
+	static constexpr size_t sampleSize() { return Estimator::sampleSize(); }
+	static constexpr size_t getDegreesOfFreedom() { return Estimator::getDegreesOfFreedom(); }
+	static constexpr double getSigmaQuantile() { return Estimator::getSigmaQuantile(); }
+	static constexpr double getC() { return Estimator::getC(); }
+	static constexpr double getUpperIncompleteGammaOfK() { return Estimator::getUpperIncompleteGammaOfK(); }
+	static constexpr double getLowerIncompleteGammaOfK() { return Estimator::getLowerIncompleteGammaOfK(); }
+
+	double residual(const cv::Mat &point_, const gcransac::Model &model_) const { return estimator.residual(point_, model_); }
+	double squaredResidual(const cv::Mat &point_, const gcransac::Model &model_) const { return estimator.squaredResidual(point_, model_); }
+	double residualForScoring(const cv::Mat &point_, const gcransac::Model &model_) const { return estimator.residualForScoring(point_, model_); }
+
+	bool estimateModel(const cv::Mat &data_,
+		const size_t *sample_,
+		std::vector<gcransac::Model> *models_) const
+	{
+		return estimator.estimateModel(data_, sample_, models_);
+	}
+
+	bool estimateModelNonminimal(const cv::Mat &data_,
+		const size_t *sample_,
+		const size_t sample_number_,
+		std::vector<gcransac::Model> *models_,
+		const double *weights_ = nullptr) const
+	{
+		return estimator.estimateModelNonminimal(data_, sample_, sample_number_, models_, weights_);
+	}
+
+	bool isValidSample(const cv::Mat &data_, const size_t *sample_) const
+	{
+		return data_.rows >= point_number &&
+			estimator.isValidSample(data_, sample_);
+	}
+
+	bool isValidModel(gcransac::Model &model_,
+		const cv::Mat &data_,
+		const std::vector<size_t> &inliers_,
+		const size_t *minimal_sample_,
+		const double threshold_,
+		bool &model_updated_) const
+	{
+		return estimator.isValidModel(model_, data_, inliers_, minimal_sample_, threshold_, model_updated_);
+	}
+
+private:
+	Estimator estimator;
+	const int point_number; // The number of points on which the samples are accepted
+};
+
+// Recording the updates of the so-far-the-best model together with the models
+class RecordingObserver : public magsac::utils::RunObserver
+{
+public:
+	void onBestModelUpdated(const magsac::utils::BestModelUpdate &update_) override
+	{
+		updates.emplace_back(update_);
+		updates.back().model = nullptr;
+		models.emplace_back(update_.model->descriptor);
+	}
+
+	std::vector<magsac::utils::BestModelUpdate> updates; // The updates of the run
+	std::vector<Eigen::MatrixXd> models; // The model of each update
+};
+
+// Running MAGSAC++ in the coarse-to-fine mode with a subsample of 500 points and at most five
+// refinement iterations on all points
+template <class ModelEstimator>
+static bool runCoarseToFine(ModelEstimator &estimator_,
+	const cv::Mat &points_,
+	const size_t iteration_limit_,
+	gcransac::Model &model_,
+	int &iteration_number_,
+	RecordingObserver &observer_)
+{
+	typedef MAGSAC<cv::Mat, ModelEstimator> EstimatorMAGSAC;
+	magsac::sampler::FastUniformSampler sampler(&points_, 6);
+	EstimatorMAGSAC magsac(EstimatorMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setIterationLimit(iteration_limit_);
+	magsac.setCoarseToFine(500, 5);
+
+	typename EstimatorMAGSAC::RunContext context;
+	context.observer = &observer_;
+	ModelScore score;
+	return magsac.run(points_, 0.99, estimator_, sampler, model_, iteration_number_, score, context);
+}
+
+int main()
+{
+	bool success = true;
+	constexpr size_t inlier_number = 10000;
+	const cv::Mat points = magsac::test::generateHomographyCorrespondences(20000, 0.5, 0.5, 25);
+	magsac::utils::DefaultHomographyEstimator estimator;
+	gcransac::Model model;
+	int iteration_number;
+
+	// The model of the subsample is refined on all points
+	{
+		RecordingObserver observer;
+		success &= check(runCoarseToFine(estimator, points, 1000, model, iteration_number, observer) &&
+			!observer.updates.empty(), "the coarse-to-fine run");
+
+		// The scores of the coarse phase count the points of the subsample
+		size_t fine_update_idx = 0;
+		while (fine_update_idx < observer.updates.size() &&
+			observer.updates[fine_update_idx].inlier_number <= 500)
+			++fine_update_idx;
+		success &= check(fine_update_idx > 0, "the coarse model is found on the subsample");
+		if (fine_update_idx > 0)
+		{
+			gcransac::Model coarse_model;
+			coarse_model.descriptor = observer.models[fine_update_idx - 1];
+			success &= check(countInliers(estimator, points, coarse_model, inlier_number) > 0.9 * inlier_number,
+				"the coarse model is consistent with the inliers of all points");
+		}
+
+		// Each refinement on all points is an iteration and the refinement stops once it does not improve
+		const size_t fine_update_number = observer.updates.size() - fine_update_idx;
+		success &= check(fine_update_number > 0 && fine_update_number <= 5, "the coarse model is refined on all points");
+		for (size_t update_idx = fine_update_idx + 1; update_idx < observer.updates.size(); ++update_idx)
+			success &= check(observer.updates[update_idx].iteration == observer.updates[update_idx - 1].iteration + 1,
+				"the refinements are consecutive iterations");
+		success &= check(static_cast<size_t>(iteration_number) >= observer.updates.back().iteration &&
+			static_cast<size_t>(iteration_number) <= observer.updates.back().iteration + 1,
+			"no model is searched on all points after the refinement");
+
+		success &= check(countInliers(estimator, points, model, inlier_number) > 0.95 * inlier_number &&
+			modelDistance(model.descriptor, magsac::test::groundTruthHomography()) < 0.01,
+			"the refined model");
+	}
+
+	// If no model is found on the subsample, the coarse phase uses up its iterations and the model
+	// is searched on all points
+	{
+		SubsampleRejectingEstimator rejecting_estimator(points.rows);
+		RecordingObserver observer;
+		success &= check(runCoarseToFine(rejecting_estimator, points, 200, model, iteration_number, observer) &&
+			!observer.updates.empty(), "the coarse-to-fine run without a coarse model");
+		success &= check(observer.updates.front().iteration > 200 &&
+			iteration_number > 200, "the model is searched on all points after the coarse phase");
+		success &= check(countInliers(estimator, points, model, inlier_number) > 0.95 * inlier_number &&
+			modelDistance(model.descriptor, magsac::test::groundTruthHomography()) < 0.01,
+			"the model of the search on all points");
+	}
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The coarse-to-fine runs passed.\n");
+	return EXIT_SUCCESS;
+}
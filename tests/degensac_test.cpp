@@ -0,0 +1,127 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "metrics.h"
+#include "fast_uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultFundamentalMatrixEstimator> FundamentalMatrixMAGSAC;
+
+using magsac::test::check;
+using magsac::test::countInliers;
+
+// Generating the correspondences of a scene dominated by a plane. The first planar_number_ points
+// lie on the plane at depth 6, the next parallax_number_ points are spread in depth and the rest
+// are uniform outliers.
+static cv::Mat generatePlanarSceneCorrespondences(
+	const magsac::test::CameraPair &cameras_, // The cameras
+	const size_t planar_number_, // The number of the points on the plane
+	const size_t parallax_number_, // The number of the points off the plane
+	const size_t outlier_number_, // The number of the outliers
+	const unsigned int seed_) // The seed of the random generator
+{
+	std::mt19937 generator(seed_);
+	std::uniform_real_distribution<double> lateral_distribution(-2.0, 2.0),
+		depth_distribution(3.0, 9.0),
+		coordinate_distribution(0.0, 1000.0);
+	std::normal_distribution<double> noise_distribution(0.0, 0.3);
+	const size_t point_number = planar_number_ + parallax_number_ + outlier_number_;
+
+	cv::Mat points(static_cast<int>(point_number), 4, CV_64F);
+	for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
+	{
+		double * const point = points.ptr<double>(static_cast<int>(point_idx));
+		if (point_idx < planar_number_ + parallax_number_)
+		{
+			const Eigen::Vector3d world_point(lateral_distribution(generator),
+				lateral_distribution(generator),
+				point_idx < planar_number_ ? 6.0 : depth_distribution(generator));
+			const Eigen::Vector3d projection_1 = cameras_.intrinsics * world_point,
+				projection_2 = cameras_.intrinsics * (cameras_.rotation * world_point + cameras_.translation);
+			point[0] = projection_1(0) / projection_1(2) + noise_distribution(generator);
+			point[1] = projection_1(1) / projection_1(2) + noise_distribution(generator);
+			point[2] = projection_2(0) / projection_2(2) + noise_distribution(generator);
+			point[3] = projection_2(1) / projection_2(2) + noise_distribution(generator);
+		}
+		else
+			for (size_t coordinate_idx = 0; coordinate_idx < 4; ++coordinate_idx)
+				point[coordinate_idx] = coordinate_distribution(generator);
+	}
+	return points;
+}
+
+// Estimating the fundamental matrix of a scene dominated by a plane. The models consistent only with
+// the plane are H-degenerate, thus, the estimation applies DEGENSAC.
+static bool checkEstimation(magsac::utils::DefaultFundamentalMatrixEstimator &estimator_,
+	const magsac::utils::EstimationMetrics &metrics_,
+	const cv::Mat &points_,
+	const size_t planar_number_,
+	const size_t parallax_number_,
+	const char * const name_,
+	const bool lazy_validity_check_ = false)
+{
+	const uint64_t previous_trigger_number = metrics_.counters[magsac::utils::EstimationMetrics::DegensacTriggerNumber].load();
+
+	magsac::sampler::FastUniformSampler sampler(&points_);
+	FundamentalMatrixMAGSAC magsac(FundamentalMatrixMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setIterationLimit(5000);
+	magsac.setLazyValidityCheck(lazy_validity_check_);
+
+	FundamentalMatrixMAGSAC::RunContext context;
+	gcransac::Model model;
+	int iteration_number;
+	ModelScore score;
+	bool success = check(magsac.run(points_, 0.99, estimator_, sampler, model, iteration_number, score, context) &&
+		countInliers(estimator_, points_, model, planar_number_ + parallax_number_) > 0.9 * planar_number_, name_);
+	success &= check(metrics_.counters[magsac::utils::EstimationMetrics::DegensacTriggerNumber].load() > previous_trigger_number,
+		"DEGENSAC is applied");
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+	const magsac::test::CameraPair cameras;
+	magsac::utils::MetricsRegistry registry;
+	magsac::utils::EstimationMetrics &metrics = registry.getEstimationMetrics("fundamental_matrix");
+
+	magsac::utils::DefaultFundamentalMatrixEstimator estimator(10.0);
+	estimator.setMetrics(&metrics);
+
+	// The state of the nested estimation is created when DEGENSAC is first applied
+	{
+		const cv::Mat points = generatePlanarSceneCorrespondences(cameras, 400, 40, 160, 14);
+		success &= checkEstimation(estimator, metrics, points, 400, 40, "the fundamental matrix of the first scene");
+	}
+
+	// The state of the nested estimation serves other points, possibly at the same address
+	{
+		const cv::Mat points = generatePlanarSceneCorrespondences(cameras, 200, 30, 70, 15);
+		success &= checkEstimation(estimator, metrics, points, 200, 30, "the fundamental matrix of the second scene");
+	}
+
+	// A copy of the estimator applies DEGENSAC by its own state
+	magsac::utils::DefaultFundamentalMatrixEstimator estimator_copy(estimator);
+	{
+		const cv::Mat points = generatePlanarSceneCorrespondences(cameras, 300, 40, 100, 16);
+		success &= checkEstimation(estimator_copy, metrics, points, 300, 40, "the fundamental matrix estimated by the copy");
+		success &= checkEstimation(estimator, metrics, points, 300, 40, "the fundamental matrix estimated after the copy");
+	}
+
+	// The models updated by DEGENSAC when the validity check is deferred are re-scored by their own inliers
+	{
+		const cv::Mat points = generatePlanarSceneCorrespondences(cameras, 400, 40, 160, 17);
+		success &= checkEstimation(estimator, metrics, points, 400, 40, "the fundamental matrix checked lazily", true);
+	}
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("DEGENSAC passed.\n");
+	return EXIT_SUCCESS;
+}
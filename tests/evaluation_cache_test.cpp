@@ -0,0 +1,100 @@
+#include <cstdio>
+#include <cstdlib>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "fast_uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultFundamentalMatrixEstimator> FundamentalMatrixMAGSAC;
+
+using magsac::test::check;
+using magsac::test::countInliers;
+using magsac::test::modelDistance;
+
+// Running MAGSAC++ with a sampler of fixed seed, thus, the runs differ only by the settings of the caches
+template <class ModelEstimator>
+static bool runWithCaches(ModelEstimator &estimator_,
+	const cv::Mat &points_,
+	const size_t required_iteration_number_,
+	const size_t duplicate_sample_capacity_,
+	const size_t refined_model_cache_size_,
+	gcransac::Model &model_,
+	int &iteration_number_,
+	typename MAGSAC<cv::Mat, ModelEstimator>::RunStatistics &statistics_)
+{
+	typedef MAGSAC<cv::Mat, ModelEstimator> EstimatorMAGSAC;
+	magsac::sampler::FastUniformSampler sampler(&points_, 3);
+	EstimatorMAGSAC magsac(EstimatorMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setMinimumIterationNumber(required_iteration_number_);
+	magsac.setIterationLimit(required_iteration_number_);
+	magsac.setDuplicateSampleDetection(duplicate_sample_capacity_);
+	magsac.setRefinedModelCache(refined_model_cache_size_);
+
+	typename EstimatorMAGSAC::RunContext context;
+	ModelScore score;
+	const bool success = magsac.run(points_, 0.99, estimator_, sampler, model_, iteration_number_, score, context);
+	statistics_ = context.statistics;
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+	magsac::utils::DefaultHomographyEstimator estimator;
+	gcransac::Model model, cached_model;
+	int iteration_number, cached_iteration_number;
+	HomographyMAGSAC::RunStatistics statistics, cached_statistics;
+
+	// On few points, the same samples are selected repeatedly. The skipped ones are redrawn
+	// without consuming iterations.
+	{
+		const cv::Mat points = magsac::test::generateHomographyCorrespondences(12, 1.0, 0.5, 19);
+		success &= check(runWithCaches(estimator, points, 200, 1000, 0, model, iteration_number, statistics), "the run with duplicate sample detection");
+		success &= check(statistics.duplicate_sample_number > 0, "duplicate samples are selected");
+		success &= check(iteration_number == 200 &&
+			statistics.sample_number == static_cast<size_t>(iteration_number) + statistics.duplicate_sample_number,
+			"the duplicate samples do not consume iterations");
+	}
+
+	// The models recognized by the refined model cache are not rescored. The result is the one
+	// without the cache.
+	{
+		const cv::Mat points = magsac::test::generateHomographyCorrespondences(400, 0.4, 0.5, 20);
+		success &= check(runWithCaches(estimator, points, 500, 0, 0, model, iteration_number, statistics), "the run without the cache");
+		success &= check(runWithCaches(estimator, points, 500, 0, 100, cached_model, cached_iteration_number, cached_statistics), "the run with the cache");
+		success &= check(cached_statistics.refined_model_cache_hits > 0, "the refined models hit the cache");
+		success &= check(cached_iteration_number == iteration_number &&
+			modelDistance(model.descriptor, cached_model.descriptor) < 1e-3,
+			"the cache does not change the estimated model");
+	}
+
+	// The fundamental matrices are recognized by their inliers even though their parameters differ
+	// by orders of magnitude. Different models must not be mistaken for each other.
+	{
+		const magsac::test::CameraPair cameras;
+		const cv::Mat points = magsac::test::generateFundamentalCorrespondences(cameras, 400, 0.7, 0.5, 22);
+		magsac::utils::DefaultFundamentalMatrixEstimator fundamental_estimator(10.0);
+		FundamentalMatrixMAGSAC::RunStatistics fundamental_statistics, cached_fundamental_statistics;
+		success &= check(runWithCaches(fundamental_estimator, points, 2000, 0, 0, model, iteration_number, fundamental_statistics),
+			"the fundamental matrix run without the cache");
+		success &= check(runWithCaches(fundamental_estimator, points, 2000, 0, 100, cached_model, cached_iteration_number, cached_fundamental_statistics),
+			"the fundamental matrix run with the cache");
+		success &= check(cached_fundamental_statistics.refined_model_cache_hits > 0 &&
+			cached_fundamental_statistics.refined_model_cache_hits < cached_fundamental_statistics.refined_model_number,
+			"the refined fundamental matrices hit the cache and not all of them are the same");
+		success &= check(cached_iteration_number == iteration_number &&
+			modelDistance(model.descriptor, cached_model.descriptor) < 1e-3 &&
+			countInliers(fundamental_estimator, points, cached_model, 280) >= countInliers(fundamental_estimator, points, model, 280),
+			"the cache does not change the estimated fundamental matrix");
+	}
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The evaluation caches passed.\n");
+	return EXIT_SUCCESS;
+}
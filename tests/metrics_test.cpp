@@ -0,0 +1,128 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <string>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "metrics.h"
+#include "uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultFundamentalMatrixEstimator> FundamentalMatrixMAGSAC;
+typedef magsac::utils::EstimationMetrics EstimationMetrics;
+
+using magsac::test::check;
+
+// Checking that each metric is described by a HELP and a TYPE line before its samples
+static bool checkExportedText(const std::string &text_)
+{
+	bool success = true;
+	std::set<std::string> described_names, typed_names;
+	std::istringstream lines(text_);
+	std::string line;
+	while (std::getline(lines, line))
+	{
+		std::istringstream words(line);
+		std::string first_word, name;
+		words >> first_word;
+		if (first_word == "#")
+		{
+			std::string keyword;
+			words >> keyword >> name;
+			if (keyword == "HELP")
+			{
+				std::string description;
+				success &= check(static_cast<bool>(std::getline(words, description)) && description.size() > 1, "a HELP line has a description");
+				described_names.insert(name);
+			}
+			else if (keyword == "TYPE")
+			{
+				success &= check(described_names.count(name) == 1, "the HELP line of a metric precedes its TYPE line");
+				typed_names.insert(name);
+			}
+			continue;
+		}
+
+		// The name of a sample without the labels and the suffixes of the histograms
+		name = first_word.substr(0, first_word.find('{'));
+		for (const char * const suffix : { "_bucket", "_sum", "_count" })
+			if (typed_names.count(name) == 0 &&
+				name.size() > strlen(suffix) &&
+				name.compare(name.size() - strlen(suffix), std::string::npos, suffix) == 0)
+				name.erase(name.size() - strlen(suffix));
+		success &= check(typed_names.count(name) == 1, "the samples of a metric follow its HELP and TYPE lines");
+	}
+	success &= check(typed_names.size() == EstimationMetrics::CounterNumber + 2, "every metric is exported");
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+	magsac::utils::MetricsRegistry registry;
+
+	// The models dropped in the preemptive mode are counted
+	{
+		EstimationMetrics &metrics = registry.getEstimationMetrics("homography");
+		cv::Mat points = magsac::test::generateHomographyCorrespondences(500, 0.5, 0.5, 10);
+		magsac::utils::DefaultHomographyEstimator estimator;
+		gcransac::sampler::UniformSampler sampler(&points);
+
+		// 64 models are halved after each block of 100 points until 4 of them remain
+		HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS_PREEMPTIVE);
+		magsac.setMaximumThreshold(10.0);
+		magsac.setPreemptiveParameters(64, 100, 0.5, 4);
+		magsac.setMetrics(&metrics);
+
+		HomographyMAGSAC::RunContext context;
+		gcransac::Model model;
+		int iteration_number;
+		ModelScore score;
+		success &= check(magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score, context), "the preemptive run");
+		success &= check(context.statistics.pruned_model_number == 60, "the preemptive run drops all models but the refined ones");
+		success &= check(metrics.counters[EstimationMetrics::PrunedModelNumber].load() == 60, "the dropped models are added to the metrics");
+	}
+
+	// The models rejected by the validity check, either when refined or when it is deferred, are counted
+	{
+		EstimationMetrics &metrics = registry.getEstimationMetrics("fundamental_matrix");
+		const magsac::test::CameraPair cameras;
+		cv::Mat points = magsac::test::generateFundamentalCorrespondences(cameras, 500, 0.3, 0.5, 11);
+		magsac::utils::DefaultFundamentalMatrixEstimator estimator(10.0);
+		gcransac::sampler::UniformSampler sampler(&points);
+
+		FundamentalMatrixMAGSAC magsac(FundamentalMatrixMAGSAC::MAGSAC_PLUS_PLUS);
+		magsac.setMaximumThreshold(10.0);
+		magsac.setIterationLimit(2000);
+		magsac.setMetrics(&metrics);
+
+		size_t invalid_model_number = 0;
+		for (const bool lazy_validity_check : { false, true })
+		{
+			magsac.setLazyValidityCheck(lazy_validity_check);
+			FundamentalMatrixMAGSAC::RunContext context;
+			gcransac::Model model;
+			int iteration_number;
+			ModelScore score;
+			magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score, context);
+			success &= check(context.statistics.invalid_model_number <= context.statistics.refined_model_number,
+				"only the refined models are rejected by the validity check");
+			invalid_model_number += context.statistics.invalid_model_number;
+		}
+		success &= check(metrics.counters[EstimationMetrics::InvalidModelNumber].load() == invalid_model_number,
+			"the models rejected by the validity check are added to the metrics");
+	}
+
+	success &= checkExportedText(registry.exportText());
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The metrics passed.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "grid_neighborhood.h"
+#include "napsac_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+using magsac::test::check;
+
+// The cell of each point holds the point itself at its position, and the cells partition the points
+static bool checkNeighborhood(const cv::Mat &points_)
+{
+	magsac::utils::GridNeighborhood neighborhood;
+	neighborhood.build(points_, 4);
+
+	bool is_consistent = neighborhood.getPointNumber() == static_cast<size_t>(points_.rows);
+	std::vector<size_t> occurrences(points_.rows, 0);
+	for (size_t point_idx = 0; point_idx < neighborhood.getPointNumber(); ++point_idx)
+	{
+		const size_t * const neighbors = neighborhood.getNeighborsBegin(point_idx);
+		const size_t neighbor_number = neighborhood.getNeighborsEnd(point_idx) - neighbors;
+		const size_t position = neighborhood.getPositionInCell(point_idx);
+		is_consistent &= position < neighbor_number &&
+			neighbors[position] == point_idx;
+
+		// The neighbors share the cell of the point. Each point is counted once by the first point of its cell.
+		for (size_t neighbor_position = 0; neighbor_position < neighbor_number; ++neighbor_position)
+		{
+			is_consistent &= neighborhood.getNeighborsBegin(neighbors[neighbor_position]) == neighbors;
+			if (position == 0)
+				++occurrences[neighbors[neighbor_position]];
+		}
+	}
+	is_consistent &= std::all_of(occurrences.begin(), occurrences.end(),
+		[](const size_t occurrence_) { return occurrence_ == 1; });
+	return check(is_consistent, "the neighbors and the positions in the cells are consistent");
+}
+
+// Checking that the points of a sample are distinct
+static bool isDistinct(const size_t * const sample_, const size_t sample_size_)
+{
+	std::vector<size_t> sample(sample_, sample_ + sample_size_);
+	std::sort(sample.begin(), sample.end());
+	return std::adjacent_find(sample.begin(), sample.end()) == sample.end();
+}
+
+int main()
+{
+	bool success = true;
+	constexpr size_t sample_size = 4, sample_number = 10000;
+	const cv::Mat points = magsac::test::generateHomographyCorrespondences(2000, 0.5, 0.5, 27);
+	success &= checkNeighborhood(points);
+
+	// Only local samples are drawn from the pool of all points. The center is selected once.
+	magsac::utils::GridNeighborhood neighborhood;
+	neighborhood.build(points, 4);
+	magsac::sampler::GridNapsacSampler sampler(&points, 4, 0.0, 9);
+	std::vector<size_t> pool(points.rows);
+	for (size_t point_idx = 0; point_idx < pool.size(); ++point_idx)
+		pool[point_idx] = point_idx;
+
+	size_t sample[sample_size];
+	bool is_local = true, is_distinct = true;
+	for (size_t sample_idx = 0; sample_idx < sample_number; ++sample_idx)
+	{
+		success &= sampler.sample(pool, sample, sample_size);
+		is_distinct &= isDistinct(sample, sample_size);
+		for (const size_t point_idx : sample)
+			is_local &= neighborhood.getNeighborsBegin(point_idx) == neighborhood.getNeighborsBegin(sample[sample_size - 1]);
+	}
+	success &= check(is_distinct, "the local samples contain no duplicates");
+	success &= check(is_local, "the samples from the pool of all points are local");
+
+	// The neighborhoods contain the points outside of a partial pool, thus, the samples are selected globally
+	std::vector<size_t> partial_pool;
+	for (size_t point_idx = 0; point_idx < pool.size(); point_idx += 2)
+		partial_pool.emplace_back(point_idx);
+
+	size_t local_sample_number = 0;
+	bool is_in_pool = true;
+	is_distinct = true;
+	for (size_t sample_idx = 0; sample_idx < sample_number; ++sample_idx)
+	{
+		success &= sampler.sample(partial_pool, sample, sample_size);
+		is_distinct &= isDistinct(sample, sample_size);
+		bool is_sample_local = true;
+		for (const size_t point_idx : sample)
+		{
+			is_in_pool &= point_idx % 2 == 0;
+			is_sample_local &= neighborhood.getNeighborsBegin(point_idx) == neighborhood.getNeighborsBegin(sample[0]);
+		}
+		local_sample_number += is_sample_local;
+	}
+	success &= check(is_distinct && is_in_pool, "the samples from a partial pool contain distinct points of the pool");
+	success &= check(local_sample_number < sample_number / 10, "the samples from a partial pool are selected globally");
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The grid NAPSAC sampler passed.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "fast_uniform_sampler.h"
+#include "point_view.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+using magsac::test::modelDistance;
+
+// Running MAGSAC++ for a fixed number of iterations with a sampler of fixed seed, thus, the runs
+// differ only by the storage of the points
+static bool runOnPoints(const cv::Mat &points_,
+	gcransac::Model &model_,
+	int &iteration_number_)
+{
+	magsac::utils::DefaultHomographyEstimator estimator;
+	magsac::sampler::FastUniformSampler sampler(&points_, 10);
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setMinimumIterationNumber(500);
+	magsac.setIterationLimit(500);
+
+	ModelScore score;
+	return magsac.run(points_, 0.99, estimator, sampler, model_, iteration_number_, score);
+}
+
+int main()
+{
+	bool success = true;
+	constexpr size_t point_number = 500, dimension = 4, stride = 6;
+	const cv::Mat points = magsac::test::generateHomographyCorrespondences(point_number, 0.6, 0.5, 28);
+
+	// The points are stored in a buffer of the caller with two padding values per point which differ by point
+	std::vector<double> buffer(point_number * stride);
+	for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
+	{
+		for (size_t coordinate = 0; coordinate < dimension; ++coordinate)
+			buffer[point_idx * stride + coordinate] = points.at<double>(static_cast<int>(point_idx), static_cast<int>(coordinate));
+		buffer[point_idx * stride + 4] = 1000.0 * point_idx;
+		buffer[point_idx * stride + 5] = -1.0;
+	}
+	const cv::Mat wrapped_points = magsac::utils::wrapPoints(
+		magsac::utils::PointView(buffer.data(), point_number, dimension, stride));
+	success &= check(wrapped_points.rows == static_cast<int>(point_number) &&
+		wrapped_points.cols == static_cast<int>(stride) &&
+		wrapped_points.ptr<double>() == buffer.data(), "the header addresses the buffer of the caller");
+
+	// The padding is ignored by the estimation
+	gcransac::Model model, wrapped_model;
+	int iteration_number, wrapped_iteration_number;
+	success &= check(runOnPoints(points, model, iteration_number), "the run on the dense points");
+	success &= check(runOnPoints(wrapped_points, wrapped_model, wrapped_iteration_number), "the run on the padded points");
+	success &= check(wrapped_iteration_number == iteration_number &&
+		modelDistance(model.descriptor, wrapped_model.descriptor) < 1e-9,
+		"the padded points give the model of the dense ones");
+
+	// The view of a submatrix of a wider one is strided
+	const cv::Mat wider_points(static_cast<int>(point_number), static_cast<int>(stride), CV_64F, buffer.data());
+	const magsac::utils::PointView submatrix_view = magsac::utils::viewPoints(wider_points.colRange(0, dimension));
+	success &= check(submatrix_view.data == buffer.data() &&
+		submatrix_view.point_number == point_number &&
+		submatrix_view.dimension == dimension &&
+		submatrix_view.stride == stride, "the view of a submatrix");
+
+	// Other types than doubles cannot be viewed
+	cv::Mat float_points;
+	points.convertTo(float_points, CV_32F);
+	const magsac::utils::PointView float_view = magsac::utils::viewPoints(float_points);
+	success &= check(float_view.point_number == 0 &&
+		magsac::utils::wrapPoints(float_view).empty(), "the matrix of floats is not viewed");
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The point views passed.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+#include <cstdio>
+#include <cstdlib>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "fast_uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+
+// Running the preemptive mode generating 64 models and refining the best 4 of them
+static bool runPreemptively(const cv::Mat &points_,
+	const double time_limit_,
+	int &iteration_number_,
+	HomographyMAGSAC::RunStatistics &statistics_)
+{
+	magsac::utils::DefaultHomographyEstimator estimator;
+	magsac::sampler::FastUniformSampler sampler(&points_, 4);
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS_PREEMPTIVE);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setPreemptiveParameters(64, 100, 0.5, 4);
+	magsac.setTimeLimit(time_limit_);
+
+	HomographyMAGSAC::RunContext context;
+	gcransac::Model model;
+	ModelScore score;
+	const bool success = magsac.run(points_, 0.99, estimator, sampler, model, iteration_number_, score, context);
+	statistics_ = context.statistics;
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+	const cv::Mat points = magsac::test::generateHomographyCorrespondences(1000, 0.5, 0.5, 21);
+	int iteration_number;
+	HomographyMAGSAC::RunStatistics statistics;
+
+	// Without a time limit, all models are generated and they are dropped until the ones to be refined remain
+	success &= check(runPreemptively(points, 0.0, iteration_number, statistics), "the preemptive run");
+	success &= check(!statistics.is_time_limit_reached &&
+		iteration_number >= 64 &&
+		statistics.pruned_model_number == 60, "the run without a time limit generates and evaluates all models");
+
+	// Once the time limit is exceeded, no more models are generated and only the best one is refined
+	runPreemptively(points, 1e-9, iteration_number, statistics);
+	success &= check(statistics.is_time_limit_reached &&
+		iteration_number < 64 &&
+		statistics.pruned_model_number == 0 &&
+		statistics.refined_model_number <= 1, "the run stops at the time limit");
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The preemptive runs passed.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "prosac_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+
+// The first sample of PROSAC is selected from the best sample size + 1 points of the pool
+static bool isFirstSampleBest(magsac::sampler::ProsacSampler &sampler_,
+	const std::vector<size_t> &pool_,
+	const std::vector<size_t> &best_points_)
+{
+	size_t sample[4];
+	if (!sampler_.sample(pool_, sample, 4))
+		return false;
+	for (const size_t point_idx : sample)
+		if (std::find(best_points_.begin(), best_points_.end(), point_idx) == best_points_.end())
+			return false;
+	return true;
+}
+
+// The pool of every run is ordered again, even if it has the size of the previous one
+static bool checkPreparation()
+{
+	bool success = true;
+
+	cv::Mat points = magsac::test::generateHomographyCorrespondences(20, 1.0, 0.0, 6);
+	std::vector<double> quality_scores(20);
+	for (size_t point_idx = 0; point_idx < quality_scores.size(); ++point_idx)
+		quality_scores[point_idx] = static_cast<double>(point_idx);
+	magsac::sampler::ProsacSampler sampler(&points, quality_scores);
+
+	const std::vector<size_t> first_pool = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 },
+		second_pool = { 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 };
+
+	sampler.prepare(first_pool, 4);
+	success &= check(isFirstSampleBest(sampler, first_pool, { 5, 6, 7, 8, 9 }), "the first sample consists of the best points of the first pool");
+	sampler.prepare(second_pool, 4);
+	success &= check(isFirstSampleBest(sampler, second_pool, { 15, 16, 17, 18, 19 }), "the first sample consists of the best points of the second pool");
+	return success;
+}
+
+// MAGSAC refuses to use the sampler if the indices of the points are not the ones of the input
+static bool checkUnsupportedModes()
+{
+	bool success = true;
+
+	cv::Mat points = magsac::test::generateHomographyCorrespondences(400, 0.5, 0.5, 7);
+	std::vector<double> quality_scores(points.rows);
+	for (size_t point_idx = 0; point_idx < quality_scores.size(); ++point_idx)
+		quality_scores[point_idx] = point_idx < 200 ? 1.0 : 0.0;
+	magsac::utils::DefaultHomographyEstimator estimator;
+	magsac::sampler::ProsacSampler sampler(&points, quality_scores);
+
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setIterationLimit(1000);
+
+	HomographyMAGSAC::RunContext context;
+	gcransac::Model model;
+	int iteration_number;
+	ModelScore score;
+	success &= check(magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score, context),
+		"the run with the PROSAC sampler succeeds");
+
+	magsac.setPointCompression(true);
+	success &= check(!magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score, context) &&
+		iteration_number == 0,
+		"the run with the PROSAC sampler and the point compression fails");
+	magsac.setPointCompression(false);
+
+	magsac.setCoarseToFine(100);
+	success &= check(!magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score, context) &&
+		iteration_number == 0,
+		"the run with the PROSAC sampler in the coarse-to-fine mode fails");
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+	success &= checkPreparation();
+	success &= checkUnsupportedModes();
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The PROSAC sampler passed.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "run_observer.h"
+#include "uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+
+// Recording the updates of the so-far-the-best model
+class RecordingObserver : public magsac::utils::RunObserver
+{
+public:
+	RecordingObserver() :
+		run_number(0)
+	{
+	}
+
+	void onRunStarted() override
+	{
+		++run_number;
+	}
+
+	void onBestModelUpdated(const magsac::utils::BestModelUpdate &update_) override
+	{
+		updates.emplace_back(update_);
+		updates.back().model = nullptr;
+	}
+
+	size_t run_number; // The number of the started runs
+	std::vector<magsac::utils::BestModelUpdate> updates; // The updates of the runs. The models are not kept.
+};
+
+// The observed run of a thread
+struct ObservedRun
+{
+	HomographyMAGSAC::RunContext context;
+	RecordingObserver observer;
+	magsac::utils::BestModelSnapshot snapshot;
+	gcransac::Model model;
+	int iteration_number = 0;
+	ModelScore score;
+	bool success = false;
+};
+
+// Checking that the updates seen by the observer and the snapshot are the ones of the run
+static bool checkObservedRun(const ObservedRun &run_, const char * const name_)
+{
+	bool success = check(run_.success, name_);
+	success &= check(run_.observer.run_number == 1, "the observer of the context sees only its own run");
+	success &= check(!run_.observer.updates.empty(), "the observer sees the updates of the run");
+	if (!success)
+		return false;
+
+	for (size_t update_idx = 1; update_idx < run_.observer.updates.size(); ++update_idx)
+		success &= check(run_.observer.updates[update_idx].score > run_.observer.updates[update_idx - 1].score &&
+			run_.observer.updates[update_idx].iteration >= run_.observer.updates[update_idx - 1].iteration,
+			"the updates of a run improve the score");
+
+	const magsac::utils::BestModelUpdate &last_update = run_.observer.updates.back();
+	success &= check(last_update.score == run_.score.score &&
+		last_update.inlier_number == run_.score.inlier_number, "the last update is the returned model");
+
+	gcransac::Model snapshot_model;
+	ModelScore snapshot_score;
+	success &= check(run_.snapshot.get(snapshot_model, snapshot_score) &&
+		snapshot_score.score == run_.score.score &&
+		snapshot_model.descriptor.isApprox(run_.model.descriptor), "the snapshot of the context holds the returned model");
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+
+	cv::Mat first_points = magsac::test::generateHomographyCorrespondences(500, 0.5, 0.5, 8),
+		second_points = magsac::test::generateHomographyCorrespondences(800, 0.3, 1.0, 9);
+
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setIterationLimit(5000);
+
+	// Two concurrent runs of the same object are observed through their own contexts
+	std::vector<ObservedRun> runs(2);
+	std::vector<std::thread> threads;
+	for (size_t run_idx = 0; run_idx < runs.size(); ++run_idx)
+		threads.emplace_back([&magsac, &runs, run_idx, &first_points, &second_points]()
+		{
+			ObservedRun &run = runs[run_idx];
+			const cv::Mat &points = run_idx == 0 ? first_points : second_points;
+			magsac::utils::DefaultHomographyEstimator estimator;
+			gcransac::sampler::UniformSampler sampler(&points);
+			run.context.observer = &run.observer;
+			run.context.snapshot = &run.snapshot;
+			run.success = magsac.run(points, 0.99, estimator, sampler, run.model, run.iteration_number, run.score, run.context);
+		});
+	for (std::thread &thread : threads)
+		thread.join();
+	success &= checkObservedRun(runs[0], "the first concurrent run");
+	success &= checkObservedRun(runs[1], "the second concurrent run");
+
+	// In the preemptive mode, no iterations are done after the models are refined
+	HomographyMAGSAC preemptive_magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS_PREEMPTIVE);
+	preemptive_magsac.setMaximumThreshold(10.0);
+	ObservedRun preemptive_run;
+	preemptive_run.context.observer = &preemptive_run.observer;
+	preemptive_run.context.snapshot = &preemptive_run.snapshot;
+	magsac::utils::DefaultHomographyEstimator estimator;
+	gcransac::sampler::UniformSampler sampler(&first_points);
+	preemptive_run.success = preemptive_magsac.run(first_points,
+		0.99,
+		estimator,
+		sampler,
+		preemptive_run.model,
+		preemptive_run.iteration_number,
+		preemptive_run.score,
+		preemptive_run.context);
+	if (checkObservedRun(preemptive_run, "the preemptive run"))
+		for (const magsac::utils::BestModelUpdate &update : preemptive_run.observer.updates)
+			success &= check(update.max_iteration == update.iteration &&
+				update.iteration == static_cast<size_t>(preemptive_run.iteration_number),
+				"the maximum iteration number of the preemptive run is the number of iterations done");
+	else
+		success = false;
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The observed runs passed.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+using magsac::test::modelDistance;
+
+// Checking that the per-point data returned by a run is the data of the weighted fitting of the model
+static bool checkRunOutput(const HomographyMAGSAC::Version version_, const char * const name_)
+{
+	constexpr double reference_threshold = 2.0;
+	bool success = true;
+
+	cv::Mat points = magsac::test::generateHomographyCorrespondences(400, 0.5, 0.5, 2);
+	magsac::utils::DefaultHomographyEstimator estimator;
+	gcransac::sampler::UniformSampler sampler(&points);
+
+	HomographyMAGSAC magsac(version_);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setReferenceThreshold(reference_threshold);
+	magsac.setIterationLimit(1000);
+
+	HomographyMAGSAC::RunContext context;
+	HomographyMAGSAC::RunOutput output;
+	gcransac::Model model;
+	int iteration_number;
+	ModelScore score;
+	if (!check(magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score, context, &output), name_))
+		return false;
+
+	const size_t fitted_number = output.point_indices.size();
+	success &= check(fitted_number >= estimator.nonMinimalSampleSize() &&
+		output.residuals.size() == fitted_number &&
+		output.weights.size() == fitted_number, "the per-point data is returned for the fitted points");
+	success &= check(output.inlier_mask.size() == (static_cast<size_t>(points.rows) + 63) / 64, "the inlier mask has a bit for each point");
+	if (!success)
+		return false;
+
+	// The points are in increasing order and their bits are set according to their residuals
+	size_t position = 0;
+	for (size_t point_idx = 0; point_idx < static_cast<size_t>(points.rows); ++point_idx)
+	{
+		const bool is_fitted = position < fitted_number &&
+			output.point_indices[position] == point_idx;
+		const bool is_inlier = is_fitted &&
+			output.residuals[position] < reference_threshold;
+		if (output.isInlier(point_idx) != is_inlier)
+		{
+			success &= check(false, "the inlier bit of a point is set if its residual is smaller than the reference threshold");
+			break;
+		}
+		if (is_fitted)
+		{
+			success &= check(output.weights[position] > 0, "the fitted points have positive weights");
+			++position;
+		}
+	}
+	success &= check(position == fitted_number, "the fitted points are in increasing order");
+
+	// The weighted least-squares fitting of the returned points with the returned weights gives the model
+	std::vector<gcransac::Model> refitted_models;
+	success &= check(estimator.estimateModelNonminimal(points,
+		output.point_indices.data(),
+		fitted_number,
+		&refitted_models,
+		output.weights.data()) &&
+		refitted_models.size() == 1 &&
+		modelDistance(refitted_models[0].descriptor, model.descriptor) < 1e-6,
+		"the returned weights are the ones of the fitting of the model");
+	return success;
+}
+
+// Checking that the merged duplicate points get the data of their representatives. The duplicates
+// are shifted by the given offset which is smaller than the tolerance of the merging.
+static bool checkCompressedRunOutput(const double tolerance_, const double offset_, const char * const name_)
+{
+	bool success = true;
+
+	// The coordinates are rounded to the centers of the cells, so a point and its shifted duplicate
+	// fall into the same cell
+	cv::Mat unique_points = magsac::test::generateHomographyCorrespondences(300, 0.5, 0.5, 3);
+	if (tolerance_ > 0.0)
+		for (int point_idx = 0; point_idx < unique_points.rows; ++point_idx)
+			for (int dimension = 0; dimension < unique_points.cols; ++dimension)
+				unique_points.at<double>(point_idx, dimension) = 
+					std::round(unique_points.at<double>(point_idx, dimension) / tolerance_) * tolerance_;
+
+	cv::Mat points(2 * unique_points.rows, unique_points.cols, CV_64F);
+	for (int point_idx = 0; point_idx < unique_points.rows; ++point_idx)
+	{
+		unique_points.row(point_idx).copyTo(points.row(point_idx));
+		for (int dimension = 0; dimension < unique_points.cols; ++dimension)
+			points.at<double>(point_idx + unique_points.rows, dimension) = unique_points.at<double>(point_idx, dimension) + offset_;
+	}
+	magsac::utils::DefaultHomographyEstimator estimator;
+	gcransac::sampler::UniformSampler sampler(&points);
+
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setIterationLimit(1000);
+	magsac.setPointCompression(true, tolerance_);
+
+	HomographyMAGSAC::RunContext context;
+	HomographyMAGSAC::RunOutput output;
+	gcransac::Model model;
+	int iteration_number;
+	ModelScore score;
+	if (!check(magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score, context, &output), name_))
+		return false;
+
+	// Each point and its duplicate are next to each other in the first and the second half of the output
+	const size_t fitted_number = output.point_indices.size();
+	success &= check(fitted_number > 0 && fitted_number % 2 == 0, "the duplicates of the fitted points are fitted as well");
+	const size_t half = fitted_number / 2;
+	for (size_t position = 0; success && position < half; ++position)
+		success &= check(output.point_indices[position + half] == output.point_indices[position] + unique_points.rows &&
+			output.residuals[position + half] == output.residuals[position] &&
+			output.weights[position + half] == output.weights[position] &&
+			output.isInlier(output.point_indices[position + half]) == output.isInlier(output.point_indices[position]),
+			"the duplicates get the data of their representative");
+	return success;
+}
+
+int main()
+{
+	bool success = true;
+	success &= checkRunOutput(HomographyMAGSAC::MAGSAC_PLUS_PLUS, "MAGSAC++ run");
+	success &= checkRunOutput(HomographyMAGSAC::MAGSAC_ORIGINAL, "MAGSAC run");
+	success &= checkCompressedRunOutput(0.0, 0.0, "compressed run");
+	success &= checkCompressedRunOutput(0.01, 0.001, "compressed run with tolerance");
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The per-point data of the runs passed.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "fast_uniform_sampler.h"
+#include "run_tracer.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+
+// The names of the events recorded by the threads. The name tells the thread recording the event.
+static const char * const thread_event_names[] = { "thread0", "thread1", "thread2", "thread3" };
+
+// Writing the trace and reading it back
+static std::string writeAndReadTrace(const magsac::utils::RunTracer &tracer_, const std::string &path_)
+{
+	if (!tracer_.writeChromeTrace(path_))
+		return std::string();
+	std::ifstream file(path_);
+	std::stringstream content;
+	content << file.rdbuf();
+	std::remove(path_.c_str());
+	return content.str();
+}
+
+// The number of occurrences of a string in the trace
+static size_t countOccurrences(const std::string &trace_, const std::string &pattern_)
+{
+	size_t occurrence_number = 0;
+	for (size_t position = trace_.find(pattern_); position != std::string::npos; position = trace_.find(pattern_, position + 1))
+		++occurrence_number;
+	return occurrence_number;
+}
+
+// Parsing the instant events of the threads, each written in a line of the trace, and checking that
+// their names match their values, i.e., no event is mixed up with another one written into the same slot
+static bool checkThreadEvents(const std::string &trace_,
+	const size_t event_number_per_thread_,
+	size_t &event_number_)
+{
+	bool is_consistent = true;
+	std::vector<double> last_values(4, -1.0);
+	std::istringstream lines(trace_);
+	std::string line;
+	event_number_ = 0;
+	while (std::getline(lines, line))
+	{
+		unsigned int thread_idx, tid;
+		double timestamp, value;
+		if (sscanf(line.c_str(), "{\"name\":\"thread%u\",\"cat\":\"magsac\",\"pid\":1,\"tid\":%u,\"ts\":%lf,\"ph\":\"i\",\"s\":\"t\",\"args\":{\"index\":%lf}}",
+			&thread_idx, &tid, &timestamp, &value) != 4)
+			continue;
+		++event_number_;
+
+		// The values of a thread are its index followed by the index of the event, and they are
+		// kept in the order of recording
+		is_consistent &= thread_idx < 4 &&
+			static_cast<size_t>(value) / event_number_per_thread_ == thread_idx &&
+			value > last_values[thread_idx] &&
+			timestamp >= 0.0;
+		if (thread_idx < 4)
+			last_values[thread_idx] = value;
+	}
+	return is_consistent;
+}
+
+int main()
+{
+	bool success = true;
+	const std::string trace_path = "/tmp/magsac_run_tracer_test_" + std::to_string(getpid()) + ".json";
+
+	// The threads record far more events than the buffer keeps, thus, the slots are written by
+	// multiple threads
+	{
+		constexpr size_t capacity = 1000, event_number_per_thread = 100000;
+		magsac::utils::RunTracer tracer(capacity);
+		std::vector<std::thread> threads;
+		for (size_t thread_idx = 0; thread_idx < 4; ++thread_idx)
+			threads.emplace_back([&tracer, thread_idx]()
+			{
+				for (size_t event_idx = 0; event_idx < event_number_per_thread; ++event_idx)
+					tracer.recordInstant(thread_event_names[thread_idx], "index",
+						static_cast<double>(thread_idx * event_number_per_thread + event_idx));
+			});
+		for (std::thread &thread : threads)
+			thread.join();
+
+		success &= check(tracer.getEventNumber() == capacity &&
+			tracer.getDroppedEventNumber() == 4 * event_number_per_thread - capacity,
+			"the buffer keeps the latest events");
+
+		const std::string trace = writeAndReadTrace(tracer, trace_path);
+		size_t event_number;
+		success &= check(trace.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0 &&
+			trace.size() >= 4 && trace.compare(trace.size() - 4, 4, "\n]}\n") == 0,
+			"the trace is a Chrome trace");
+		success &= check(checkThreadEvents(trace, event_number_per_thread, event_number) &&
+			event_number == capacity, "the events of the threads are written intact");
+
+		tracer.clear();
+		success &= check(tracer.getEventNumber() == 0 &&
+			countOccurrences(writeAndReadTrace(tracer, trace_path), "\"name\"") == 0, "the cleared tracer has no events");
+	}
+
+	// The spans of a run are recorded only if the tracing is compiled in
+	{
+		const cv::Mat points = magsac::test::generateHomographyCorrespondences(500, 0.6, 0.5, 29);
+		magsac::utils::DefaultHomographyEstimator estimator;
+		magsac::sampler::FastUniformSampler sampler(&points, 11);
+		magsac::utils::RunTracer tracer;
+		HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+		magsac.setMaximumThreshold(10.0);
+		magsac.setTracer(&tracer);
+
+		gcransac::Model model;
+		int iteration_number;
+		ModelScore score;
+		success &= check(magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score), "the traced run");
+
+		const std::string trace = writeAndReadTrace(tracer, trace_path);
+		const size_t event_number = countOccurrences(trace, "{\"name\":");
+		success &= check(event_number == tracer.getEventNumber() &&
+			countOccurrences(trace, "\"cat\":\"magsac\"") == event_number, "each event of the run is written");
+#ifdef USE_TRACING
+		success &= check(countOccurrences(trace, "{\"name\":\"run\"") == 1 &&
+			countOccurrences(trace, "{\"name\":\"sigmaConsensusPlusPlus\"") > 0 &&
+			countOccurrences(trace, "{\"name\":\"updateBestModel\"") > 0, "the spans of the run are written");
+#else
+		success &= check(event_number == 0, "no span is recorded if the tracing is not compiled in");
+#endif
+	}
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The run tracer passed.\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <opencv2/core.hpp>
+
+#include "estimation_server.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+using magsac::test::check;
+using magsac::test::modelDistance;
+
+// Starting the server with a single worker. It returns the process identifier of the server.
+static pid_t startServer(const char * const server_path_, const std::string &socket_path_)
+{
+	const pid_t server = fork();
+	if (server == 0)
+	{
+		execl(server_path_, server_path_, socket_path_.c_str(), "1", static_cast<char *>(nullptr));
+		_exit(EXIT_FAILURE);
+	}
+	return server;
+}
+
+// Connecting to the server when it has started listening. It returns -1 on failure.
+static int connectWhenListening(const std::string &socket_path_)
+{
+	for (size_t attempt = 0; attempt < 100; ++attempt)
+	{
+		const int connection = magsac::server::connectToServer(socket_path_.c_str());
+		if (connection >= 0)
+			return connection;
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	return -1;
+}
+
+// The round trips of homography estimation requests through the estimation server (src/magsac_server.cpp).
+// The points are written with padding into a shared memory object as the clients do.
+//
+// Usage: ServerTest <path of MAGSACServer>
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: ServerTest <path of MAGSACServer>\n");
+		return EXIT_FAILURE;
+	}
+
+	// A hanging server fails the test instead of blocking it
+	alarm(120);
+
+	bool success = true;
+	const std::string socket_path = "/tmp/magsac_server_test_" + std::to_string(getpid()) + ".sock";
+	const std::string shared_memory_name = "/magsac_server_test_" + std::to_string(getpid());
+
+	// Write the points into the shared memory. Each point is followed by a padding element.
+	constexpr size_t point_number = 500, inlier_number = 300, stride = 5;
+	const cv::Mat points = magsac::test::generateHomographyCorrespondences(point_number, 0.6, 0.5, 24);
+	const size_t shared_memory_size = point_number * stride * sizeof(double);
+	const int descriptor = shm_open(shared_memory_name.c_str(), O_CREAT | O_RDWR, 0600);
+	if (descriptor < 0 ||
+		ftruncate(descriptor, shared_memory_size) < 0)
+	{
+		fprintf(stderr, "The shared memory object '%s' cannot be created.\n", shared_memory_name.c_str());
+		return EXIT_FAILURE;
+	}
+	double * const shared_points = static_cast<double *>(
+		mmap(nullptr, shared_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0));
+	close(descriptor);
+	if (shared_points == MAP_FAILED)
+	{
+		shm_unlink(shared_memory_name.c_str());
+		return EXIT_FAILURE;
+	}
+	for (size_t point_idx = 0; point_idx < point_number; ++point_idx)
+	{
+		memcpy(shared_points + point_idx * stride, points.ptr<double>(static_cast<int>(point_idx)), 4 * sizeof(double));
+		shared_points[point_idx * stride + 4] = -1.0;
+	}
+
+	magsac::server::EstimationRequest request;
+	memset(&request, 0, sizeof(request));
+	request.magic = magsac::server::protocol_magic;
+	request.problem_type = magsac::server::Homography;
+	strcpy(request.shared_memory_name, shared_memory_name.c_str());
+	request.point_number = point_number;
+	request.dimension = 4;
+	request.stride = stride;
+	request.confidence = 0.99;
+	request.maximum_threshold = 10.0;
+	request.reference_threshold = 3.0;
+	request.iteration_limit = 1000;
+	request.use_magsac_plus_plus = 1;
+	request.return_inlier_mask = 1;
+
+	const pid_t server = startServer(argv[1], socket_path);
+	const int idle_connection = connectWhenListening(socket_path);
+	const int connection = magsac::server::connectToServer(socket_path.c_str());
+	success &= check(server > 0 && idle_connection >= 0 && connection >= 0, "the server accepts the connections");
+
+	if (success)
+	{
+		magsac::server::EstimationResponse response;
+		std::vector<uint64_t> inlier_mask;
+
+		// The single worker is not held by the idle connection, thus, the request on the other one is answered
+		success &= check(magsac::server::requestEstimation(connection, request, response, inlier_mask) &&
+			response.status == magsac::server::Success, "the request is answered while another client is idle");
+
+		size_t masked_inlier_number = 0, masked_true_inlier_number = 0;
+		for (size_t point_idx = 0; point_idx < point_number && point_idx / 64 < inlier_mask.size(); ++point_idx)
+			if ((inlier_mask[point_idx / 64] >> (point_idx % 64)) & 1)
+			{
+				++masked_inlier_number;
+				if (point_idx < inlier_number)
+					++masked_true_inlier_number;
+			}
+		const Eigen::Matrix<double, 3, 3, Eigen::RowMajor> model(response.model);
+		success &= check(response.inlier_mask_word_number == (point_number + 63) / 64 &&
+			masked_inlier_number == response.inlier_number &&
+			masked_true_inlier_number > 0.9 * inlier_number &&
+			modelDistance(model, magsac::test::groundTruthHomography()) < 0.01,
+			"the response holds the model and the inliers of the points");
+
+		// The connection is served again after its request has been answered. Points beyond the end of
+		// the shared memory object are rejected.
+		magsac::server::EstimationRequest invalid_request = request;
+		invalid_request.point_number = point_number + 1;
+		success &= check(magsac::server::requestEstimation(connection, invalid_request, response, inlier_mask) &&
+			response.status == magsac::server::SharedMemoryError, "the points beyond the shared memory are rejected");
+
+		// The connection which has been idle is served as well
+		request.return_inlier_mask = 0;
+		success &= check(magsac::server::requestEstimation(idle_connection, request, response, inlier_mask) &&
+			response.status == magsac::server::Success &&
+			response.inlier_mask_word_number == 0, "the request of the connection which has been idle is answered");
+	}
+
+	// The server stops on SIGTERM
+	if (idle_connection >= 0)
+		close(idle_connection);
+	if (connection >= 0)
+		close(connection);
+	int server_status = -1;
+	if (server > 0)
+	{
+		kill(server, SIGTERM);
+		waitpid(server, &server_status, 0);
+	}
+	success &= check(WIFEXITED(server_status) && WEXITSTATUS(server_status) == 0, "the server stops on SIGTERM");
+
+	munmap(shared_points, shared_memory_size);
+	shm_unlink(shared_memory_name.c_str());
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The round trips through the server passed.\n");
+	return EXIT_SUCCESS;
+}
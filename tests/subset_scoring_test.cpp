@@ -0,0 +1,95 @@
+#include <cstdio>
+#include <cstdlib>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "fast_uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+using magsac::test::countInliers;
+using magsac::test::modelDistance;
+
+// Running MAGSAC++ for a fixed number of iterations with a sampler of fixed seed, thus, the runs
+// differ only by the subset scoring. The reference threshold is tiny so that no model is interrupted
+// for having fewer inliers than the so-far-the-best one, and each model is refined and scored.
+static bool runWithSubsetScoring(const cv::Mat &points_,
+	const size_t subset_size_,
+	const bool compress_points_,
+	gcransac::Model &model_,
+	HomographyMAGSAC::RunStatistics &statistics_)
+{
+	magsac::utils::DefaultHomographyEstimator estimator;
+	magsac::sampler::FastUniformSampler sampler(&points_, 5);
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setReferenceThreshold(1e-9);
+	magsac.setMinimumIterationNumber(1000);
+	magsac.setIterationLimit(1000);
+	magsac.setSubsetScoring(subset_size_);
+	magsac.setPointCompression(compress_points_);
+
+	HomographyMAGSAC::RunContext context;
+	int iteration_number;
+	ModelScore score;
+	const bool success = magsac.run(points_, 0.99, estimator, sampler, model_, iteration_number, score, context);
+	statistics_ = context.statistics;
+	return success;
+}
+
+// Generating the correspondences of two planes. The first 2000 points are consistent with the ground
+// truth homography, the next 1000 points with the one shifted by 200 pixels in the second image, and 
+// the rest are uniform outliers. The models of the second plane are worse than those of the first one.
+static cv::Mat generateTwoPlaneCorrespondences()
+{
+	cv::Mat points = magsac::test::generateHomographyCorrespondences(5000, 0.6, 0.5, 23);
+	for (int point_idx = 2000; point_idx < 3000; ++point_idx)
+		points.at<double>(point_idx, 2) += 200.0;
+	return points;
+}
+
+int main()
+{
+	bool success = true;
+	magsac::utils::DefaultHomographyEstimator estimator;
+	gcransac::Model model, subset_model;
+	HomographyMAGSAC::RunStatistics statistics, subset_statistics;
+
+	// The models of the second plane are dropped after being scored on the subset and the result is
+	// the one without the subset scoring
+	const cv::Mat points = generateTwoPlaneCorrespondences();
+	success &= check(runWithSubsetScoring(points, 0, false, model, statistics), "the run without the subset scoring");
+	success &= check(runWithSubsetScoring(points, 500, false, subset_model, subset_statistics), "the run with the subset scoring");
+	success &= check(statistics.subset_scored_model_number == 0, "no model is scored on a subset when it is switched off");
+	success &= check(subset_statistics.subset_scored_model_number > 0 &&
+		subset_statistics.getPromotionRate() < 0.5, "most of the refined models are dropped on the subset");
+	success &= check(modelDistance(model.descriptor, subset_model.descriptor) < 1e-3 &&
+		countInliers(estimator, points, subset_model, 2000) > 0.95 * 2000,
+		"the subset scoring does not change the estimated model");
+
+	// The bound does not depend on the multiplicities, thus, the models are still dropped when the
+	// points are merged. Each point of the first plane is repeated five times.
+	constexpr int repetition_number = 5;
+	cv::Mat repeated_points(2000 * repetition_number + 3000, 4, CV_64F);
+	for (int point_idx = 0; point_idx < repeated_points.rows; ++point_idx)
+	{
+		const int source_idx = point_idx < 2000 * repetition_number ?
+			point_idx / repetition_number :
+			point_idx - 2000 * (repetition_number - 1);
+		points.row(source_idx).copyTo(repeated_points.row(point_idx));
+	}
+	success &= check(runWithSubsetScoring(repeated_points, 500, true, subset_model, subset_statistics), "the run with the subset scoring on the merged points");
+	success &= check(subset_statistics.subset_scored_model_number > 0 &&
+		subset_statistics.getPromotionRate() < 0.5, "most of the refined models are dropped on the subset of the merged points");
+	success &= check(countInliers(estimator, repeated_points, subset_model, 2000 * repetition_number) > 0.95 * 2000 * repetition_number,
+		"the model estimated on the merged points");
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The subset scoring passed.\n");
+	return EXIT_SUCCESS;
+}
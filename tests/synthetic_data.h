@@ -0,0 +1,125 @@
+#pragma once
+
+#include <random>
+#include <Eigen/Eigen>
+#include <opencv2/core.hpp>
+
+namespace magsac
+{
+	namespace test
+	{
+		// The homography from which the synthetic correspondences are generated
+		inline Eigen::Matrix3d groundTruthHomography()
+		{
+			Eigen::Matrix3d homography;
+			homography << 1.1, 0.05, 20.0,
+				-0.03, 0.95, 10.0,
+				1e-5, 2e-5, 1.0;
+			return homography;
+		}
+
+		// Generating point correspondences in a 1000 x 1000 image. The first inlier_ratio_ part of them is
+		// consistent with the ground truth homography up to Gaussian noise, the rest are uniform outliers.
+		inline cv::Mat generateHomographyCorrespondences(
+			const size_t point_number_, // The number of correspondences
+			const double inlier_ratio_, // The ratio of the inliers
+			const double noise_sigma_, // The standard deviation of the noise of the inliers in pixels
+			const unsigned int seed_) // The seed of the random generator
+		{
+			std::mt19937 generator(seed_);
+			std::uniform_real_distribution<double> coordinate_distribution(0.0, 1000.0);
+			std::normal_distribution<double> noise_distribution(0.0, noise_sigma_);
+			const Eigen::Matrix3d homography = groundTruthHomography();
+			const size_t inlier_number = static_cast<size_t>(point_number_ * inlier_ratio_);
+
+			cv::Mat points(static_cast<int>(point_number_), 4, CV_64F);
+			for (size_t point_idx = 0; point_idx < point_number_; ++point_idx)
+			{
+				double * const point = points.ptr<double>(static_cast<int>(point_idx));
+				point[0] = coordinate_distribution(generator);
+				point[1] = coordinate_distribution(generator);
+
+				if (point_idx < inlier_number)
+				{
+					const Eigen::Vector3d projection = homography * Eigen::Vector3d(point[0], point[1], 1.0);
+					point[2] = projection(0) / projection(2) + noise_distribution(generator);
+					point[3] = projection(1) / projection(2) + noise_distribution(generator);
+				}
+				else
+				{
+					point[2] = coordinate_distribution(generator);
+					point[3] = coordinate_distribution(generator);
+				}
+			}
+			return points;
+		}
+
+		// The camera pair from which the synthetic two-view correspondences are generated
+		struct CameraPair
+		{
+			Eigen::Matrix3d intrinsics; // The intrinsic parameters of both cameras
+			Eigen::Matrix3d rotation; // The rotation of the second camera
+			Eigen::Vector3d translation; // The translation of the second camera
+
+			CameraPair()
+			{
+				intrinsics << 800.0, 0.0, 500.0,
+					0.0, 800.0, 500.0,
+					0.0, 0.0, 1.0;
+				rotation = Eigen::AngleAxisd(0.2, Eigen::Vector3d(0.1, 1.0, 0.05).normalized()).toRotationMatrix();
+				translation = Eigen::Vector3d(1.0, 0.1, 0.05);
+			}
+
+			// The fundamental matrix of the cameras, i.e., K^-T [t]_x R K^-1
+			Eigen::Matrix3d fundamentalMatrix() const
+			{
+				Eigen::Matrix3d cross_product;
+				cross_product << 0.0, -translation(2), translation(1),
+					translation(2), 0.0, -translation(0),
+					-translation(1), translation(0), 0.0;
+				const Eigen::Matrix3d inverse_intrinsics = intrinsics.inverse();
+				return inverse_intrinsics.transpose() * cross_product * rotation * inverse_intrinsics;
+			}
+		};
+
+		// Generating point correspondences by projecting random points in front of the cameras. The first 
+		// inlier_ratio_ part of them is consistent with the cameras up to Gaussian noise, the rest are 
+		// uniform outliers in a 1000 x 1000 image.
+		inline cv::Mat generateFundamentalCorrespondences(
+			const CameraPair &cameras_, // The cameras
+			const size_t point_number_, // The number of correspondences
+			const double inlier_ratio_, // The ratio of the inliers
+			const double noise_sigma_, // The standard deviation of the noise of the inliers in pixels
+			const unsigned int seed_) // The seed of the random generator
+		{
+			std::mt19937 generator(seed_);
+			std::uniform_real_distribution<double> lateral_distribution(-2.0, 2.0),
+				depth_distribution(4.0, 8.0),
+				coordinate_distribution(0.0, 1000.0);
+			std::normal_distribution<double> noise_distribution(0.0, noise_sigma_);
+			const size_t inlier_number = static_cast<size_t>(point_number_ * inlier_ratio_);
+
+			cv::Mat points(static_cast<int>(point_number_), 4, CV_64F);
+			for (size_t point_idx = 0; point_idx < point_number_; ++point_idx)
+			{
+				double * const point = points.ptr<double>(static_cast<int>(point_idx));
+				if (point_idx < inlier_number)
+				{
+					const Eigen::Vector3d world_point(lateral_distribution(generator),
+						lateral_distribution(generator),
+						depth_distribution(generator));
+					const Eigen::Vector3d projection_1 = cameras_.intrinsics * world_point,
+						projection_2 = cameras_.intrinsics * (cameras_.rotation * world_point + cameras_.translation);
+					point[0] = projection_1(0) / projection_1(2) + noise_distribution(generator);
+					point[1] = projection_1(1) / projection_1(2) + noise_distribution(generator);
+					point[2] = projection_2(0) / projection_2(2) + noise_distribution(generator);
+					point[3] = projection_2(1) / projection_2(2) + noise_distribution(generator);
+				}
+				else
+					for (size_t coordinate_idx = 0; coordinate_idx < 4; ++coordinate_idx)
+						point[coordinate_idx] = coordinate_distribution(generator);
+			}
+			return points;
+		}
+	}
+}
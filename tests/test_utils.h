@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <Eigen/Eigen>
+#include <opencv2/core.hpp>
+
+#include "model.h"
+
+namespace magsac
+{
+	namespace test
+	{
+		// Printing the message of a failed check. It returns the condition, thus, the results of the checks
+		// can be accumulated.
+		inline bool check(const bool condition_, const char * const message_)
+		{
+			if (!condition_)
+				fprintf(stderr, "FAILED: %s\n", message_);
+			return condition_;
+		}
+
+		// The distance of two models defined up to scale after normalizing them to unit norm
+		inline double modelDistance(const Eigen::MatrixXd &first_, const Eigen::MatrixXd &second_)
+		{
+			const Eigen::MatrixXd first = first_ / first_.norm(),
+				second = second_ / second_.norm();
+			return std::min((first - second).norm(), (first + second).norm());
+		}
+
+		// The number of the first inlier_number_ points of the synthetic data closer to the model than the threshold
+		template <class ModelEstimator>
+		inline size_t countInliers(const ModelEstimator &estimator_,
+			const cv::Mat &points_,
+			const gcransac::Model &model_,
+			const size_t inlier_number_,
+			const double threshold_ = 3.0)
+		{
+			size_t inlier_number = 0;
+			for (size_t point_idx = 0; point_idx < inlier_number_; ++point_idx)
+				if (estimator_.residualForScoring(points_.row(static_cast<int>(point_idx)), model_) < threshold_)
+					++inlier_number;
+			return inlier_number;
+		}
+	}
+}
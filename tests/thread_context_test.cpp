@@ -0,0 +1,93 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+using magsac::test::countInliers;
+
+// A uniform sampler starting another run of MAGSAC, without a context, when its first sample is selected.
+// The nested run is on the same thread as the one using the sampler.
+class NestingSampler : public gcransac::sampler::UniformSampler
+{
+public:
+	NestingSampler(const cv::Mat * const container_,
+		const HomographyMAGSAC &magsac_,
+		const cv::Mat &nested_points_) :
+		UniformSampler(container_),
+		magsac(magsac_),
+		nested_points(nested_points_),
+		is_nested_run_done(false),
+		nested_success(false)
+	{
+	}
+
+	bool sample(const std::vector<size_t> &pool_, size_t * const subset_, size_t sample_size_) override
+	{
+		if (!is_nested_run_done)
+		{
+			is_nested_run_done = true;
+			magsac::utils::DefaultHomographyEstimator estimator;
+			gcransac::sampler::UniformSampler sampler(&nested_points);
+			int iteration_number;
+			nested_success = magsac.run(nested_points, 0.99, estimator, sampler, nested_model, iteration_number, nested_score);
+		}
+		return UniformSampler::sample(pool_, subset_, sample_size_);
+	}
+
+	const HomographyMAGSAC &magsac;
+	const cv::Mat &nested_points;
+	bool is_nested_run_done;
+	bool nested_success;
+	gcransac::Model nested_model;
+	ModelScore nested_score;
+};
+
+int main()
+{
+	bool success = true;
+
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setIterationLimit(5000);
+
+	// The runs without a context get the context of the thread unless another run is using it.
+	// The nested run has more points than the outer one, so the outer run would sample points it does
+	// not have if the nested run replaced the pool in the context.
+	cv::Mat points = magsac::test::generateHomographyCorrespondences(300, 0.5, 0.5, 12),
+		nested_points = magsac::test::generateHomographyCorrespondences(600, 0.5, 0.5, 13);
+	magsac::utils::DefaultHomographyEstimator estimator;
+	NestingSampler sampler(&points, magsac, nested_points);
+
+	gcransac::Model model;
+	int iteration_number;
+	ModelScore score;
+	HomographyMAGSAC::RunOutput output;
+	success &= check(magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score, &output), "the outer run");
+	success &= check(sampler.is_nested_run_done && sampler.nested_success, "the nested run");
+	if (success)
+	{
+		success &= check(countInliers(estimator, points, model, 150) > 135, "the model of the outer run fits its points");
+		success &= check(!output.point_indices.empty() &&
+			output.point_indices.back() < static_cast<size_t>(points.rows), "the outer run is fitted to its own points");
+		success &= check(countInliers(estimator, nested_points, sampler.nested_model, 300) > 270, "the model of the nested run fits its points");
+	}
+
+	// The context of the thread is usable after the nested run
+	gcransac::sampler::UniformSampler uniform_sampler(&nested_points);
+	success &= check(magsac.run(nested_points, 0.99, estimator, uniform_sampler, model, iteration_number, score) &&
+		countInliers(estimator, nested_points, model, 300) > 270, "the run after the nested one");
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The runs using the context of the thread passed.\n");
+	return EXIT_SUCCESS;
+}
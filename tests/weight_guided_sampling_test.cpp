@@ -0,0 +1,109 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "magsac.h"
+#include "estimators.h"
+#include "alias_table.h"
+#include "fast_random_generator.h"
+#include "fast_uniform_sampler.h"
+#include "uniform_sampler.h"
+#include "synthetic_data.h"
+#include "test_utils.h"
+
+typedef MAGSAC<cv::Mat, magsac::utils::DefaultHomographyEstimator> HomographyMAGSAC;
+
+using magsac::test::check;
+using magsac::test::countInliers;
+using magsac::test::modelDistance;
+
+// Running the weight-guided sampling on merged points with a sampler of fixed seed and the given
+// seed of the weighted samples
+static bool runWithSeed(const cv::Mat &points_,
+	const uint64_t seed_,
+	gcransac::Model &model_,
+	int &iteration_number_)
+{
+	magsac::utils::DefaultHomographyEstimator estimator;
+	magsac::sampler::FastUniformSampler sampler(&points_, 12);
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setIterationLimit(5000);
+	magsac.setPointCompression(true);
+	magsac.setWeightGuidedSampling(true, 0.5, seed_);
+
+	ModelScore score;
+	return magsac.run(points_, 0.99, estimator, sampler, model_, iteration_number_, score);
+}
+
+int main()
+{
+	bool success = true;
+	constexpr size_t draw_number = 1000000;
+
+	// The uniform real numbers are in [0, 1) and their mean is one half
+	magsac::utils::FastRandomGenerator generator(1);
+	double uniform_sum = 0.0;
+	bool is_in_range = true;
+	for (size_t draw = 0; draw < draw_number; ++draw)
+	{
+		const double uniform = generator.uniform();
+		is_in_range &= uniform >= 0.0 && uniform < 1.0;
+		uniform_sum += uniform;
+	}
+	success &= check(is_in_range, "the uniform numbers are in [0, 1)");
+	success &= check(std::abs(uniform_sum / draw_number - 0.5) < 0.005, "the mean of the uniform numbers is one half");
+
+	// The indices are drawn proportionally to their weights
+	const std::vector<double> weights = { 1.0, 3.0, 0.0, 4.0 };
+	magsac::utils::AliasTable table;
+	success &= check(table.build(weights.data(), weights.size()), "the alias table is built");
+	std::vector<size_t> draw_counts(weights.size(), 0);
+	for (size_t draw = 0; draw < draw_number; ++draw)
+		++draw_counts[table.sample(generator)];
+	for (size_t index = 0; index < weights.size(); ++index)
+		success &= check(std::abs(static_cast<double>(draw_counts[index]) / draw_number - weights[index] / 8.0) < 0.005,
+			"the indices are drawn proportionally to their weights");
+
+	// The weight-guided sampling on merged points. Each inlier is repeated five times.
+	const cv::Mat unique_points = magsac::test::generateHomographyCorrespondences(300, 0.4, 0.5, 18);
+	constexpr size_t unique_inlier_number = 120, repetition_number = 5;
+	cv::Mat points(static_cast<int>(unique_inlier_number * repetition_number + unique_points.rows - unique_inlier_number), 4, CV_64F);
+	for (int point_idx = 0; point_idx < points.rows; ++point_idx)
+	{
+		const int unique_idx = point_idx < static_cast<int>(unique_inlier_number * repetition_number) ?
+			point_idx / static_cast<int>(repetition_number) :
+			point_idx - static_cast<int>(unique_inlier_number * (repetition_number - 1));
+		unique_points.row(unique_idx).copyTo(points.row(point_idx));
+	}
+
+	magsac::utils::DefaultHomographyEstimator estimator;
+	gcransac::sampler::UniformSampler sampler(&points);
+	HomographyMAGSAC magsac(HomographyMAGSAC::MAGSAC_PLUS_PLUS);
+	magsac.setMaximumThreshold(10.0);
+	magsac.setIterationLimit(5000);
+	magsac.setPointCompression(true);
+	magsac.setWeightGuidedSampling(true);
+
+	gcransac::Model model;
+	int iteration_number;
+	ModelScore score;
+	success &= check(magsac.run(points, 0.99, estimator, sampler, model, iteration_number, score) &&
+		countInliers(estimator, points, model, unique_inlier_number * repetition_number) > 0.9 * unique_inlier_number * repetition_number,
+		"the weight-guided sampling on the merged points");
+
+	// The runs with the same seed are the same
+	gcransac::Model seeded_model, repeated_model;
+	int seeded_iteration_number, repeated_iteration_number;
+	success &= check(runWithSeed(points, 3, seeded_model, seeded_iteration_number) &&
+		runWithSeed(points, 3, repeated_model, repeated_iteration_number), "the runs with a seed of the weighted samples");
+	success &= check(seeded_iteration_number == repeated_iteration_number &&
+		modelDistance(seeded_model.descriptor, repeated_model.descriptor) == 0.0, "the runs with the same seed are reproduced");
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The weight-guided sampling passed.\n");
+	return EXIT_SUCCESS;
+}
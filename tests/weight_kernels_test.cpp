@@ -0,0 +1,81 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "weight_kernels.h"
+#include "test_utils.h"
+
+using magsac::test::check;
+
+// The instruction set of the vectorized kernel this test is compiled with. The remaining points
+// of the kernel, and every point if there is no instruction set, go through the scalar approximation.
+#if defined(__AVX2__)
+	static const char * const instruction_set = "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64)
+	static const char * const instruction_set = "SSE2";
+#else
+	static const char * const instruction_set = "scalar";
+#endif
+
+int main()
+{
+#if defined(__AVX2__) && defined(__GNUC__)
+	// The AVX2 kernels are also tested when the library uses SSE2, thus, the CPU might not support them
+	if (!__builtin_cpu_supports("avx2"))
+	{
+		printf("The weight kernels (AVX2) are skipped since the CPU does not support AVX2.\n");
+		return EXIT_SUCCESS;
+	}
+#endif
+
+	bool success = true;
+
+	// The approximation is compared with std::exp over the whole range of the arguments, including the
+	// boundaries of the reduced argument at the odd multiples of ln(2) / 2
+	constexpr size_t argument_number = 1000000;
+	std::vector<double> arguments;
+	arguments.reserve(argument_number + 2000);
+	for (size_t argument_idx = 0; argument_idx <= argument_number; ++argument_idx)
+		arguments.emplace_back(magsac::utils::exp_constants::minimum_argument * argument_idx / argument_number);
+	for (int k = 1; k < 2000 && -(k - 0.5) * std::log(2.0) > magsac::utils::exp_constants::minimum_argument; ++k)
+		arguments.emplace_back(-(k - 0.5) * std::log(2.0));
+
+	double maximum_relative_error = 0.0;
+	for (const double &argument : arguments)
+	{
+		const double expected = std::exp(argument);
+		maximum_relative_error = std::max(maximum_relative_error,
+			std::abs(magsac::utils::expNonPositive(argument) - expected) / expected);
+	}
+	success &= check(maximum_relative_error < 1e-15, "the relative error of the approximation is below 1e-15 on [-708, 0]");
+	success &= check(magsac::utils::expNonPositive(0.0) == 1.0, "the approximation is exact at zero");
+	success &= check(magsac::utils::expNonPositive(-708.5) == 0.0 &&
+		magsac::utils::expNonPositive(-1e300) == 0.0 &&
+		magsac::utils::expNonPositive(-std::numeric_limits<double>::infinity()) == 0.0,
+		"the arguments which would underflow give zero");
+
+	// The kernel adds exactly the values of the scalar approximation, also to unaligned buffers
+	// whose size is not a multiple of the vector width. The last arguments underflow.
+	constexpr size_t point_number = 1003;
+	constexpr double multiplier = 0.5;
+	std::vector<double> squared_residuals(point_number + 1), weights(point_number + 1);
+	for (size_t point_idx = 0; point_idx <= point_number; ++point_idx)
+	{
+		squared_residuals[point_idx] = 1500.0 * point_idx / point_number;
+		weights[point_idx] = 0.25 * point_idx;
+	}
+	magsac::utils::accumulateGaussianWeights(squared_residuals.data() + 1, point_number, multiplier, weights.data() + 1);
+
+	bool is_equal = weights[0] == 0.0;
+	for (size_t point_idx = 1; point_idx <= point_number; ++point_idx)
+		is_equal &= weights[point_idx] ==
+			0.25 * point_idx + magsac::utils::expNonPositive(-squared_residuals[point_idx] * multiplier);
+	success &= check(is_equal, "the kernel adds the values of the scalar approximation");
+
+	if (!success)
+		return EXIT_FAILURE;
+	printf("The weight kernels (%s) passed.\n", instruction_set);
+	return EXIT_SUCCESS;
+}